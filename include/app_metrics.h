@@ -5,47 +5,112 @@
 #include "logger.h"
 #include "tsconfig.h"
 #include <mutex>
+#include <array>
+#include <atomic>
 #include <string>
 #include <shared_mutex>
+#include <unordered_map>
 #include <mutex>
 #include <fstream>
 
+// HDR-style log-linear histogram of latencies (in milliseconds): values below `SUB_BUCKET_COUNT` are recorded exactly,
+// and every power of two above that is split into `SUB_BUCKET_COUNT` linear buckets (~6% relative error).
+struct latency_histogram_t {
+    static constexpr size_t SUB_BUCKET_BITS = 4;
+    static constexpr size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_SHIFT = 24;
+    static constexpr size_t NUM_BUCKETS = SUB_BUCKET_COUNT * (MAX_SHIFT + 1);
+
+    std::array<uint32_t, NUM_BUCKETS> buckets{};
+    uint64_t count = 0;
+
+    static size_t bucket_index(uint64_t value) {
+        if(value < SUB_BUCKET_COUNT) {
+            return value;
+        }
+
+        const size_t msb = 63 - __builtin_clzll(value);
+        const size_t shift = msb - SUB_BUCKET_BITS;
+
+        if(shift >= MAX_SHIFT) {
+            return NUM_BUCKETS - 1;
+        }
+
+        return SUB_BUCKET_COUNT * (shift + 1) + ((value >> shift) - SUB_BUCKET_COUNT);
+    }
+
+    // highest value that is recorded in the bucket at `index`
+    static uint64_t bucket_upper_bound(size_t index) {
+        if(index < SUB_BUCKET_COUNT) {
+            return index;
+        }
+
+        const size_t shift = (index / SUB_BUCKET_COUNT) - 1;
+        const size_t sub_bucket = index % SUB_BUCKET_COUNT;
+        return ((SUB_BUCKET_COUNT + sub_bucket + 1) << shift) - 1;
+    }
+
+    void record(uint64_t value) {
+        buckets[bucket_index(value)]++;
+        count++;
+    }
+
+    void merge(const latency_histogram_t& other) {
+        for(size_t i = 0; i < NUM_BUCKETS; i++) {
+            buckets[i] += other.buckets[i];
+        }
+
+        count += other.count;
+    }
+
+    uint64_t value_at_percentile(double percentile) const;
+};
+
 class AppMetrics {
 private:
-    mutable std::shared_mutex mutex;
+    // Each thread records into its own shard, so the shard's lock is almost never contended.
+    // The shards are merged into the completed window during `window_reset()`.
+    struct alignas(64) metrics_shard_t {
+        std::mutex mutex;
+        spp::sparse_hash_map<std::string, uint64_t> counts;
+        spp::sparse_hash_map<std::string, uint64_t> durations;
+        std::unordered_map<std::string, latency_histogram_t> histograms;
+        std::unordered_map<std::string, latency_histogram_t> collection_histograms;
+    };
+
+    static constexpr size_t NUM_SHARDS = 16;
 
-    // stores last complete window
-    spp::sparse_hash_map<std::string, uint64_t>* counts;
-    spp::sparse_hash_map<std::string, uint64_t>* durations;
+    mutable std::shared_mutex mutex;
 
     // stores the current window
-    spp::sparse_hash_map<std::string, uint64_t>* current_counts;
-    spp::sparse_hash_map<std::string, uint64_t>* current_durations;
+    std::array<metrics_shard_t, NUM_SHARDS> shards;
+
+    // stores last complete window
+    spp::sparse_hash_map<std::string, uint64_t> counts;
+    spp::sparse_hash_map<std::string, uint64_t> durations;
+    std::unordered_map<std::string, latency_histogram_t> histograms;
+    std::unordered_map<std::string, latency_histogram_t> collection_histograms;
 
     std::string access_log_path;
     std::ofstream access_log;
 
     AppMetrics() {
-        current_counts = new spp::sparse_hash_map<std::string, uint64_t>();
-        counts = new spp::sparse_hash_map<std::string, uint64_t>();
-
-        current_durations = new spp::sparse_hash_map<std::string, uint64_t>();
-        durations = new spp::sparse_hash_map<std::string, uint64_t>();
-
         access_log_path = Config::get_instance().get_access_log_path();
         if(Config::get_instance().get_enable_access_logging() && !access_log_path.empty()) {
             access_log.open(access_log_path, std::ofstream::out | std::ofstream::app);
         }
     }
 
-    ~AppMetrics() {
-        delete current_counts;
-        delete counts;
+    ~AppMetrics() = default;
 
-        delete current_durations;
-        delete durations;
+    metrics_shard_t& get_shard() {
+        static std::atomic<size_t> next_shard_id = 0;
+        thread_local const size_t shard_id = next_shard_id++ % NUM_SHARDS;
+        return shards[shard_id];
     }
 
+    static void add_percentiles(const latency_histogram_t& histogram, nlohmann::json& result);
+
 public:
     static inline const std::string SEARCH_LABEL = "search";
     static inline const std::string DOC_WRITE_LABEL = "write";
@@ -55,6 +120,8 @@ public:
 
     static const uint64_t METRICS_REFRESH_INTERVAL_MS = 10 * 1000;
 
+    static constexpr double PERCENTILES[] = {50, 95, 99};
+
     static AppMetrics & get_instance() {
         static AppMetrics instance;
         return instance;
@@ -64,13 +131,22 @@ public:
     void operator=(AppMetrics const&) = delete;
 
     void increment_count(const std::string& identifier, uint64_t count) {
-        std::unique_lock lock(mutex);
-        (*current_counts)[identifier] += count;
+        auto& shard = get_shard();
+        std::lock_guard lock(shard.mutex);
+        shard.counts[identifier] += count;
     }
 
     void increment_duration(const std::string& identifier, uint64_t duration) {
-        std::unique_lock lock(mutex);
-        (*current_durations)[identifier] += duration;
+        auto& shard = get_shard();
+        std::lock_guard lock(shard.mutex);
+        shard.durations[identifier] += duration;
+        shard.histograms[identifier].record(duration);
+    }
+
+    void increment_collection_duration(const std::string& collection_name, uint64_t duration) {
+        auto& shard = get_shard();
+        std::lock_guard lock(shard.mutex);
+        shard.collection_histograms[collection_name].record(duration);
     }
 
     void increment_write_metrics(uint64_t route_hash, uint64_t duration);
@@ -82,4 +158,6 @@ public:
     void window_reset();
 
     void get(const std::string& rps_key, const std::string& latency_key, nlohmann::json &result) const;
+
+    void get_prometheus(std::string& result) const;
 };
@@ -54,7 +54,7 @@ private:
     const size_t num_threads;
 
     await_t* qmutuxes;
-    std::vector<std::deque<uint64_t>> queues;
+    std::vector<indexer_queue_t> queues;
 
     std::unordered_map<std::string, std::unordered_set<std::string>> coll_to_references;
     await_t refq_wait;
@@ -84,6 +84,11 @@ private:
     std::string skip_index_upper_bound_key = std::string(SKIP_INDICES_PREFIX) + "`";  // cannot inline this
     rocksdb::Slice* skip_index_iter_upper_bound = nullptr;
 
+    // Writes up to this log index are not coalesced, since a group of coalesced writes that contains them previously
+    // triggered a crash: they are indexed one by one so that only the write that crashes again is skipped.
+    std::atomic<int64_t> uncoalesced_until_index = UNSET_SKIP_INDEX;
+    static constexpr const char* UNCOALESCED_UNTIL_INDEX_KEY = "$XU";
+
     // When set, all writes (both live and log serialized) are skipped with 422 response
     const std::atomic<bool>& skip_writes;
 
@@ -96,8 +101,46 @@ private:
 
     static std::string get_req_suffix_key(uint64_t req_id);
 
+    // returns the request when it is a complete single document write that can be indexed in a batch with others
+    std::shared_ptr<http_req> get_coalescable_write(uint64_t req_id);
+
+    static bool can_coalesce(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_req>& other_req);
+
+    // pops the writes that are queued right behind `req_id` and that can be indexed in the same batch as it
+    std::vector<uint64_t> pop_coalesced_writes(uint64_t req_id, std::deque<queued_req_t>& queue, await_t& queue_mutex);
+
+    void queue_write(uint64_t queue_id, const std::string& coll_name, uint64_t req_id, bool is_small);
+
+    static uint64_t now_ms();
+
+    void index_coalesced_writes(const std::vector<uint64_t>& req_ids);
+
 public:
 
+    struct queued_req_t {
+        uint64_t req_id;
+        uint64_t queued_at_ms;
+        bool is_small;              // single chunk writes are served ahead of the turn of their collection
+
+        queued_req_t(uint64_t req_id, uint64_t queued_at_ms, bool is_small):
+                req_id(req_id), queued_at_ms(queued_at_ms), is_small(is_small) {
+
+        }
+    };
+
+    struct coll_queue_t {
+        std::deque<queued_req_t> reqs;
+        bool is_active = false;     // whether the collection is waiting for its turn or being served
+    };
+
+    // Writes of a collection are indexed in their order, but an indexing thread takes turns between the collections
+    // whose writes hash to it, so that a large import cannot hold up the writes of other collections.
+    struct indexer_queue_t {
+        std::unordered_map<std::string, coll_queue_t> coll_queues;
+        std::deque<std::string> turns;
+        bool last_turn_prioritized = false;
+    };
+
     static const constexpr char* RAFT_REQ_LOG_PREFIX = "$RL_";
 
     BatchedIndexer(HttpServer* server, Store* store, Store* meta_store, size_t num_threads,
@@ -109,6 +152,9 @@ public:
 
     int64_t get_queued_writes();
 
+    // number of queued requests of each collection and the time for which the oldest of them has been waiting
+    void get_queue_stats(nlohmann::json& stats);
+
     void run();
 
     void stop();
@@ -127,4 +173,19 @@ public:
     std::string get_collection_name(const std::shared_ptr<http_req>& req);
 
     std::shared_mutex& get_pause_mutex();
+
+    // The scheduling of the writes of a queue is done by these functions, which require the lock of the queue.
+
+    // queues a write behind the other writes of its collection
+    static void push_write(indexer_queue_t& queue, const std::string& coll_name, const queued_req_t& queued_req);
+
+    // picks the collection to be served next and takes it off the turns
+    static std::string next_turn(indexer_queue_t& queue);
+
+    // ends the turn of the collection: a yielded request stays at the front of its queue
+    static void end_turn(indexer_queue_t& queue, const std::string& coll_name, const queued_req_t& queued_req,
+                         bool is_yielded);
+
+    // for testing
+    indexer_queue_t& _get_queue(size_t queue_id);
 };
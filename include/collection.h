@@ -180,6 +180,10 @@ private:
 
     void process_remove_field_for_embedding_fields(const field& del_field, std::vector<field>& garbage_embed_fields);
 
+    // Embeddings can be deferred only when the fields that they are embedded from are stored, since they are generated
+    // from the stored documents later. Requires the lock of the collection.
+    bool are_embedding_sources_stored() const;
+
     bool does_override_match(const override_t& override, std::string& query,
                              std::set<uint32_t>& excluded_set,
                              std::string& actual_query, const std::string& filter_query,
@@ -360,6 +364,10 @@ public:
     static constexpr const char* COLLECTION_VOICE_QUERY_MODEL = "voice_query_model";
 
     static constexpr const char* COLLECTION_METADATA = "metadata";
+    static constexpr const char* COLLECTION_INDEX_CONCURRENCY = "index_concurrency";
+
+    // lines of an import that are parsed by a single task of the index thread pool
+    static constexpr size_t PARSE_CHUNK_SIZE = 100;
 
     /// Value used when async_reference is true and a reference doc is not found.
     static constexpr int64_t reference_helper_sentinel_value = UINT32_MAX;
@@ -425,11 +433,25 @@ public:
 
     void update_metadata(const nlohmann::json& meta);
 
+    // tasks that a write batch is indexed with, 0 for the server default
+    void set_index_concurrency(size_t concurrency);
+
+    size_t get_index_concurrency() const;
+
     Option<doc_seq_id_t> to_doc(const std::string& json_str, nlohmann::json& document,
                                 const index_operation_t& operation,
                                 const DIRTY_VALUES dirty_values,
                                 const std::string& id="");
 
+    // same as above, for a document that is already parsed
+    Option<doc_seq_id_t> to_doc(nlohmann::json& document, const index_operation_t& operation,
+                                const DIRTY_VALUES dirty_values, const std::string& id="");
+
+    // Parses the lines from `begin` to `end` in parallel on the index thread pool. The document or the parse error of
+    // each line is placed in `documents` and `errors` respectively, at the offset of the line from `begin`.
+    static void parse_json_lines(const std::vector<std::string>& json_lines, size_t begin, size_t end,
+                                 std::vector<nlohmann::json>& documents, std::vector<std::string>& errors);
+
 
     static uint32_t get_seq_id_from_key(const std::string & key);
 
@@ -491,7 +513,20 @@ public:
     nlohmann::json get_summary_json() const;
 
     size_t batch_index_in_memory(std::vector<index_record>& index_records, const size_t remote_embedding_batch_size,
-                                 const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries, const bool generate_embeddings);
+                                 const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries, const bool generate_embeddings,
+                                 const bool defer_embeddings = false);
+
+    // whether an embedding field of the document is missing, while the fields that it is embedded from are present
+    bool needs_embeddings(const nlohmann::json& document, const bool stored_fields_only) const;
+
+    // Generates the embeddings of stored documents as partial updates (`id` and the embedding fields) of the documents,
+    // which are written like any other update. Collects the documents whose embeddings could not be generated.
+    void embed_documents(const std::vector<uint32_t>& seq_ids, const size_t remote_embedding_batch_size,
+                         const size_t remote_embedding_timeout_ms, std::vector<uint32_t>& failed_seq_ids,
+                         std::vector<std::pair<uint32_t, std::string>>& update_docs);
+
+    // removes the documents whose stored copies are no longer missing embeddings
+    void remove_embedded_documents(std::vector<uint32_t>& seq_ids);
 
     Option<nlohmann::json> add(const std::string & json_str,
                                const index_operation_t& operation=CREATE, const std::string& id="",
@@ -517,6 +552,12 @@ public:
 
     void do_housekeeping();
 
+    void save_vector_indices(const std::string& dir_path) const;
+
+    void load_vector_indices(const std::string& dir_path);
+
+    void finish_vector_index_restore();
+
     Option<nlohmann::json> search(std::string query, const std::vector<std::string> & search_fields,
                                   const std::string & filter_query, const std::vector<std::string> & facet_fields,
                                   const std::vector<sort_by> & sort_fields, const std::vector<uint32_t>& num_typos,
@@ -679,6 +720,9 @@ public:
 
     Option<bool> truncate_after_top_k(const std::string& field_name, size_t k);
 
+    // removes the documents that were deleted lazily from the in-memory indices, returns their count
+    size_t purge_tombstones();
+
     Option<bool> reference_populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                                  std::vector<sort_by>& sort_fields_std,
                                                  std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values) const;
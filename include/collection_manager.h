@@ -56,8 +56,16 @@ private:
     mutable std::shared_mutex noop_coll_mutex;
 
     Store *store;
+
+    // used for searches
     ThreadPool* thread_pool;
 
+    // used for in-memory indexing of writes
+    ThreadPool* index_thread_pool = nullptr;
+
+    // used for background work that is not latency sensitive
+    ThreadPool* background_thread_pool = nullptr;
+
     AuthManager auth_manager;
 
     spp::sparse_hash_map<std::string, Collection*> collections;
@@ -81,6 +89,9 @@ private:
     // All the references to a particular collection are stored until it is created.
     std::map<std::string, std::set<reference_info_t>> referenced_in_backlog;
 
+    // directory of the vector indices that were saved with the snapshot that is being loaded
+    std::string vector_index_snapshot_path;
+
     CollectionManager();
 
     ~CollectionManager() = default;
@@ -100,6 +111,9 @@ public:
 
     static constexpr const char* NEXT_COLLECTION_ID_KEY = "$CI";
     static constexpr const char* SYMLINK_PREFIX = "$SL";
+
+    // raft index at which the vector indices in a snapshot were saved
+    static constexpr const char* VECTOR_INDEX_SNAPSHOT_KEY = "$VI";
     static constexpr const char* PRESET_PREFIX = "$PS";
 
     uint16_t filter_by_max_ops;
@@ -139,7 +153,8 @@ public:
 
     // PUBLICLY EXPOSED API
 
-    void init(Store *store, ThreadPool* thread_pool, const float max_memory_ratio,
+    void init(Store *store, ThreadPool* thread_pool, ThreadPool* index_thread_pool,
+              ThreadPool* background_thread_pool, const float max_memory_ratio,
               const std::string & auth_key, std::atomic<bool>& quit,
               const uint16_t& filter_by_max_operations = Config::FILTER_BY_DEFAULT_OPERATIONS);
 
@@ -152,6 +167,14 @@ public:
     // frees in-memory data structures when server is shutdown - helps us run a memory leak detector properly
     void dispose();
 
+    // Saves the vector indices of all collections into `dir_path`, tagged with the raft `applied_index` at which the
+    // save began. Writes can continue during the save.
+    void save_vector_indices(const std::string& dir_path, int64_t applied_index) const;
+
+    // Vector indices are loaded from `dir_path` by the next `load()` if they were not saved before the raft index in
+    // `VECTOR_INDEX_SNAPSHOT_KEY` of the store. Pass an empty path to rebuild them from the documents instead.
+    void set_vector_index_snapshot_path(const std::string& dir_path);
+
     bool auth_key_matches(const string& req_auth_key, const string& action,
                           const std::vector<collection_key_t>& collection_keys,
                           std::map<std::string, std::string>& params,
@@ -167,7 +190,8 @@ public:
                                           const std::vector<std::string>& symbols_to_index = {},
                                           const std::vector<std::string>& token_separators = {},
                                           const bool enable_nested_fields = false, std::shared_ptr<VQModel> model = nullptr,
-                                          const nlohmann::json& metadata = {});
+                                          const nlohmann::json& metadata = {},
+                                          const size_t index_concurrency = 0);
 
     locked_resource_view_t<Collection> get_collection(const std::string & collection_name) const;
 
@@ -191,6 +215,12 @@ public:
 
     ThreadPool* get_thread_pool() const;
 
+    ThreadPool* get_index_thread_pool() const;
+
+    ThreadPool* get_background_thread_pool() const;
+
+    void get_thread_pool_stats(nlohmann::json& result) const;
+
     AuthManager& getAuthManager();
 
     static Option<bool> do_search(std::map<std::string, std::string>& req_params,
@@ -35,6 +35,10 @@ bool get_export_documents(const std::shared_ptr<http_req>& req, const std::share
 
 bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
+// Same as `post_add_document` for writes to the same collection with the same parameters, indexed as one batch.
+void post_add_coalesced_documents(const std::vector<std::shared_ptr<http_req>>& reqs,
+                                  const std::vector<std::shared_ptr<http_res>>& ress);
+
 bool patch_update_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
 bool patch_update_documents(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
@@ -121,6 +125,8 @@ bool get_metrics_json(const std::shared_ptr<http_req>& req, const std::shared_pt
 
 bool get_stats_json(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
+bool get_stats_prometheus(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
+
 bool get_status(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
 // operations
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <filesystem>
 #include <mutex>
@@ -7,6 +8,7 @@
 #include <openssl/md5.h>
 #include <fstream>
 #include "logger.h"
+#include "lru/lru.hpp"
 #include "http_client.h"
 #include "option.h"
 #include "text_embedder.h"
@@ -51,6 +53,18 @@ public:
     void delete_image_embedder(const std::string& model_path);
     void delete_all_image_embedders();
 
+    // Embeds a search query with its query prefix. Embeddings are cached by model and whitespace normalized query, so
+    // that repeated queries do not run the model (or call the remote API) again.
+    embedding_res_t embed_query(const nlohmann::json& model_config, TextEmbedder* embedder, const std::string& query,
+                                size_t remote_embedding_timeout_ms, size_t remote_embedding_num_tries);
+
+    void set_query_embedding_cache_capacity(size_t capacity);
+    void clear_query_embedding_cache();
+    void get_query_embedding_cache_stats(nlohmann::json& result);
+
+    // trims the query and collapses runs of whitespace into a single space
+    static std::string normalize_query(const std::string& query);
+
     static const TokenizerType get_tokenizer_type(const nlohmann::json& model_config);
     const std::string get_indexing_prefix(const nlohmann::json& model_config);
     const std::string get_query_prefix(const nlohmann::json& model_config);
@@ -89,13 +103,22 @@ public:
     }
 
 private:
-    EmbedderManager() = default;
+    EmbedderManager();
 
     std::unordered_map<std::string, std::shared_ptr<TextEmbedder>> text_embedders;
     std::unordered_map<std::string, std::shared_ptr<ImageEmbedder>> image_embedders;
     std::unordered_map<std::string, text_embedding_model> public_models;
     std::mutex text_embedders_mutex, image_embedders_mutex;
 
+    // shared by all the collections that use a model, keyed on the model key and the text that is embedded
+    LRU::Cache<std::string, std::vector<float>> query_embedding_cache;
+    std::atomic<size_t> query_embedding_cache_capacity = 0;
+    std::mutex query_embedding_cache_mutex;
+    std::atomic<uint64_t> query_embedding_cache_hits = 0;
+    std::atomic<uint64_t> query_embedding_cache_misses = 0;
+
+    static std::string get_model_key(const nlohmann::json& model_config);
+
     static Option<std::string> get_namespace(const std::string& model_name);
 };
 
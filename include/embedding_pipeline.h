@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "json.hpp"
+
+class ReplicationState;
+
+// Generates the embeddings of written documents in the background, so that writes to collections with auto-embedding
+// fields don't wait on the embedding model. The documents are searchable on their other fields as soon as they are
+// written, and their vectors are added when their embeddings are ready.
+//
+// Only the leader generates embeddings. They are written as an import of partial updates through the leader's API, so
+// that the write is replicated and is ordered with the other writes of the collection.
+class EmbeddingPipeline {
+private:
+    struct job_t {
+        uint32_t collection_id;
+        std::vector<uint32_t> seq_ids;
+        size_t remote_embedding_batch_size;
+        size_t remote_embedding_timeout_ms;
+        size_t num_tries = 0;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+
+    std::deque<job_t> jobs;
+
+    // failed jobs, keyed on the time after which they are tried again
+    std::multimap<std::chrono::steady_clock::time_point, job_t> retry_jobs;
+
+    std::atomic<bool> enabled = false;
+    std::atomic<bool> quit = false;
+
+    size_t concurrency = 4;
+    size_t num_tries = 3;
+
+    // documents that are queued, being embedded or waiting to be tried again
+    std::atomic<size_t> num_pending_docs = 0;
+    std::atomic<size_t> num_embedded_docs = 0;
+    std::atomic<size_t> num_failed_docs = 0;
+
+    static constexpr size_t RETRY_BACKOFF_MS = 1000;
+
+    // interval at which a follower checks whether the embeddings of its queued documents have been written
+    static constexpr size_t FOLLOWER_RECHECK_MS = 5000;
+
+    static constexpr size_t WRITE_TIMEOUT_MS = 60 * 1000;
+
+    // larger inputs are split, so that the workers share them
+    static constexpr size_t MAX_JOB_SIZE = 500;
+
+    EmbeddingPipeline() = default;
+
+    ~EmbeddingPipeline() = default;
+
+    // blocks until a job is due, returns false on quit
+    bool next_job(job_t& job);
+
+    void retry_job(job_t&& job, size_t delay_ms);
+
+    void process_jobs(ReplicationState* raft_server);
+
+    // writes the partial updates of the documents, collects the documents that could not be updated
+    static size_t write_embeddings(ReplicationState* raft_server, const std::string& collection_name,
+                                   const std::vector<std::pair<uint32_t, std::string>>& update_docs,
+                                   std::vector<uint32_t>& failed_seq_ids);
+
+public:
+
+    static EmbeddingPipeline& get_instance() {
+        static EmbeddingPipeline instance;
+        return instance;
+    }
+
+    EmbeddingPipeline(EmbeddingPipeline const&) = delete;
+
+    void operator=(EmbeddingPipeline const&) = delete;
+
+    // once initialized, writes hand over embedding generation to the pipeline
+    void init(size_t concurrency, size_t num_tries);
+
+    bool is_enabled() const {
+        return enabled;
+    }
+
+    void enqueue(uint32_t collection_id, std::vector<uint32_t>&& seq_ids, size_t remote_embedding_batch_size,
+                 size_t remote_embedding_timeout_ms);
+
+    // Runs the workers until `stop()` is called. Without a `raft_server`, as in tests, the embeddings are written to
+    // the local collection directly.
+    void run(ReplicationState* raft_server);
+
+    // Queued documents are dropped: their stored copies don't have the embeddings, so they are queued again when the
+    // collection is loaded.
+    void stop();
+
+    size_t get_num_pending_docs() const {
+        return num_pending_docs;
+    }
+
+    void get_stats(nlohmann::json& stats) const;
+};
@@ -80,6 +80,7 @@ namespace fields {
     static const std::string store = "store";
     
     static const std::string hnsw_params = "hnsw_params";
+    static const std::string ivf_params = "ivf_params";
 }
 
 enum vector_distance_type_t {
@@ -87,6 +88,13 @@ enum vector_distance_type_t {
     cosine
 };
 
+// format in which the vectors of a field are stored in its HNSW graph
+enum class vector_quantization_t {
+    none,
+    float16,
+    int8
+};
+
 struct reference_pair_t {
     std::string collection;
     std::string field;
@@ -132,6 +140,9 @@ struct field {
   
     nlohmann::json hnsw_params;
 
+    // when set, vectors are indexed by an IVF index instead of a HNSW graph
+    nlohmann::json ivf_params;
+
     field() {}
 
     field(const std::string &name, const std::string &type, const bool facet, const bool optional = false,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <map>
 #include <utility>
@@ -231,11 +232,15 @@ struct filter_result_iterator_timeout_info {
         function_call_counter = obj.function_call_counter;
         search_begin_us = obj.search_begin_us;
         search_stop_us = obj.search_stop_us;
+        client_alive = obj.client_alive;
     }
 
     uint16_t function_call_counter = 0;
     uint64_t search_begin_us = 0;
     uint64_t search_stop_us = UINT64_MAX;
+
+    // liveness flag of the client that issued the search, captured from the constructing thread
+    const std::atomic<bool>* client_alive = nullptr;
 };
 
 class filter_result_iterator_t {
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <vector>
+#include "field.h"
+#include "ivf_index.h"
+#include "option.h"
+#include "threadpool.h"
+#include "vector_distance.h"
+#include "hnswlib/hnswlib.h"
+
+// Inner product distance between full precision vectors, computed with the widest SIMD kernel that the CPU supports.
+class FloatInnerProductSpace: public hnswlib::SpaceInterface<float> {
+private:
+    size_t dim;
+
+public:
+    explicit FloatInnerProductSpace(size_t dim): dim(dim) {}
+
+    size_t get_data_size() override {
+        return dim * sizeof(float);
+    }
+
+    hnswlib::DISTFUNC<float> get_dist_func() override {
+        return vector_distance::kernels().inner_product_distance;
+    }
+
+    void* get_dist_func_param() override {
+        return &dim;
+    }
+};
+
+// Inner product distance between vectors that are stored as IEEE 754 half precision floats.
+class Float16InnerProductSpace: public hnswlib::SpaceInterface<float> {
+private:
+    size_t dim;
+
+public:
+    explicit Float16InnerProductSpace(size_t dim): dim(dim) {}
+
+    size_t get_data_size() override {
+        return dim * sizeof(uint16_t);
+    }
+
+    hnswlib::DISTFUNC<float> get_dist_func() override {
+        return distance;
+    }
+
+    void* get_dist_func_param() override {
+        return &dim;
+    }
+
+    static float distance(const void* a, const void* b, const void* param);
+
+    static uint16_t encode(float value);
+
+    static float decode(uint16_t code);
+};
+
+// Inner product distance between vectors that are scalar quantized to int8, with a scale per dimension.
+class Int8InnerProductSpace: public hnswlib::SpaceInterface<float> {
+public:
+    struct params_t {
+        // hnswlib reads the dimension from the start of the distance function's param
+        size_t dim;
+        const float* sq_scales;
+    };
+
+private:
+    std::vector<float> scales;
+    std::vector<float> sq_scales;
+    params_t params;
+
+public:
+    explicit Int8InnerProductSpace(size_t dim);
+
+    size_t get_data_size() override {
+        return params.dim * sizeof(int8_t);
+    }
+
+    hnswlib::DISTFUNC<float> get_dist_func() override {
+        return distance;
+    }
+
+    void* get_dist_func_param() override {
+        return &params;
+    }
+
+    // derives the scales from the largest absolute value seen on each dimension
+    void set_scales(const std::vector<float>& max_abs_values);
+
+    const std::vector<float>& get_scales() const {
+        return scales;
+    }
+
+    void restore_scales(const std::vector<float>& saved_scales);
+
+    void encode(const float* values, int8_t* codes) const;
+
+    void decode(const int8_t* codes, float* values) const;
+
+    static float distance(const void* a, const void* b, const void* param);
+};
+
+struct hnsw_index_t {
+    // used for exact distances between full precision (or decoded) vectors
+    FloatInnerProductSpace* space;
+
+    // space of the vectors stored in the graph: differs from `space` only when the vectors are quantized
+    hnswlib::SpaceInterface<float>* graph_space;
+
+    hnswlib::HierarchicalNSW<float>* vecdex;
+    size_t num_dim;
+    vector_distance_type_t distance_type;
+    vector_quantization_t quantization;
+
+    // When the field asks for an IVF index, vectors are stored in it instead of in the graph, which then stays empty.
+    ivf_index_t* ivf = nullptr;
+    size_t ivf_nprobe = DEFAULT_IVF_NPROBE;
+
+    // ensures that this index is not dropped when it's being repaired
+    std::mutex repair_m;
+
+    // Number of vectors from which the per-dimension scales of int8 quantization are derived. Until then, vectors
+    // are held at full precision outside of the graph and are searched exhaustively.
+    static constexpr size_t QUANTIZATION_TRAINING_SIZE = 1000;
+
+    // IVF centroids are likewise derived from the first vectors: at least this many per centroid
+    static constexpr size_t IVF_TRAINING_SIZE_PER_LIST = 40;
+
+    static constexpr size_t DEFAULT_IVF_NLIST = 256;
+    static constexpr size_t DEFAULT_IVF_NPROBE = 8;
+
+    hnsw_index_t(size_t num_dim, size_t init_size, vector_distance_type_t distance_type, size_t M = 16,
+                 size_t ef_construction = 200, vector_quantization_t quantization = vector_quantization_t::none,
+                 const nlohmann::json& ivf_params = nlohmann::json());
+
+    ~hnsw_index_t();
+
+    // vectors of cosine fields are expected to be normalized by the caller
+    void add_point(const std::vector<float>& values, size_t label);
+
+    void remove_point(size_t label);
+
+    // decodes the stored vector, throws when the label is not found
+    std::vector<float> get_point(size_t label);
+
+    // `nprobe` and `thread_pool` apply only to IVF: a `nprobe` of 0 probes the field's default number of partitions
+    std::vector<std::pair<float, size_t>> search_knn(const std::vector<float>& query, size_t k, size_t ef,
+                                                     hnswlib::BaseFilterFunctor* filter, size_t nprobe = 0,
+                                                     ThreadPool* thread_pool = nullptr);
+
+    static vector_quantization_t get_quantization(const nlohmann::json& hnsw_params);
+
+    // writes the graph to `file_path` and the state needed to load it back into `meta`
+    Option<bool> save(const std::string& file_path, nlohmann::json& meta);
+
+    // Replaces the graph with the one saved at `file_path`. Until `finish_restore()` is called, `add_point()` skips
+    // the labels that are already in the loaded graph.
+    Option<bool> load(const std::string& file_path, const nlohmann::json& meta);
+
+    // removes the labels of the loaded graph that were not added again, returns their count
+    size_t finish_restore();
+
+    // needed for cosine similarity
+    static void normalize_vector(const std::vector<float>& src, std::vector<float>& norm_dest) {
+        vector_distance::kernels().normalize(src.data(), norm_dest.data(), src.size());
+    }
+
+private:
+    std::shared_mutex training_m;
+    std::atomic<bool> trained;
+    std::map<size_t, std::vector<float>> training_points;
+    size_t training_size = QUANTIZATION_TRAINING_SIZE;
+
+    std::mutex restore_m;
+    std::atomic<bool> restoring = false;
+    std::unordered_set<size_t> restored_labels;
+
+    // whether the label is in the graph with the given vector, as stored in the graph
+    bool contains(size_t label, const void* data);
+
+    void encode(const std::vector<float>& values, std::vector<uint8_t>& codes) const;
+
+    void train();
+};
@@ -2,6 +2,7 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 
 class HouseKeeper {
 private:
@@ -16,6 +17,7 @@ private:
 
     ~HouseKeeper() {}
 
+    static void run_in_background(const std::function<void()>& job);
 
 public:
 
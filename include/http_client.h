@@ -2,6 +2,9 @@
 
 #include <string>
 #include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <curl/curl.h>
 #include "http_data.h"
 #include "http_server.h"
@@ -14,6 +17,11 @@ private:
     static std::string api_key;
     static std::string ca_cert_path;
 
+    // Handles of finished requests are kept per host, since a handle keeps its connection alive for the next request
+    // to the same host. All handles share their DNS cache and TLS sessions.
+    static std::mutex idle_handles_mutex;
+    static std::unordered_map<std::string, std::vector<CURL*>> idle_handles;
+
     HttpClient() = default;
 
     ~HttpClient() = default;
@@ -30,6 +38,15 @@ private:
 
     static size_t curl_write_download(void *ptr, size_t size, size_t nmemb, FILE *stream);
 
+    static CURLSH* get_share();
+
+    // scheme, host and port of the url
+    static std::string get_host_key(const std::string& url);
+
+    static CURL* acquire_handle(const std::string& url);
+
+    static void release_handle(CURL* curl);
+
     static CURL* init_curl(const std::string& url, std::string& response, const size_t timeout_ms = 0);
 
     static CURL* init_curl_async(const std::string& url, deferred_req_res_t* req_res, curl_slist*& chunk,
@@ -42,6 +59,8 @@ private:
                              struct curl_slist *chunk = nullptr,
                              bool send_ts_api_header = false);
 public:
+    static constexpr size_t MAX_IDLE_HANDLES_PER_HOST = 16;
+
     static HttpClient & get_instance() {
         static HttpClient instance;
         return instance;
@@ -88,4 +107,6 @@ public:
                                bool send_ts_api_header = false);
 
     static void extract_response_headers(CURL* curl, std::map<std::string, std::string> &res_headers);
+
+    static size_t get_num_idle_handles();
 };
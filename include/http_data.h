@@ -254,6 +254,9 @@ struct http_req {
     static constexpr const char* USER_HEADER = "x-typesense-user-id";
     static constexpr const char* AGENT_HEADER = "user-agent";
 
+    // time budget of a search in milliseconds, measured from when the request was received
+    static constexpr const char* DEADLINE_HEADER = "x-typesense-deadline-ms";
+
     h2o_req_t* _req;
     std::string http_method;
     std::string path_without_query;
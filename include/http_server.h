@@ -294,5 +294,7 @@ public:
 
     int64_t get_num_queued_writes();
 
+    void get_write_queue_stats(nlohmann::json& stats);
+
     void decr_pending_writes();
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <map>
 #include <unordered_map>
 #include <vector>
 #include <mutex>
@@ -29,6 +30,7 @@
 #include "override.h"
 #include "vector_query_ops.h"
 #include "hnswlib/hnswlib.h"
+#include "hnsw_index.h"
 #include "filter.h"
 #include "facet_index.h"
 #include "numeric_range_trie.h"
@@ -172,6 +174,7 @@ struct search_args {
     std::vector<std::vector<KV*>> override_result_kvs;
 
     vector_query_t& vector_query;
+    vector_search_strategy_t vector_search_strategy = vector_search_strategy_t::none;
     size_t facet_sample_percent;
     size_t facet_sample_threshold;
     drop_tokens_param_t drop_tokens_mode;
@@ -311,41 +314,6 @@ public:
     }
 };
 
-struct hnsw_index_t {
-    hnswlib::InnerProductSpace* space;
-    hnswlib::HierarchicalNSW<float>* vecdex;
-    size_t num_dim;
-    vector_distance_type_t distance_type;
-
-    // ensures that this index is not dropped when it's being repaired
-    std::mutex repair_m;
-
-    hnsw_index_t(size_t num_dim, size_t init_size, vector_distance_type_t distance_type, size_t M = 16, size_t ef_construction = 200) :
-        space(new hnswlib::InnerProductSpace(num_dim)),
-        vecdex(new hnswlib::HierarchicalNSW<float>(space, init_size, M, ef_construction, 100, true)),
-        num_dim(num_dim), distance_type(distance_type) {
-
-    }
-
-    ~hnsw_index_t() {
-        std::lock_guard lk(repair_m);
-        delete vecdex;
-        delete space;
-    }
-
-    // needed for cosine similarity
-    static void normalize_vector(const std::vector<float>& src, std::vector<float>& norm_dest) {
-        float norm = 0.0f;
-        for (float i : src) {
-            norm += i * i;
-        }
-        norm = 1.0f / (sqrtf(norm) + 1e-30f);
-        for (size_t i = 0; i < src.size(); i++) {
-            norm_dest[i] = src[i] * norm;
-        }
-    }
-};
-
 struct group_by_field_it_t {
     std::string field_name;
     posting_list_t::iterator_t it;
@@ -377,8 +345,18 @@ private:
 
     const SynonymIndex* synonym_index;
 
+    // used for searches
     ThreadPool* thread_pool;
 
+    // used for in-memory indexing of writes
+    ThreadPool* index_thread_pool;
+
+    // tasks of a write batch that run at a time on the index thread pool, 0 for the server default
+    std::atomic<size_t> index_concurrency = 0;
+
+    // falls back to the server setting, and then to the size of the index thread pool
+    size_t get_effective_index_concurrency() const;
+
     size_t num_documents;
 
     tsl::htrie_map<char, field> search_schema;
@@ -421,6 +399,19 @@ private:
     // this is used for wildcard queries
     id_list_t* seq_ids;
 
+    // Documents that are deleted, but whose values are yet to be removed from the field indices, keyed on seq_id.
+    // Their seq_ids are excluded from search results until they are purged.
+    std::map<uint32_t, nlohmann::json> tombstones;
+
+    // Sorted seq_ids of `tombstones` from `tombstone_ids_head` onwards, which searches merge into their excluded ids
+    // as is. Purged ids are dropped from the front by advancing the head, and are compacted away once they make up
+    // half of the vector.
+    std::vector<uint32_t> tombstone_ids;
+    size_t tombstone_ids_head = 0;
+
+    // removes the values of a deleted document from the field indices, under the write lock
+    void purge_tombstone(uint32_t seq_id, nlohmann::json& document);
+
     std::vector<char> symbols_to_index;
 
     std::vector<char> token_separators;
@@ -560,6 +551,9 @@ private:
 
     std::vector<group_by_field_it_t> get_group_by_field_iterators(const std::vector<std::string>&, bool is_reverse=false) const;
 
+    // whether an update changes any of the fields that `embedding_field` is generated from, given the changed values
+    static bool embedding_source_changed(const field& embedding_field, const nlohmann::json& changed_doc);
+
     static void batch_embed_fields(std::vector<index_record*>& documents,
                                    const tsl::htrie_map<char, field>& embedding_fields,
                                    const tsl::htrie_map<char, field> & search_schema, const size_t remote_embedding_batch_size = 200,
@@ -593,6 +587,33 @@ public:
     // in the query that have the least individual hits one by one until enough results are found.
     static const int DROP_TOKENS_THRESHOLD = 1;
 
+    // Maximum number of records of a write batch that are indexed in memory under a single hold of the write lock.
+    static constexpr size_t WRITE_LOCK_BATCH_SIZE = 100;
+
+    // Records of a write batch are validated in this many slices per task, handed out to the tasks as they free up.
+    static constexpr size_t VALIDATION_SLICES_PER_TASK = 4;
+
+    // Maximum number of deleted documents that are purged from the in-memory indices under a single hold of the
+    // write lock.
+    static constexpr size_t TOMBSTONE_PURGE_BATCH_SIZE = 100;
+
+    // A search is forked into one thread per these many (estimated) documents of work.
+    static constexpr size_t SEARCH_DOCS_PER_THREAD = 10000;
+
+    // Upper bound on the number of threads that a single search is forked into.
+    static constexpr size_t MAX_SEARCH_CONCURRENCY = 16;
+
+    // Filtered vector searches whose filter matches at most these many documents compute exact distances to all of
+    // them instead of walking the graph.
+    static constexpr size_t VECTOR_BRUTE_FORCE_MAX_IDS = 2000;
+
+    // When the filter matches at least this fraction of the documents, the graph is searched without the filter and
+    // the neighbours are filtered afterwards.
+    static constexpr float VECTOR_POST_FILTER_MIN_SELECTIVITY = 0.5;
+
+    // Filtered graph searches scale `ef` up by the inverse of the filter's selectivity, up to this value.
+    static constexpr size_t VECTOR_FILTERED_MAX_EF = 4096;
+
     Index() = delete;
 
     Index(const std::string& name,
@@ -600,6 +621,7 @@ public:
           const Store* store,
           SynonymIndex* synonym_index,
           ThreadPool* thread_pool,
+          ThreadPool* index_thread_pool,
           const tsl::htrie_map<char, field>& search_schema,
           const std::vector<char>& symbols_to_index,
           const std::vector<char>& token_separators);
@@ -699,11 +721,12 @@ public:
                 const string& default_sorting_field, bool prioritize_exact_match,
                 const bool prioritize_token_position, const bool prioritize_num_matching_fields,
                 bool exhaustive_search,
-                size_t concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
+                size_t& concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
                 size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                 const size_t max_extra_suffix, const size_t facet_query_num_typos,
                 const bool filter_curated_hits, enable_t split_join_tokens,
-                const vector_query_t& vector_query, size_t facet_sample_percent, size_t facet_sample_threshold,
+                const vector_query_t& vector_query, vector_search_strategy_t& vector_search_strategy,
+                size_t facet_sample_percent, size_t facet_sample_threshold,
                 const std::string& collection_name,
                 const drop_tokens_param_t drop_tokens_mode,
                 const std::vector<facet_index_type_t>& facet_index_types,
@@ -721,6 +744,15 @@ public:
     Option<uint32_t> remove(const uint32_t seq_id, nlohmann::json & document,
                             const std::vector<field>& del_fields, const bool is_update);
 
+    // Hides a deleted document from searches right away, and leaves the removal of its values from the field indices
+    // to `purge_tombstones()`. Only for documents that are removed from the store, whose seq_ids are never reused.
+    void remove_lazily(const uint32_t seq_id, const nlohmann::json& document);
+
+    // returns the number of deleted documents that were purged, at most `max_purged`
+    size_t purge_tombstones(size_t max_purged = SIZE_MAX);
+
+    size_t num_tombstones() const;
+
     static void validate_and_preprocess(Index *index, std::vector<index_record>& iter_batch,
                                           const size_t batch_start_index, const size_t batch_size,
                                           const std::string & default_sorting_field,
@@ -730,7 +762,8 @@ public:
                                           const std::vector<char>& token_separators,
                                           const std::vector<char>& symbols_to_index,
                                           const bool do_validation, const size_t remote_embedding_batch_size = 200,
-                                          const size_t remote_embedding_timeout_ms = 60000, const size_t remote_embedding_num_tries = 2, const bool generate_embeddings = true);
+                                          const size_t remote_embedding_timeout_ms = 60000, const size_t remote_embedding_num_tries = 2, const bool generate_embeddings = true,
+                                          const bool defer_embeddings = false);
 
     static size_t batch_memory_index(Index *index,
                                      std::vector<index_record>& iter_batch,
@@ -747,7 +780,12 @@ public:
                                      const tsl::htrie_map<char, field>& addition_fields = tsl::htrie_map<char, field>(),
                                      const std::string& collection_name = "",
                                      const spp::sparse_hash_map<std::string, std::vector<reference_pair_t>>& async_referenced_ins =
-                                            spp::sparse_hash_map<std::string, std::vector<reference_pair_t>>());
+                                            spp::sparse_hash_map<std::string, std::vector<reference_pair_t>>(),
+                                     const bool defer_embeddings = false);
+
+    void set_index_concurrency(size_t concurrency);
+
+    size_t get_index_concurrency() const;
 
     void index_field_in_memory(const std::string& collection_name, const field& afield,
                                std::vector<index_record>& iter_batch,
@@ -802,6 +840,20 @@ public:
     Option<bool> search_infix(const std::string& query, const std::string& field_name, std::vector<uint32_t>& ids,
                               size_t max_extra_prefix, size_t max_extra_suffix) const;
 
+    std::vector<std::pair<float, size_t>> search_vector_index(hnsw_index_t* field_vector_index,
+                                                              const std::vector<float>& query_values, size_t k,
+                                                              size_t ef, size_t nprobe, const bool filter_by_provided,
+                                                              filter_result_iterator_t* filter_result_iterator,
+                                                              const uint32_t* excluded_ids,
+                                                              const size_t excluded_ids_length,
+                                                              vector_search_strategy_t& strategy) const;
+
+    size_t compute_search_concurrency(const std::vector<query_tokens_t>& field_query_tokens,
+                                      const std::vector<search_field_t>& the_fields, const size_t num_search_fields,
+                                      const bool is_wildcard_query, const bool filter_by_provided,
+                                      const size_t approx_filter_ids_length, const size_t num_facets,
+                                      const size_t max_concurrency) const;
+
     void curate_filtered_ids(const std::set<uint32_t>& curated_ids,
                              const uint32_t* exclude_token_ids, size_t exclude_token_ids_size, uint32_t*& filter_ids,
                              uint32_t& filter_ids_length, const std::vector<uint32_t>& curated_ids_sorted) const;
@@ -1062,6 +1114,14 @@ public:
 
     void repair_hnsw_index();
 
+    // saves the graph of every vector field as `<dir_path>/<file_prefix>_<n>.bin`, describing them in `meta`
+    void save_vector_indices(const std::string& dir_path, const std::string& file_prefix, nlohmann::json& meta) const;
+
+    void load_vector_indices(const std::string& dir_path, const nlohmann::json& meta);
+
+    // reconciles the loaded graphs with the documents that were indexed since they were loaded
+    void finish_vector_index_restore();
+
     void aggregate_facet(const size_t group_limit, facet& this_facet, facet& acc_facet) const;
 
     float get_distance(const string& geo_field_name, const uint32_t& seq_id,
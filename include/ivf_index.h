@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "hnswlib/hnswlib.h"
+#include "threadpool.h"
+
+// Inverted file index: vectors are partitioned by their nearest k-means centroid, and a search only scans the
+// partitions whose centroids are the nearest to the query. Vectors are stored in their partition at full precision
+// (IVF-flat), or as product quantization codes of a byte per sub-vector (IVF-PQ). Compared to a graph, it needs no
+// links per vector and is built in a single pass, at the cost of some recall.
+class ivf_index_t {
+private:
+    struct partition_t {
+        std::vector<size_t> labels;
+
+        // `num_dim` floats per vector with IVF-flat, `pq_m` codes with IVF-PQ
+        std::vector<float> values;
+        std::vector<uint8_t> codes;
+    };
+
+    const size_t num_dim;
+    const size_t nlist;
+    const size_t pq_m;
+    const size_t pq_dsub;
+
+    // nlist x num_dim
+    std::vector<float> centroids;
+
+    // pq_m x PQ_NUM_CENTROIDS x pq_dsub
+    std::vector<float> pq_codebooks;
+
+    std::vector<partition_t> partitions;
+
+    // partition and offset within it
+    std::unordered_map<size_t, std::pair<uint32_t, uint32_t>> label_positions;
+
+    mutable std::shared_mutex mutex;
+
+    size_t nearest_centroid(const float* values) const;
+
+    void encode(const float* values, uint8_t* codes) const;
+
+    void decode(const uint8_t* codes, float* values) const;
+
+    void remove_label(size_t label);
+
+    // scans the partitions of `probes` from `begin` to `end`, returns up to `k` nearest vectors in no order
+    std::vector<std::pair<float, size_t>> scan(const float* query, const float* pq_table, size_t k,
+                                               const std::vector<size_t>& probes, size_t begin, size_t end,
+                                               hnswlib::BaseFilterFunctor* filter) const;
+
+public:
+    static constexpr size_t PQ_NUM_CENTROIDS = 256;
+    static constexpr size_t KMEANS_NUM_ITERATIONS = 10;
+
+    // upper bound on the number of tasks that the partitions to be probed are split into
+    static constexpr size_t MAX_PROBE_TASKS = 4;
+
+    // PQ is used only when `pq_m` divides `num_dim`
+    ivf_index_t(size_t num_dim, size_t nlist, size_t pq_m);
+
+    bool is_pq() const {
+        return pq_m != 0;
+    }
+
+    // derives the centroids, and the codebooks of PQ, from the `num_points` vectors stored contiguously at `points`
+    void train(const float* points, size_t num_points);
+
+    void add_point(const float* values, size_t label);
+
+    void remove_point(size_t label);
+
+    bool contains(size_t label) const;
+
+    // values of a vector, decoded approximately with PQ, throws when the label is not found
+    std::vector<float> get_point(size_t label) const;
+
+    // distances are `1 - inner product`, the nearest first
+    std::vector<std::pair<float, size_t>> search_knn(const float* query, size_t k, size_t nprobe,
+                                                     hnswlib::BaseFilterFunctor* filter,
+                                                     ThreadPool* thread_pool) const;
+
+    size_t size() const;
+};
@@ -74,8 +74,7 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
 
             while(its.size() == it_size && its[0].valid()) {
                 num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                if (num_processed % 65536 == 0 && should_stop_search()) {
                     search_cutoff = true;
                     break;
                 }
@@ -106,8 +105,7 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
 
             while(its.size() == it_size && !at_end2(its)) {
                 num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                if (num_processed % 65536 == 0 && should_stop_search()) {
                     search_cutoff = true;
                     break;
                 }
@@ -144,8 +142,7 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
 
             while(its.size() == it_size && !at_end(its)) {
                 num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                if (num_processed % 65536 == 0 && should_stop_search()) {
                     search_cutoff = true;
                     break;
                 }
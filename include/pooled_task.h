@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include "threadpool.h"
+
+// A computation that is queued on a thread pool, but that is run by the thread asking for its result instead, if no
+// pool thread has picked it up by then. Waiting for the result is never slower than computing it inline, even when
+// the pool is saturated.
+template<typename T>
+class pooled_task_t {
+private:
+    std::function<T()> fn;
+    std::atomic<bool> claimed = false;
+    std::promise<T> promise;
+    std::shared_future<T> result;
+
+    void try_run() {
+        if(claimed.exchange(true)) {
+            return;
+        }
+
+        try {
+            promise.set_value(fn());
+        } catch(...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+public:
+    explicit pooled_task_t(std::function<T()> fn): fn(std::move(fn)), result(promise.get_future().share()) {}
+
+    // without a thread pool, the computation only runs when its result is asked for
+    static std::shared_ptr<pooled_task_t<T>> run(ThreadPool* thread_pool, std::function<T()> fn) {
+        auto task = std::make_shared<pooled_task_t<T>>(std::move(fn));
+        if(thread_pool != nullptr) {
+            thread_pool->enqueue([task]() {
+                task->try_run();
+            });
+        }
+
+        return task;
+    }
+
+    const T& get() {
+        try_run();
+        return result.get();
+    }
+
+    // waits for the computation if it has already started, and otherwise ensures that it never runs
+    void cancel() {
+        if(!claimed.exchange(true)) {
+            promise.set_exception(std::make_exception_ptr(std::runtime_error("Task was cancelled.")));
+            return;
+        }
+
+        result.wait();
+    }
+};
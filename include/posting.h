@@ -78,6 +78,10 @@ public:
 
     static void upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& offsets);
 
+    // IDs must be sorted and unique, see `posting_list_t::upsert_many` for the layout
+    static void upsert_many(void*& obj, uint32_t num_ids, const uint32_t* ids, const uint32_t* offset_index,
+                            uint32_t num_offsets, const uint32_t* offsets);
+
     static void erase(void*& obj, uint32_t id);
 
     static void destroy_list(void*& obj);
@@ -153,10 +153,20 @@ public:
 
     static void split_block(block_t* src_block, block_t* dst_block);
 
+    // appends IDs larger than the last ID of the block, in the layout of `upsert_many`
+    static void append_to_block(block_t* block, uint32_t num_ids, const uint32_t* ids, const uint32_t* offset_index,
+                                const uint32_t* offsets, uint32_t offsets_end);
+
     static void merge_adjacent_blocks(block_t* block1, block_t* block2, size_t num_block2_ids_to_move);
 
     void upsert(uint32_t id, const std::vector<uint32_t>& offsets);
 
+    // Upserts IDs that are sorted and unique, laid out like a block: the offsets of `ids[i]` begin at
+    // `offsets[offset_index[i]]`. IDs beyond the last ID of the list are appended a block at a time, so that each
+    // block is encoded only once.
+    void upsert_many(uint32_t num_ids, const uint32_t* ids, const uint32_t* offset_index,
+                     uint32_t num_offsets, const uint32_t* offsets);
+
     void erase(uint32_t id);
 
     void dump();
@@ -246,8 +256,7 @@ bool posting_list_t::block_intersect(std::vector<posting_list_t::iterator_t>& it
         case 1:
             while(its[0].valid()) {
                 num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                if (num_processed % 65536 == 0 && should_stop_search()) {
                     search_cutoff = true;
                     break;
                 }
@@ -262,8 +271,7 @@ bool posting_list_t::block_intersect(std::vector<posting_list_t::iterator_t>& it
         case 2:
             while(!at_end2(its)) {
                 num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                if (num_processed % 65536 == 0 && should_stop_search()) {
                     search_cutoff = true;
                     break;
                 }
@@ -282,8 +290,7 @@ bool posting_list_t::block_intersect(std::vector<posting_list_t::iterator_t>& it
         default:
             while(!at_end(its)) {
                 num_processed++;
-                if (num_processed % 65536 == 0 && (std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                if (num_processed % 65536 == 0 && should_stop_search()) {
                     search_cutoff = true;
                     break;
                 }
@@ -100,6 +100,7 @@ class ReplicationState : public braft::StateMachine {
 private:
     static constexpr const char* db_snapshot_name = "db_snapshot";
     static constexpr const char* analytics_db_snapshot_name = "analytics_db_snapshot";
+    static constexpr const char* vector_index_snapshot_name = "vector_index_snapshot";
     static constexpr const char* BATCHED_INDEXER_STATE_KEY = "$BI";
 
     mutable std::shared_mutex node_mutex;
@@ -126,6 +127,9 @@ private:
     std::atomic<bool> read_caught_up;
     std::atomic<bool> write_caught_up;
 
+    // index of the last log entry handed to the batched indexer
+    std::atomic<int64_t> last_applied_index = 0;
+
     std::string raft_dir_path;
 
     std::string ext_snapshot_path;
@@ -238,6 +242,8 @@ public:
 
     int64_t get_num_queued_writes();
 
+    void get_write_queue_stats(nlohmann::json& stats);
+
     bool is_leader();
 
     nlohmann::json get_status();
@@ -261,6 +267,7 @@ private:
         std::string state_dir_path;
         std::string db_snapshot_path;
         std::string analytics_db_snapshot_path;
+        std::string vector_index_snapshot_path;
         std::string ext_snapshot_path;
         braft::Closure* done;
     };
@@ -8,11 +8,16 @@
 #include <mutex>
 #include <thread>
 #include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 #include <option.h>
 #include <rocksdb/db.h>
 #include <rocksdb/write_batch.h>
 #include <rocksdb/options.h>
 #include <rocksdb/merge_operator.h>
+#include <rocksdb/table.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/cache.h>
 #include <rocksdb/transaction_log.h>
 #include <butil/file_util.h>
 #include <mutex>
@@ -42,6 +47,16 @@ public:
     }
 };
 
+// RocksDB tuning of a store: the defaults leave the options that the store has always used
+struct store_tuning_t {
+    size_t block_cache_mb = 0;          // 0 uses the default block cache of RocksDB
+    size_t bloom_filter_bits = 0;       // bits per key, 0 disables bloom filters
+    bool partitioned_filters = false;   // two level index and filter blocks, held in the block cache
+    std::string compression;            // snappy, lz4, zstd or none, empty for RocksDB's compression of each level
+    size_t compression_dict_kb = 0;     // dictionary of zstd compression, trained on the values of each file
+    size_t write_buffer_mb = 4;
+};
+
 enum StoreStatus {
     FOUND,
     NOT_FOUND,
@@ -59,12 +74,41 @@ private:
     rocksdb::Options options;
     rocksdb::WriteOptions write_options;
 
+    // options before the configured compression was applied, which are restored when the DB cannot be opened with it
+    rocksdb::Options untuned_compression_options;
+    bool compression_tuned = false;
+
     // Used to protect assignment to DB handle, which is otherwise thread safe
     // So we use unique lock only for assignment, but shared locks for all other operations on DB
     mutable std::shared_mutex mutex;
 
+    // column families of collections, keyed on collection id
+    std::unordered_map<uint32_t, rocksdb::ColumnFamilyHandle*> collection_families;
+
+    // includes the handles of dropped families, which stay usable by iterators until the DB is closed
+    std::vector<rocksdb::ColumnFamilyHandle*> family_handles;
+
+    static constexpr const char* COLLECTION_FAMILY_PREFIX = "collection_";
+
+    // marks a collection whose keys are being moved into its own column family
+    static constexpr const char* FAMILY_MIGRATION_PREFIX = "$CFM_";
+
+    static constexpr size_t FAMILY_MIGRATION_BATCH_SIZE = 1000;
+
     rocksdb::Status init_db(int32_t ttl);
 
+    void apply_tuning(const store_tuning_t& tuning);
+
+    void restore_untuned_compression();
+
+    // requires the unique lock
+    void close_db();
+
+    static std::string get_family_name(uint32_t collection_id);
+
+    // family of the collection whose id the key begins with, or the default family, requires the lock
+    rocksdb::ColumnFamilyHandle* get_family(const rocksdb::Slice& key) const;
+
 public:
 
     Store() = delete;
@@ -73,7 +117,8 @@ public:
           const size_t wal_ttl_secs = 24*60*60,
           const size_t wal_size_mb = 1024,
           bool disable_wal = true,
-          int32_t ttl=0);
+          int32_t ttl=0,
+          const store_tuning_t& tuning = store_tuning_t());
 
     ~Store();
 
@@ -81,6 +126,9 @@ public:
 
     bool batch_write(rocksdb::WriteBatch& batch);
 
+    // adds the key to the batch in the column family that the key belongs to
+    void batch_put(rocksdb::WriteBatch& batch, const std::string& key, const std::string& value) const;
+
     bool contains(const std::string& key) const;
 
     StoreStatus get(const std::string& key, std::string& value) const;
@@ -113,6 +161,19 @@ public:
 
     rocksdb::Status compact_range(const rocksdb::Slice& begin_key, const rocksdb::Slice& end_key);
 
+    // The keys of a collection, i.e. the ones that begin with its id, are kept in a column family of their own when
+    // the collection has one, so that they can be dropped at once.
+
+    bool has_collection_family(uint32_t collection_id) const;
+
+    bool create_collection_family(uint32_t collection_id);
+
+    // returns false when the collection has no family of its own
+    bool drop_collection_family(uint32_t collection_id);
+
+    // moves the keys of the collection from the default family into a new family of the collection
+    bool migrate_to_collection_family(uint32_t collection_id);
+
     // Only for internal tests
     rocksdb::DB* _get_db_unsafe() const;
 
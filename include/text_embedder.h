@@ -4,6 +4,9 @@
 #include <core/session/onnxruntime_cxx_api.h>
 #include <tokenizer/bert_tokenizer.hpp>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include "option.h"
 #include "text_embedder_tokenizer.h"
 #include "text_embedder_remote.h"
@@ -37,7 +40,25 @@ class TextEmbedder {
         const TokenizerType get_tokenizer_type() {
             return tokenizer_->get_tokenizer_type();
         }
+
+        // concurrent `Embed()` calls on a local model are batched together, up to this many inputs per model run
+        static constexpr size_t QUERY_BATCH_MAX_SIZE = 16;
+
+        // how long the first of the concurrent `Embed()` calls waits for others to join its batch: a call that finds
+        // no other call waiting runs right away
+        static constexpr size_t QUERY_BATCH_WINDOW_US = 2000;
     private:
+        struct pending_embedding_t {
+            const std::string& text;
+            embedding_res_t result;
+            bool done = false;
+
+            explicit pending_embedding_t(const std::string& text): text(text) {}
+        };
+
+        // runs a single batch through the model, `mutex_` must be held
+        std::vector<embedding_res_t> run_batch(const std::vector<std::string>& input_batch);
+
         std::shared_ptr<Ort::Session> session_;
         std::shared_ptr<Ort::Env> env_;
         encoded_input_t Encode(const std::string& text);
@@ -49,4 +70,9 @@ class TextEmbedder {
         std::string output_tensor_name;
         size_t num_dim;
         std::mutex mutex_;
+
+        std::mutex pending_mutex_;
+        std::condition_variable pending_cv_;
+        std::deque<pending_embedding_t*> pending_embeddings_;
+        bool batch_leader_active_ = false;
 };
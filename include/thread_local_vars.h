@@ -1,9 +1,30 @@
+#pragma once
+
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 
 extern thread_local int64_t write_log_index;
 
+// log index of the last write of the group of coalesced writes being indexed (0 when a single write is being indexed)
+extern thread_local int64_t write_log_last_index;
+
 // These are used for circuit breaking search requests
 // NOTE: if you fork off main search thread, care must be taken to initialize these from parent thread values
 extern thread_local uint64_t search_begin_us;
 extern thread_local uint64_t search_stop_us;
-extern thread_local bool search_cutoff;
\ No newline at end of file
+extern thread_local bool search_cutoff;
+
+// Liveness flag of the client connection that issued the search (nullptr when the search is not tied to a client).
+// Once the client goes away, the search is abandoned at the next circuit breaker check.
+extern thread_local const std::atomic<bool>* search_client_alive;
+
+inline bool is_search_cancelled() {
+    return search_client_alive != nullptr && !search_client_alive->load(std::memory_order_relaxed);
+}
+
+inline bool should_stop_search() {
+    return is_search_cancelled() ||
+           (std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us;
+}
@@ -5,15 +5,30 @@
 #include <functional>
 #include <future>
 #include <queue>
+#include <atomic>
+#include <string>
 #include "logger.h"
 
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t);
+    explicit ThreadPool(size_t, const std::string& name = "", int nice_value = 0);
     template<class F, class... Args>
     decltype(auto) enqueue(F&& f, Args&&... args);
     void log_exhaustion();
     void shutdown();
+
+    const std::string& get_name() const;
+    size_t get_num_threads() const;
+    size_t get_num_queued();
+    size_t get_num_active() const;
+    uint64_t get_num_completed() const;
+
 private:
     // need to keep track of threads so we can join them
     std::vector< std::thread > workers;
@@ -25,16 +40,28 @@ private:
     std::condition_variable condition;
     std::condition_variable condition_producers;
     bool stop;
+
+    // used for logging and metrics
+    const std::string name;
+
+    std::atomic<size_t> num_active = 0;
+    std::atomic<uint64_t> num_completed = 0;
+
+    static void set_thread_nice(int nice_value);
 };
 
 // the constructor just launches some amount of workers
-inline ThreadPool::ThreadPool(size_t threads)
-        :   stop(false)
+inline ThreadPool::ThreadPool(size_t threads, const std::string& name, int nice_value)
+        :   stop(false), name(name)
 {
     for(size_t i = 0;i<threads;++i)
         workers.emplace_back(
-                [this]
+                [this, nice_value]
                 {
+                    if(nice_value != 0) {
+                        set_thread_nice(nice_value);
+                    }
+
                     for(;;)
                     {
                         std::packaged_task<void()> task;
@@ -56,7 +83,10 @@ inline ThreadPool::ThreadPool(size_t threads)
                             }
                         }
 
+                        num_active++;
                         task();
+                        num_active--;
+                        num_completed++;
                     }
                 }
         );
@@ -101,6 +131,39 @@ inline void ThreadPool::log_exhaustion() {
     std::unique_lock<std::mutex> lock(queue_mutex);
     if(tasks.size() >= workers.size()) {
         LOG(WARNING) << "Threadpool exhaustion detected, task_queue_len: "
-                     << tasks.size() << ", thread_pool_len: " << workers.size();
+                     << tasks.size() << ", thread_pool_len: " << workers.size()
+                     << (name.empty() ? "" : ", thread_pool: " + name);
+    }
+}
+
+inline const std::string& ThreadPool::get_name() const {
+    return name;
+}
+
+inline size_t ThreadPool::get_num_threads() const {
+    return workers.size();
+}
+
+inline size_t ThreadPool::get_num_queued() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    return tasks.size();
+}
+
+inline size_t ThreadPool::get_num_active() const {
+    return num_active;
+}
+
+inline uint64_t ThreadPool::get_num_completed() const {
+    return num_completed;
+}
+
+inline void ThreadPool::set_thread_nice(int nice_value) {
+    // On Linux, nice values are per-thread, so a pool of lower priority workers will be pre-empted by
+    // the workers of a normal priority pool when the CPU is saturated.
+#ifdef __linux__
+    pid_t tid = syscall(SYS_gettid);
+    if(setpriority(PRIO_PROCESS, tid, nice_value) != 0) {
+        LOG(WARNING) << "Unable to set nice value " << nice_value << " for thread " << tid;
     }
+#endif
 }
@@ -56,6 +56,10 @@ private:
 
     uint32_t thread_pool_size;
 
+    uint32_t index_thread_pool_size;
+
+    uint32_t background_thread_pool_size;
+
     bool enable_access_logging;
 
     int disk_used_max_percentage;
@@ -63,6 +67,26 @@ private:
 
     std::atomic<uint32_t> cache_num_entries = 1000;
 
+    uint32_t embedding_cache_num_entries;
+
+    bool async_embedding;
+
+    uint32_t async_embedding_concurrency;
+
+    uint32_t async_embedding_num_tries;
+
+    uint32_t async_embedding_batch_size;
+
+    uint32_t async_embedding_timeout_ms;
+
+    uint32_t max_coalesced_writes;
+
+    uint32_t write_coalescing_window_ms;
+
+    uint32_t write_chunks_per_turn;
+
+    uint32_t index_concurrency;
+
     std::atomic<bool> skip_writes;
 
     std::atomic<int> log_slow_searches_time_ms;
@@ -77,8 +101,20 @@ private:
 
     uint32_t db_compaction_interval;
 
+    // RocksDB tuning of the store of the documents
+    uint32_t db_block_cache_mb;
+    uint32_t db_bloom_filter_bits;
+    bool db_partitioned_filters;
+    std::string db_compression;
+    uint32_t db_compression_dict_kb;
+    uint32_t db_write_buffer_mb;
+
     bool enable_lazy_filter;
 
+    std::atomic<bool> enable_lazy_deletes;
+
+    std::atomic<bool> enable_collection_column_families;
+
     bool enable_search_logging;
 
     uint32_t max_per_page;
@@ -101,7 +137,19 @@ protected:
         this->num_collections_parallel_load = 0;  // will be set dynamically if not overridden
         this->num_documents_parallel_load = 1000;
         this->cache_num_entries = 1000;
+        this->embedding_cache_num_entries = 1000;
+        this->async_embedding = false;
+        this->async_embedding_concurrency = 4;
+        this->async_embedding_num_tries = 3;
+        this->async_embedding_batch_size = 200;
+        this->async_embedding_timeout_ms = 60000;
+        this->max_coalesced_writes = 100;
+        this->write_coalescing_window_ms = 0;
+        this->write_chunks_per_turn = 10;
+        this->index_concurrency = 0; // defaults to the size of the index thread pool
         this->thread_pool_size = 0; // will be set dynamically if not overridden
+        this->index_thread_pool_size = 0; // will be set dynamically if not overridden
+        this->background_thread_pool_size = 4;
         this->ssl_refresh_interval_seconds = 8 * 60 * 60;
         this->enable_access_logging = false;
         this->disk_used_max_percentage = 100;
@@ -114,8 +162,16 @@ protected:
         this->analytics_flush_interval = 3600;  // in seconds
         this->housekeeping_interval = 1800;     // in seconds
         this->db_compaction_interval = 0;     // in seconds, disabled
+        this->db_block_cache_mb = 0;          // RocksDB's default cache
+        this->db_bloom_filter_bits = 0;       // no bloom filters
+        this->db_partitioned_filters = false;
+        this->db_compression = "";            // RocksDB's compression of each level
+        this->db_compression_dict_kb = 0;
+        this->db_write_buffer_mb = 4;
 
         this->enable_lazy_filter = false;
+        this->enable_lazy_deletes = false;
+        this->enable_collection_column_families = false;
 
         this->enable_search_logging = false;
       
@@ -352,6 +408,50 @@ public:
         return this->cache_num_entries;
     }
 
+    size_t get_embedding_cache_num_entries() const {
+        return this->embedding_cache_num_entries;
+    }
+
+    bool get_async_embedding() const {
+        return this->async_embedding;
+    }
+
+    size_t get_async_embedding_concurrency() const {
+        return this->async_embedding_concurrency;
+    }
+
+    size_t get_async_embedding_num_tries() const {
+        return this->async_embedding_num_tries;
+    }
+
+    size_t get_async_embedding_batch_size() const {
+        return this->async_embedding_batch_size;
+    }
+
+    size_t get_async_embedding_timeout_ms() const {
+        return this->async_embedding_timeout_ms;
+    }
+
+    size_t get_max_coalesced_writes() const {
+        return this->max_coalesced_writes;
+    }
+
+    size_t get_write_coalescing_window_ms() const {
+        return this->write_coalescing_window_ms;
+    }
+
+    size_t get_write_chunks_per_turn() const {
+        return this->write_chunks_per_turn;
+    }
+
+    void set_write_chunks_per_turn(size_t write_chunks_per_turn) {
+        this->write_chunks_per_turn = write_chunks_per_turn;
+    }
+
+    size_t get_index_concurrency() const {
+        return this->index_concurrency;
+    }
+
     size_t get_analytics_flush_interval() const {
         return this->analytics_flush_interval;
     }
@@ -364,10 +464,42 @@ public:
         return this->db_compaction_interval;
     }
 
+    size_t get_db_block_cache_mb() const {
+        return this->db_block_cache_mb;
+    }
+
+    size_t get_db_bloom_filter_bits() const {
+        return this->db_bloom_filter_bits;
+    }
+
+    bool get_db_partitioned_filters() const {
+        return this->db_partitioned_filters;
+    }
+
+    std::string get_db_compression() const {
+        return this->db_compression;
+    }
+
+    size_t get_db_compression_dict_kb() const {
+        return this->db_compression_dict_kb;
+    }
+
+    size_t get_db_write_buffer_mb() const {
+        return this->db_write_buffer_mb;
+    }
+
     size_t get_thread_pool_size() const {
         return this->thread_pool_size;
     }
 
+    size_t get_index_thread_pool_size() const {
+        return this->index_thread_pool_size;
+    }
+
+    size_t get_background_thread_pool_size() const {
+        return this->background_thread_pool_size;
+    }
+
     size_t get_ssl_refresh_interval_seconds() const {
         return this->ssl_refresh_interval_seconds;
     }
@@ -404,6 +536,22 @@ public:
         return enable_lazy_filter;
     }
 
+    bool get_enable_lazy_deletes() const {
+        return enable_lazy_deletes;
+    }
+
+    void set_enable_lazy_deletes(bool enable_lazy_deletes) {
+        this->enable_lazy_deletes = enable_lazy_deletes;
+    }
+
+    bool get_enable_collection_column_families() const {
+        return enable_collection_column_families;
+    }
+
+    void set_enable_collection_column_families(bool enable_collection_column_families) {
+        this->enable_collection_column_families = enable_collection_column_families;
+    }
+
     const std::atomic<bool>& get_skip_writes() const {
         return skip_writes;
     }
@@ -462,6 +610,10 @@ public:
             return Option<bool>(500, "API key is not specified.");
         }
 
+        if(db_write_buffer_mb == 0) {
+            return Option<bool>(500, "DB write buffer size must be greater than zero.");
+        }
+
         return Option<bool>(true);
     }
 
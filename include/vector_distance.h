@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+// Distance kernels over float vectors. Kernels are compiled for several x86 instruction sets and the widest one that
+// the CPU supports is picked at runtime, so that a single binary is fast on every machine it runs on.
+namespace vector_distance {
+    enum class isa_t {
+        scalar,
+        sse,
+        avx2,
+        avx512
+    };
+
+    struct kernels_t {
+        isa_t isa;
+
+        float (*inner_product)(const float* a, const float* b, size_t dim);
+
+        float (*l2_squared)(const float* a, const float* b, size_t dim);
+
+        // writes `src` scaled to unit length into `dest`
+        void (*normalize)(const float* src, float* dest, size_t dim);
+
+        // `1 - inner_product`, in the form of an hnswlib distance function whose param points to the dimension
+        float (*inner_product_distance)(const void* a, const void* b, const void* param);
+
+        float (*l2_distance)(const void* a, const void* b, const void* param);
+    };
+
+    isa_t detect_isa();
+
+    // kernels of `isa`, or of the widest instruction set below it that is supported
+    const kernels_t& get_kernels(isa_t isa);
+
+    // kernels of the widest instruction set supported by the CPU
+    const kernels_t& kernels();
+
+    const char* isa_name(isa_t isa);
+}
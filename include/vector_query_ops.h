@@ -1,12 +1,24 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "option.h"
+#include "pooled_task.h"
 #include <limits>
 
 class Collection;
 
+// how the nearest neighbours of a vector query are found, depending on how many documents its filter matches
+enum class vector_search_strategy_t {
+    none,
+    hnsw,
+    brute_force,
+    filtered_hnsw,
+    post_filter,
+    ivf
+};
+
 struct vector_query_t {
     std::string field_name;
     size_t k = 0;
@@ -20,15 +32,31 @@ struct vector_query_t {
 
     uint32_t ef = 10;
 
+    // partitions of an IVF index to probe, 0 for the default of the field
+    uint32_t nprobe = 0;
+
     std::vector<std::string> queries;
     std::vector<float> query_weights;
 
+    // Set while the query text is embedded in the background, so that a hybrid search can run its keyword leg in the
+    // meantime. `values` then stay empty: use `get_values()`.
+    std::shared_ptr<pooled_task_t<Option<std::vector<float>>>> pending_values;
+
+    Option<std::vector<float>> get_values() const {
+        if(pending_values == nullptr) {
+            return Option<std::vector<float>>(values);
+        }
+
+        return pending_values->get();
+    }
+
     void _reset() {
         // used for testing only
         field_name.clear();
         k = 0;
         distance_threshold = 2.01;
         values.clear();
+        pending_values = nullptr;
         seq_id = 0;
         query_doc_given = false;
     }
@@ -1,5 +1,7 @@
 #include "app_metrics.h"
 #include "core_api.h"
+#include <cmath>
+#include <sstream>
 
 void AppMetrics::increment_write_metrics(uint64_t route_hash, uint64_t duration) {
     if(is_doc_import_route(route_hash)) {
@@ -38,7 +40,7 @@ void AppMetrics::get(const std::string& rps_key, const std::string& latency_key,
     auto OVERLOADED_RPS_KEY = OVERLOADED_LABEL + "_" + rps_key;
 
     result[rps_key] = nlohmann::json::object();
-    for(const auto& kv: *counts) {
+    for(const auto& kv: counts) {
         if(kv.first == SEARCH_LABEL) {
             result[SEARCH_RPS_KEY] = double(kv.second) / (METRICS_REFRESH_INTERVAL_MS / 1000);
         }
@@ -69,9 +71,9 @@ void AppMetrics::get(const std::string& rps_key, const std::string& latency_key,
 
     result[latency_key] = nlohmann::json::object();
 
-    for(const auto& kv: *durations) {
-        auto counter_it = counts->find(kv.first);
-        if(counter_it != counts->end() && counter_it->second != 0) {
+    for(const auto& kv: durations) {
+        auto counter_it = counts.find(kv.first);
+        if(counter_it != counts.end() && counter_it->second != 0) {
             if(kv.first == SEARCH_LABEL) {
                 result[SEARCH_LATENCY_KEY] = (double(kv.second) / counter_it->second);
             }
@@ -94,6 +96,20 @@ void AppMetrics::get(const std::string& rps_key, const std::string& latency_key,
         }
     }
 
+    const std::string& percentiles_key = latency_key + "_percentiles";
+    result[percentiles_key] = nlohmann::json::object();
+
+    for(const auto& kv: histograms) {
+        add_percentiles(kv.second, result[percentiles_key][kv.first]);
+    }
+
+    const std::string& collection_percentiles_key = "collection_" + SEARCH_LABEL + "_" + latency_key + "_percentiles";
+    result[collection_percentiles_key] = nlohmann::json::object();
+
+    for(const auto& kv: collection_histograms) {
+        add_percentiles(kv.second, result[collection_percentiles_key][kv.first]);
+    }
+
     std::vector<std::string> keys_to_check = {
         SEARCH_RPS_KEY, IMPORT_RPS_KEY, DOC_WRITE_RPS_KEY, DOC_DELETE_RPS_KEY,
         SEARCH_LATENCY_KEY, IMPORT_LATENCY_KEY, DOC_WRITE_LATENCY_KEY, DOC_DELETE_LATENCY_KEY,
@@ -108,15 +124,127 @@ void AppMetrics::get(const std::string& rps_key, const std::string& latency_key,
 }
 
 void AppMetrics::window_reset() {
+    spp::sparse_hash_map<std::string, uint64_t> window_counts;
+    spp::sparse_hash_map<std::string, uint64_t> window_durations;
+    std::unordered_map<std::string, latency_histogram_t> window_histograms;
+    std::unordered_map<std::string, latency_histogram_t> window_collection_histograms;
+
+    for(auto& shard: shards) {
+        std::lock_guard shard_lock(shard.mutex);
+
+        for(const auto& kv: shard.counts) {
+            window_counts[kv.first] += kv.second;
+        }
+
+        for(const auto& kv: shard.durations) {
+            window_durations[kv.first] += kv.second;
+        }
+
+        for(const auto& kv: shard.histograms) {
+            window_histograms[kv.first].merge(kv.second);
+        }
+
+        for(const auto& kv: shard.collection_histograms) {
+            window_collection_histograms[kv.first].merge(kv.second);
+        }
+
+        shard.counts.clear();
+        shard.durations.clear();
+        shard.histograms.clear();
+        shard.collection_histograms.clear();
+    }
+
     std::unique_lock lock(mutex);
+    counts = std::move(window_counts);
+    durations = std::move(window_durations);
+    histograms = std::move(window_histograms);
+    collection_histograms = std::move(window_collection_histograms);
+}
+
+void AppMetrics::add_percentiles(const latency_histogram_t& histogram, nlohmann::json& result) {
+    for(const double percentile: PERCENTILES) {
+        result["p" + std::to_string(int(percentile))] = histogram.value_at_percentile(percentile);
+    }
+}
+
+uint64_t latency_histogram_t::value_at_percentile(double percentile) const {
+    if(count == 0) {
+        return 0;
+    }
 
-    delete counts;
-    counts = current_counts;
-    current_counts = new spp::sparse_hash_map<std::string, uint64_t>();
+    const uint64_t target = std::max<uint64_t>(1, std::ceil((percentile / 100) * count));
+    uint64_t cumulative = 0;
+
+    for(size_t i = 0; i < NUM_BUCKETS; i++) {
+        cumulative += buckets[i];
+        if(cumulative >= target) {
+            return bucket_upper_bound(i);
+        }
+    }
+
+    return bucket_upper_bound(NUM_BUCKETS - 1);
+}
+
+static std::string escape_prometheus_label(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+
+    for(const char c: value) {
+        if(c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if(c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+void AppMetrics::get_prometheus(std::string& result) const {
+    std::shared_lock lock(mutex);
+    std::ostringstream out;
+
+    const double window_seconds = double(METRICS_REFRESH_INTERVAL_MS) / 1000;
+
+    out << "# HELP typesense_requests_per_second Requests per second over the last metrics window.\n";
+    out << "# TYPE typesense_requests_per_second gauge\n";
+    for(const auto& kv: counts) {
+        out << "typesense_requests_per_second{route=\"" << escape_prometheus_label(kv.first) << "\"} "
+            << (double(kv.second) / window_seconds) << "\n";
+    }
+
+    out << "# HELP typesense_request_latency_ms Request latency over the last metrics window.\n";
+    out << "# TYPE typesense_request_latency_ms summary\n";
+    for(const auto& kv: histograms) {
+        const std::string& route = escape_prometheus_label(kv.first);
+        for(const double percentile: PERCENTILES) {
+            out << "typesense_request_latency_ms{route=\"" << route << "\",quantile=\"" << (percentile / 100)
+                << "\"} " << kv.second.value_at_percentile(percentile) << "\n";
+        }
+
+        auto duration_it = durations.find(kv.first);
+        out << "typesense_request_latency_ms_sum{route=\"" << route << "\"} "
+            << (duration_it == durations.end() ? 0 : duration_it->second) << "\n";
+        out << "typesense_request_latency_ms_count{route=\"" << route << "\"} " << kv.second.count << "\n";
+    }
+
+    out << "# HELP typesense_collection_search_latency_ms Search latency per collection over the last metrics window.\n";
+    out << "# TYPE typesense_collection_search_latency_ms summary\n";
+    for(const auto& kv: collection_histograms) {
+        const std::string& collection = escape_prometheus_label(kv.first);
+        for(const double percentile: PERCENTILES) {
+            out << "typesense_collection_search_latency_ms{collection=\"" << collection << "\",quantile=\""
+                << (percentile / 100) << "\"} " << kv.second.value_at_percentile(percentile) << "\n";
+        }
+
+        out << "typesense_collection_search_latency_ms_count{collection=\"" << collection << "\"} "
+            << kv.second.count << "\n";
+    }
 
-    delete durations;
-    durations = current_durations;
-    current_durations = new spp::sparse_hash_map<std::string, uint64_t>();
+    result = out.str();
 }
 
 void AppMetrics::write_access_log(const uint64_t epoch_millis, const char* remote_ip, const std::string& path) {
@@ -432,6 +432,50 @@ static void add_document_to_leaf(art_document *document, art_leaf *leaf) {
     }
 }
 
+// Adds the documents from `begin` onwards. Their IDs are sorted and upserted in bulk, so that the ones beyond the last
+// ID of the posting list are appended a block at a time.
+static void add_documents_to_leaf(std::vector<art_document>& documents, size_t begin, art_leaf *leaf) {
+    std::vector<art_document*> sorted_documents;
+    bool bulk_upsert = (documents.size() - begin > 1);
+
+    for(size_t i = begin; i < documents.size() && bulk_upsert; i++) {
+        // max score of a leaf that uses frequency depends on the order in which documents are added
+        bulk_upsert = (documents[i].score != USE_FREQUENCY_SCORE);
+        sorted_documents.push_back(&documents[i]);
+    }
+
+    if(bulk_upsert) {
+        std::sort(sorted_documents.begin(), sorted_documents.end(), [](const art_document* a, const art_document* b) {
+            return a->id < b->id;
+        });
+
+        bulk_upsert = std::adjacent_find(sorted_documents.begin(), sorted_documents.end(),
+                                         [](const art_document* a, const art_document* b) {
+            return a->id == b->id;
+        }) == sorted_documents.end();
+    }
+
+    if(!bulk_upsert) {
+        for(size_t i = begin; i < documents.size(); i++) {
+            add_document_to_leaf(&documents[i], leaf);
+        }
+        return;
+    }
+
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> offset_index;
+    std::vector<uint32_t> offsets;
+
+    for(const art_document* document: sorted_documents) {
+        leaf->max_score = MAX(leaf->max_score, document->score);
+        ids.push_back(document->id);
+        offset_index.push_back(offsets.size());
+        offsets.insert(offsets.end(), document->offsets.begin(), document->offsets.end());
+    }
+
+    posting_t::upsert_many(leaf->values, ids.size(), ids.data(), offset_index.data(), offsets.size(), offsets.data());
+}
+
 static art_leaf* make_leaf(const unsigned char *key, uint32_t key_len, art_document *document) {
     art_leaf *l = (art_leaf *) malloc(sizeof(art_leaf) + key_len);
     l->key_len = key_len;
@@ -622,9 +666,7 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
     // If we are at a NULL node, inject a leaf
     if (!n) {
         art_leaf* new_leaf = make_leaf(key, key_len, &documents[0]);
-        for(size_t i = 1; i < documents.size(); i++) {
-            add_document_to_leaf(&documents[i], new_leaf);
-        }
+        add_documents_to_leaf(documents, 1, new_leaf);
 
         *ref = (art_node*)SET_LEAF(new_leaf);
         return NULL;
@@ -637,9 +679,7 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
         // Check if we are updating an existing value
         if (!leaf_matches(l, key, key_len, depth)) {
             *old = 1;
-            for(size_t i = 0; i < documents.size(); i++) {
-                add_document_to_leaf(&documents[i], l);
-            }
+            add_documents_to_leaf(documents, 0, l);
             return l->values;
         }
 
@@ -653,9 +693,7 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
         new_n->n.partial_len = longest_prefix;
         memcpy(new_n->n.partial, key+depth, min(MAX_PREFIX_LEN, longest_prefix));
 
-        for(size_t i = 1; i < documents.size(); i++) {
-            add_document_to_leaf(&documents[i], l2);
-        }
+        add_documents_to_leaf(documents, 1, l2);
 
         // Add the leafs to the new node4
         *ref = (art_node*)new_n;
@@ -699,9 +737,7 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
 
         // Insert the new leaf
         art_leaf *l = make_leaf(key, key_len, &documents[0]);
-        for(size_t i = 1; i < documents.size(); i++) {
-            add_document_to_leaf(&documents[i], l);
-        }
+        add_documents_to_leaf(documents, 1, l);
 
         add_child4(new_n, ref, key[depth+prefix_diff], SET_LEAF(l));
         path.push_back(*ref);
@@ -718,9 +754,7 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
 
     // No child, node goes within us
     art_leaf *l = make_leaf(key, key_len, &documents[0]);
-    for(size_t i = 1; i < documents.size(); i++) {
-        add_document_to_leaf(&documents[i], l);
-    }
+    add_documents_to_leaf(documents, 1, l);
 
     add_child(n, ref, key[depth], SET_LEAF(l));
     path.push_back(*ref);
@@ -1083,8 +1117,7 @@ int art_topk_iter(const art_node *root, token_ordering token_order, size_t max_r
             validate_and_add_leaf(l, last_token, prev_token, allowed_doc_ids, allowed_doc_ids_len,
                                   exclude_leaves, exact_leaf, results);
 
-            if (++num_processed % 1024 == 0 && (microseconds(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+            if (++num_processed % 1024 == 0 && should_stop_search()) {
                 search_cutoff = true;
                 break;
             }
@@ -1179,8 +1212,7 @@ int art_topk_iter(const art_node *root, token_ordering token_order, size_t max_r
             filter_result_iterator->reset();
 
             if (filter_result_iterator->validity == filter_result_iterator_t::timed_out ||
-                (++num_processed % 1024 == 0 && (microseconds(
-                    std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us)) {
+                (++num_processed % 1024 == 0 && should_stop_search())) {
                 search_cutoff = true;
                 break;
             }
@@ -1784,6 +1816,11 @@ int art_fuzzy_search(art_tree *t, const unsigned char *term, const int term_len,
                                                           allowed_doc_ids_len);
 
     for(auto node: nodes) {
+        if(is_search_cancelled()) {
+            search_cutoff = true;
+            break;
+        }
+
         art_topk_iter(node, token_order, max_words, exact_leaf,
                       last_token, prev_token, allowed_doc_ids, allowed_doc_ids_len,
                       t, exclude_leaves, results);
@@ -1859,6 +1896,11 @@ int art_fuzzy_search_i(art_tree *t, const unsigned char *term, const int term_le
     //LOG(INFO) << "exact_leaf: " << exact_leaf << ", term: " << term << ", term_len: " << term_len;
 
     for(auto node: nodes) {
+        if(is_search_cancelled()) {
+            search_cutoff = true;
+            break;
+        }
+
         art_topk_iter(node, token_order, max_words,
                       exact_leaf, last_token, prev_token,
                       filter_result_iterator,
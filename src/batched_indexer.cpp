@@ -123,10 +123,7 @@ void BatchedIndexer::enqueue(const std::shared_ptr<http_req>& req, const std::sh
             req->body = "";
 
             if(queue_write) {
-                std::unique_lock qlk(qmutuxes[queue_id].mcv);
-                queues[queue_id].emplace_back(req->start_ts);
-                qlk.unlock();
-                qmutuxes[queue_id].cv.notify_one();
+                queue_write(queue_id, coll_name, req->start_ts, chunk_sequence == 0);
             }
         }
 
@@ -158,6 +155,64 @@ void BatchedIndexer::enqueue(const std::shared_ptr<http_req>& req, const std::sh
     }
 }
 
+void BatchedIndexer::queue_write(uint64_t queue_id, const std::string& coll_name, uint64_t req_id, bool is_small) {
+    std::unique_lock qlk(qmutuxes[queue_id].mcv);
+    push_write(queues[queue_id], coll_name, queued_req_t(req_id, now_ms(), is_small));
+    qlk.unlock();
+    qmutuxes[queue_id].cv.notify_one();
+}
+
+void BatchedIndexer::push_write(indexer_queue_t& queue, const std::string& coll_name, const queued_req_t& queued_req) {
+    coll_queue_t& coll_queue = queue.coll_queues[coll_name];
+    coll_queue.reqs.push_back(queued_req);
+
+    if(!coll_queue.is_active) {
+        coll_queue.is_active = true;
+        queue.turns.push_back(coll_name);
+    }
+}
+
+std::string BatchedIndexer::next_turn(indexer_queue_t& queue) {
+    auto turn_it = queue.turns.begin();
+
+    // A collection whose next write is small is served out of turn, but at most on every other turn, so that a small
+    // write waits for one turn of a large write at the most, while the large write still progresses.
+    if(!queue.last_turn_prioritized) {
+        auto small_turn_it = std::find_if(queue.turns.begin(), queue.turns.end(), [&](const std::string& coll_name) {
+            return queue.coll_queues[coll_name].reqs.front().is_small;
+        });
+
+        if(small_turn_it != queue.turns.end()) {
+            turn_it = small_turn_it;
+        }
+    }
+
+    queue.last_turn_prioritized = (turn_it != queue.turns.begin());
+    std::string coll_name = *turn_it;
+    queue.turns.erase(turn_it);
+
+    return coll_name;
+}
+
+void BatchedIndexer::end_turn(indexer_queue_t& queue, const std::string& coll_name, const queued_req_t& queued_req,
+                              bool is_yielded) {
+    coll_queue_t& coll_queue = queue.coll_queues[coll_name];
+    if(is_yielded) {
+        coll_queue.reqs.push_front(queued_req);
+    }
+
+    if(coll_queue.reqs.empty()) {
+        queue.coll_queues.erase(coll_name);
+    } else {
+        queue.turns.push_back(coll_name);
+    }
+}
+
+uint64_t BatchedIndexer::now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 std::string BatchedIndexer::get_collection_name(const std::shared_ptr<http_req>& req) {
     std::string& coll_name = req->params["collection"];
 
@@ -194,27 +249,55 @@ void BatchedIndexer::run() {
 
     LOG(INFO) << "BatchedIndexer skip_index: " << skip_index;
 
+    std::string uncoalesced_until_index_value;
+    if(meta_store->get(UNCOALESCED_UNTIL_INDEX_KEY, uncoalesced_until_index_value) == StoreStatus::FOUND &&
+       StringUtils::is_int64_t(uncoalesced_until_index_value)) {
+        uncoalesced_until_index = std::stoll(uncoalesced_until_index_value);
+        LOG(INFO) << "BatchedIndexer will not coalesce writes until log index: " << uncoalesced_until_index;
+    }
+
     for(size_t i = 0; i < num_threads; i++) {
-        std::deque<uint64_t>& queue = queues[i];
+        indexer_queue_t& queue = queues[i];
         await_t& queue_mutex = qmutuxes[i];
 
         thread_pool->enqueue([&queue, &queue_mutex, this, i]() {
             while(!quit) {
                 std::unique_lock<std::mutex> qlk(queue_mutex.mcv);
-                queue_mutex.cv.wait(qlk, [&] { return quit || !queue.empty(); });
+                queue_mutex.cv.wait(qlk, [&] { return quit || !queue.turns.empty(); });
 
                 if(quit) {
                     break;
                 }
 
-                uint64_t req_id = queue.front();
-                queue.pop_front();
+                // NOTE: only this thread erases a collection's queue, so the reference stays valid while it is served
+                const std::string coll_name = next_turn(queue);
+                coll_queue_t& coll_queue = queue.coll_queues[coll_name];
+                queued_req_t queued_req = coll_queue.reqs.front();
+                coll_queue.reqs.pop_front();
                 qlk.unlock();
 
+                const uint64_t req_id = queued_req.req_id;
+                bool is_yielded = false;
+
+                auto end_turn = [&]() {
+                    std::unique_lock turn_lk(queue_mutex.mcv);
+                    BatchedIndexer::end_turn(queue, coll_name, queued_req, is_yielded);
+                };
+
+                std::vector<uint64_t> coalesced_req_ids = pop_coalesced_writes(req_id, coll_queue.reqs, queue_mutex);
+                if(!coalesced_req_ids.empty()) {
+                    coalesced_req_ids.insert(coalesced_req_ids.begin(), req_id);
+                    index_coalesced_writes(coalesced_req_ids);
+                    end_turn();
+                    continue;
+                }
+
                 std::unique_lock mlk(mutex);
                 auto req_res_map_it = req_res_map.find(req_id);
                 if(req_res_map_it == req_res_map.end()) {
                     LOG(ERROR) << "Req ID " << req_id << " not found in req_res_map.";
+                    mlk.unlock();
+                    end_turn();
                     continue;
                 }
 
@@ -245,13 +328,23 @@ void BatchedIndexer::run() {
                 bool route_found = server->get_route(orig_req->route_hash, &found_rpath);
                 bool async_res = false;
 
+                // a large request yields to the writes of other collections after its share of chunks
+                const size_t chunks_per_turn = config.get_write_chunks_per_turn();
+                size_t num_chunks_indexed = 0;
+
                 while(iter->Valid() && iter->key().starts_with(req_key_prefix)) {
+                    if(chunks_per_turn != 0 && num_chunks_indexed == chunks_per_turn) {
+                        is_yielded = true;
+                        break;
+                    }
+
                     std::shared_lock slk(pause_mutex); // used for snapshot
                     orig_req->body = prev_body;
                     orig_req->load_from_json(iter->value().ToString());
 
-                    // update thread local for reference during a crash
+                    // update thread locals for reference during a crash
                     write_log_index = orig_req->log_index;
+                    write_log_last_index = 0;
 
                     if(write_log_index == skip_index) {
                         LOG(ERROR) << "Skipping write log index " << write_log_index
@@ -324,6 +417,7 @@ void BatchedIndexer::run() {
 
                     queued_writes--;
                     orig_req_res.next_chunk_index++;
+                    num_chunks_indexed++;
                     iter->Next();
 
                     if(quit) {
@@ -333,6 +427,11 @@ void BatchedIndexer::run() {
 
                 delete iter;
 
+                if(is_yielded) {
+                    end_turn();
+                    continue;
+                }
+
                 //LOG(INFO) << "Erasing request data from disk and memory for request " << req_id;
 
                 // we can delete the buffered request content
@@ -343,6 +442,8 @@ void BatchedIndexer::run() {
                 req_res_map.erase(req_id);
                 lk.unlock();
                 refq_wait.cv.notify_one();
+
+                end_turn();
             }
         });
     }
@@ -381,10 +482,8 @@ void BatchedIndexer::run() {
                 if(ref_collections.empty()) {
                     // This request is not dependent on any other request. Push this request onto main processing queue
                     // and remove node from queue.
-                    std::unique_lock qlk(qmutuxes[reference_q_it->queue_id].mcv);
-                    queues[reference_q_it->queue_id].emplace_back(reference_q_it->start_ts);
-                    qlk.unlock();
-                    qmutuxes[reference_q_it->queue_id].cv.notify_one();
+                    queue_write(reference_q_it->queue_id, coll_name, reference_q_it->start_ts,
+                                req_res_it->second.num_chunks == 1);
                     reference_q_it = reference_q.erase(reference_q_it);
                     continue;
                 }
@@ -400,10 +499,8 @@ void BatchedIndexer::run() {
                 if(!found_ref_coll) {
                     // All the dependent requests have been completed. Push this request onto main processing queue and
                     // remove node from queue.
-                    std::unique_lock qlk(qmutuxes[reference_q_it->queue_id].mcv);
-                    queues[reference_q_it->queue_id].emplace_back(reference_q_it->start_ts);
-                    qlk.unlock();
-                    qmutuxes[reference_q_it->queue_id].cv.notify_one();
+                    queue_write(reference_q_it->queue_id, coll_name, reference_q_it->start_ts,
+                                req_res_it->second.num_chunks == 1);
                     reference_q_it = reference_q.erase(reference_q_it);
                 } else {
                     reference_q_it++;
@@ -493,6 +590,201 @@ void BatchedIndexer::run() {
     delete thread_pool;
 }
 
+std::shared_ptr<http_req> BatchedIndexer::get_coalescable_write(uint64_t req_id) {
+    std::unique_lock lk(mutex);
+    auto req_res_map_it = req_res_map.find(req_id);
+
+    // old serialized requests (start_ts of 0) are written serially
+    if(req_id == 0 || req_res_map_it == req_res_map.end()) {
+        return nullptr;
+    }
+
+    const req_res_t& req_res = req_res_map_it->second;
+    if(!req_res.is_complete || req_res.num_chunks != 1 || req_res.next_chunk_index != 0) {
+        return nullptr;
+    }
+
+    route_path* rpath = nullptr;
+    if(!server->get_route(req_res.req->route_hash, &rpath) || rpath->handler != post_add_document) {
+        return nullptr;
+    }
+
+    // invalid actions are rejected by the handler of the request
+    auto action_it = req_res.req->params.find("action");
+    if(action_it != req_res.req->params.end() && action_it->second != "create" && action_it->second != "update" &&
+       action_it->second != "upsert" && action_it->second != "emplace") {
+        return nullptr;
+    }
+
+    return req_res.req;
+}
+
+bool BatchedIndexer::can_coalesce(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_req>& other_req) {
+    auto get_param = [](const std::shared_ptr<http_req>& r, const std::string& name, const std::string& default_value) {
+        auto it = r->params.find(name);
+        return (it == r->params.end()) ? default_value : it->second;
+    };
+
+    for(const auto& param: {"collection", "dirty_values", "remote_embedding_timeout_ms", "remote_embedding_num_tries"}) {
+        if(get_param(req, param, "") != get_param(other_req, param, "")) {
+            return false;
+        }
+    }
+
+    return get_param(req, "action", "create") == get_param(other_req, "action", "create");
+}
+
+std::vector<uint64_t> BatchedIndexer::pop_coalesced_writes(uint64_t req_id, std::deque<queued_req_t>& queue,
+                                                           await_t& queue_mutex) {
+    std::vector<uint64_t> coalesced_req_ids;
+    const size_t max_coalesced_writes = config.get_max_coalesced_writes();
+
+    // a write that previously crashed the indexer must be isolated to be skipped
+    if(max_coalesced_writes <= 1 || skip_index != UNSET_SKIP_INDEX) {
+        return coalesced_req_ids;
+    }
+
+    const auto& req = get_coalescable_write(req_id);
+    if(req == nullptr) {
+        return coalesced_req_ids;
+    }
+
+    if(uncoalesced_until_index != UNSET_SKIP_INDEX) {
+        if(req->log_index <= uncoalesced_until_index) {
+            return coalesced_req_ids;
+        }
+
+        // writes are indexed in the order of their log indices, so the group that crashed is behind us
+        if(uncoalesced_until_index.exchange(UNSET_SKIP_INDEX) != UNSET_SKIP_INDEX) {
+            meta_store->remove(UNCOALESCED_UNTIL_INDEX_KEY);
+        }
+    }
+
+    // NOTE: only this thread pops from the queue, so the requests at its front stay there while its lock is released
+    std::vector<uint64_t> next_req_ids;
+
+    {
+        std::unique_lock qlk(queue_mutex.mcv);
+        const size_t window_ms = config.get_write_coalescing_window_ms();
+        if(window_ms != 0) {
+            queue_mutex.cv.wait_for(qlk, std::chrono::milliseconds(window_ms), [&]() {
+                return quit || queue.size() + 1 >= max_coalesced_writes;
+            });
+        }
+
+        for(size_t i = 0; i < queue.size() && i + 1 < max_coalesced_writes; i++) {
+            next_req_ids.push_back(queue[i].req_id);
+        }
+    }
+
+    // the lock of the queue must not be held while locking `mutex`
+    for(auto next_req_id: next_req_ids) {
+        const auto& next_req = get_coalescable_write(next_req_id);
+        if(next_req == nullptr || !can_coalesce(req, next_req)) {
+            break;
+        }
+
+        coalesced_req_ids.push_back(next_req_id);
+    }
+
+    if(!coalesced_req_ids.empty()) {
+        std::unique_lock qlk(queue_mutex.mcv);
+        queue.erase(queue.begin(), queue.begin() + coalesced_req_ids.size());
+    }
+
+    return coalesced_req_ids;
+}
+
+void BatchedIndexer::index_coalesced_writes(const std::vector<uint64_t>& req_ids) {
+    std::vector<req_res_t*> req_ress;
+
+    {
+        std::unique_lock lk(mutex);
+        for(auto req_id: req_ids) {
+            req_ress.push_back(&req_res_map.at(req_id));
+        }
+    }
+
+    {
+        std::shared_lock slk(pause_mutex); // used for snapshot
+
+        std::vector<std::shared_ptr<http_req>> reqs;
+        std::vector<std::shared_ptr<http_res>> ress;
+
+        for(size_t i = 0; i < req_ids.size(); i++) {
+            std::string serialized_req;
+            if(store->get(get_req_prefix_key(req_ids[i]) + StringUtils::serialize_uint32_t(0),
+                          serialized_req) != StoreStatus::FOUND) {
+                LOG(ERROR) << "Req ID " << req_ids[i] << " not found in the store.";
+                continue;
+            }
+
+            req_ress[i]->req->body = req_ress[i]->prev_req_body;
+            req_ress[i]->req->load_from_json(serialized_req);
+            reqs.push_back(req_ress[i]->req);
+            ress.push_back(req_ress[i]->res);
+        }
+
+        // update thread locals for reference during a crash
+        if(!reqs.empty()) {
+            write_log_index = reqs.front()->log_index;
+            write_log_last_index = reqs.back()->log_index;
+        }
+
+        auto resource_check = cached_resource_stat_t::get_instance()
+                              .has_enough_resources(config.get_data_dir(),
+                                                    config.get_disk_used_max_percentage(),
+                                                    config.get_memory_used_max_percentage());
+
+        if(resource_check != cached_resource_stat_t::OK) {
+            const std::string& err_msg = "Rejecting write: running out of resource type: " +
+                                         std::string(magic_enum::enum_name(resource_check));
+            LOG(ERROR) << err_msg;
+            for(auto& res: ress) {
+                res->set_422(err_msg);
+            }
+        } else if(skip_writes) {
+            for(auto& res: ress) {
+                res->set(422, "Skipping write.");
+            }
+        } else {
+            try {
+                post_add_coalesced_documents(reqs, ress);
+            } catch(const std::exception& e) {
+                LOG(ERROR) << "Exception while indexing " << reqs.size() << " coalesced writes.";
+                LOG(ERROR) << "Raw error: " << e.what();
+                for(auto& res: ress) {
+                    res->set_400("Bad request.");
+                }
+            }
+        }
+
+        for(size_t i = 0; i < reqs.size(); i++) {
+            if(ress[i]->is_alive) {
+                // sync request gets a response immediately
+                async_req_res_t* async_req_res = new async_req_res_t(reqs[i], ress[i], true);
+                server->get_message_dispatcher()->send_message(HttpServer::STREAM_RESPONSE_MESSAGE, async_req_res);
+            }
+
+            queued_writes--;
+        }
+
+        write_log_last_index = 0;
+    }
+
+    for(auto req_id: req_ids) {
+        const std::string& req_key_prefix = get_req_prefix_key(req_id);
+        store->delete_range(req_key_prefix, req_key_prefix + StringUtils::serialize_uint32_t(UINT32_MAX));
+    }
+
+    std::unique_lock lk(mutex);
+    for(auto req_id: req_ids) {
+        req_res_map.erase(req_id);
+    }
+    lk.unlock();
+    refq_wait.cv.notify_one();
+}
+
 std::string BatchedIndexer::get_req_prefix_key(uint64_t req_id) {
     const std::string& req_key_prefix = RAFT_REQ_LOG_PREFIX + StringUtils::serialize_uint64_t(req_id) + "_";
     return req_key_prefix;
@@ -517,6 +809,24 @@ int64_t BatchedIndexer::get_queued_writes() {
     return queued_writes;
 }
 
+void BatchedIndexer::get_queue_stats(nlohmann::json& stats) {
+    stats = nlohmann::json::object();
+    const uint64_t now = now_ms();
+
+    for(size_t i = 0; i < num_threads; i++) {
+        std::unique_lock qlk(qmutuxes[i].mcv);
+        for(const auto& kv: queues[i].coll_queues) {
+            if(kv.second.reqs.empty()) {
+                continue;
+            }
+
+            nlohmann::json& coll_stats = stats[kv.first];
+            coll_stats["queued_requests"] = kv.second.reqs.size();
+            coll_stats["oldest_wait_ms"] = now - kv.second.reqs.front().queued_at_ms;
+        }
+    }
+}
+
 void BatchedIndexer::populate_skip_index() {
     if(skip_index_iter->Valid() && skip_index_iter->key().starts_with(SKIP_INDICES_PREFIX)) {
         const std::string& index_value = skip_index_iter->value().ToString();
@@ -531,6 +841,15 @@ void BatchedIndexer::populate_skip_index() {
 }
 
 void BatchedIndexer::persist_applying_index() {
+    if(write_log_last_index > write_log_index) {
+        // Any write of the group could have triggered the crash: instead of skipping the first of them, the writes of
+        // the group are indexed one by one after the restart, so that the index of the one that crashes is saved.
+        LOG(INFO) << "Saving currently applying coalesced writes: " << write_log_index
+                  << " to " << write_log_last_index;
+        meta_store->insert(UNCOALESCED_UNTIL_INDEX_KEY, std::to_string(write_log_last_index));
+        return ;
+    }
+
     LOG(INFO) << "Saving currently applying index: " << write_log_index;
     std::string key = SKIP_INDICES_PREFIX + std::to_string(write_log_index);
     meta_store->insert(key, std::to_string(write_log_index));
@@ -575,7 +894,9 @@ void BatchedIndexer::load_state(const nlohmann::json& state) {
     queued_writes = state["queued_writes"].get<int64_t>();
 
     size_t num_reqs_restored = 0;
-    std::set<uint64_t> queue_ids;
+
+    // (start_ts, collection, num_chunks left)
+    std::vector<std::tuple<uint64_t, std::string, uint32_t>> restored_writes;
 
     for(auto& kv: state["req_res_map"].items()) {
         std::shared_ptr<http_req> req = std::make_shared<http_req>();
@@ -601,11 +922,8 @@ void BatchedIndexer::load_state(const nlohmann::json& state) {
             LOG(INFO) << "req_res.start_ts: " <<  req_res.start_ts
                       << ", req_res.next_chunk_index: " << req_res.next_chunk_index;
 
-            const std::string& coll_name = get_collection_name(req);
-            uint64_t queue_id = StringUtils::hash_wy(coll_name.c_str(), coll_name.size()) % num_threads;
-            queue_ids.insert(queue_id);
-            std::unique_lock qlk(qmutuxes[queue_id].mcv);
-            queues[queue_id].emplace_back(req->start_ts);
+            restored_writes.emplace_back(req->start_ts, get_collection_name(req),
+                                         req_res.num_chunks - req_res.next_chunk_index);
         }
 
         num_reqs_restored++;
@@ -620,11 +938,13 @@ void BatchedIndexer::load_state(const nlohmann::json& state) {
         refq_wait.cv.notify_one();
     }
 
-    // need to sort on `start_ts` to preserve original order before notifying queues
-    for(auto queue_id: queue_ids) {
-        std::unique_lock lk(qmutuxes[queue_id].mcv);
-        std::sort(queues[queue_id].begin(), queues[queue_id].end());
-        qmutuxes[queue_id].cv.notify_one();
+    // need to sort on `start_ts` to preserve original order before queueing
+    std::sort(restored_writes.begin(), restored_writes.end());
+
+    for(const auto& restored_write: restored_writes) {
+        const std::string& coll_name = std::get<1>(restored_write);
+        uint64_t queue_id = StringUtils::hash_wy(coll_name.c_str(), coll_name.size()) % num_threads;
+        queue_write(queue_id, coll_name, std::get<0>(restored_write), std::get<2>(restored_write) == 1);
     }
 
     LOG(INFO) << "Restored " << num_reqs_restored << " in-flight requests from snapshot.";
@@ -634,6 +954,10 @@ std::shared_mutex& BatchedIndexer::get_pause_mutex() {
     return pause_mutex;
 }
 
+BatchedIndexer::indexer_queue_t& BatchedIndexer::_get_queue(size_t queue_id) {
+    return queues[queue_id];
+}
+
 void BatchedIndexer::clear_skip_indices() {
     delete skip_index_iter;
     skip_index_iter = meta_store->scan(SKIP_INDICES_PREFIX, skip_index_iter_upper_bound);
@@ -643,5 +967,8 @@ void BatchedIndexer::clear_skip_indices() {
         skip_index_iter->Next();
     }
 
+    meta_store->remove(UNCOALESCED_UNTIL_INDEX_KEY);
+    uncoalesced_until_index = UNSET_SKIP_INDEX;
+
     meta_store->flush();
 }
@@ -11,6 +11,7 @@
 #include <collection_manager.h>
 #include <regex>
 #include <list>
+#include <fstream>
 #include <posting.h>
 #include <timsort.hpp>
 #include "validator.h"
@@ -19,12 +20,14 @@
 #include "thread_local_vars.h"
 #include "vector_query_ops.h"
 #include "embedder_manager.h"
+#include "embedding_pipeline.h"
 #include "stopwords_manager.h"
 #include "conversation_model.h"
 #include "conversation_manager.h"
 #include "conversation_model_manager.h"
 #include "field.h"
 #include "join.h"
+#include "file_utils.h"
 
 const std::string override_t::MATCH_EXACT = "exact";
 const std::string override_t::MATCH_CONTAINS = "contains";
@@ -243,6 +246,47 @@ Option<doc_seq_id_t> Collection::to_doc(const std::string & json_str, nlohmann::
         return Option<doc_seq_id_t>(400, std::string("Bad JSON: ") + e.what());
     }
 
+    return to_doc(document, operation, dirty_values, id);
+}
+
+void Collection::parse_json_lines(const std::vector<std::string>& json_lines, size_t begin, size_t end,
+                                  std::vector<nlohmann::json>& documents, std::vector<std::string>& errors) {
+    documents.clear();
+    documents.resize(end - begin);
+    errors.clear();
+    errors.resize(end - begin);
+
+    auto parse_lines = [&](size_t chunk_begin, size_t chunk_end) {
+        for(size_t i = chunk_begin; i < chunk_end; i++) {
+            try {
+                documents[i - begin] = nlohmann::json::parse(json_lines[i]);
+            } catch(const std::exception& e) {
+                LOG(ERROR) << "JSON error: " << e.what();
+                errors[i - begin] = std::string("Bad JSON: ") + e.what();
+            }
+        }
+
+        return true;
+    };
+
+    // lines that are not picked up by the pool are parsed by this thread when waiting for them
+    std::vector<std::shared_ptr<pooled_task_t<bool>>> tasks;
+    ThreadPool* thread_pool = CollectionManager::get_instance().get_index_thread_pool();
+
+    for(size_t chunk_begin = begin; chunk_begin < end; chunk_begin += PARSE_CHUNK_SIZE) {
+        const size_t chunk_end = std::min(chunk_begin + PARSE_CHUNK_SIZE, end);
+        tasks.push_back(pooled_task_t<bool>::run(thread_pool, [&parse_lines, chunk_begin, chunk_end]() {
+            return parse_lines(chunk_begin, chunk_end);
+        }));
+    }
+
+    for(auto& task: tasks) {
+        task->get();
+    }
+}
+
+Option<doc_seq_id_t> Collection::to_doc(nlohmann::json& document, const index_operation_t& operation,
+                                        const DIRTY_VALUES dirty_values, const std::string& id) {
     if(!document.is_object()) {
         return Option<doc_seq_id_t>(400, "Bad JSON: not a properly formed document.");
     }
@@ -358,6 +402,9 @@ nlohmann::json Collection::get_summary_json() const {
         // no need to sned hnsw_params for text fields
         if(coll_field.num_dim > 0) {
             field_json[fields::hnsw_params] = coll_field.hnsw_params;
+            if(!coll_field.ivf_params.empty()) {
+                field_json[fields::ivf_params] = coll_field.ivf_params;
+            }
         }
         if(coll_field.embed.count(fields::from) != 0) {
             field_json[fields::embed] = coll_field.embed;
@@ -390,6 +437,10 @@ nlohmann::json Collection::get_summary_json() const {
         json_response["metadata"] = metadata;
     }
 
+    if(index->get_index_concurrency() != 0) {
+        json_response[COLLECTION_INDEX_CONCURRENCY] = index->get_index_concurrency();
+    }
+
     if(vq_model) {
         json_response["voice_query_model"] = nlohmann::json::object();
         json_response["voice_query_model"]["model_name"] = vq_model->get_model_name();
@@ -437,9 +488,22 @@ nlohmann::json Collection::add_many(std::vector<std::string>& json_lines, nlohma
     // ensures that document IDs are not repeated within the same batch
     std::set<std::string> batch_doc_ids;
 
+    // lines are parsed ahead, a batch at a time
+    std::vector<nlohmann::json> parsed_docs;
+    std::vector<std::string> parse_errors;
+    size_t parsed_begin = 0, parsed_end = 0;
+
     for(size_t i=0; i < json_lines.size(); i++) {
-        const std::string & json_line = json_lines[i];
-        Option<doc_seq_id_t> doc_seq_id_op = to_doc(json_line, document, operation, dirty_values, id);
+        if(i >= parsed_end) {
+            parsed_begin = i;
+            parsed_end = std::min(i + index_batch_size, json_lines.size());
+            parse_json_lines(json_lines, parsed_begin, parsed_end, parsed_docs, parse_errors);
+        }
+
+        document = std::move(parsed_docs[i - parsed_begin]);
+        Option<doc_seq_id_t> doc_seq_id_op = parse_errors[i - parsed_begin].empty() ?
+                                             to_doc(document, operation, dirty_values, id) :
+                                             Option<doc_seq_id_t>(400, parse_errors[i - parsed_begin]);
 
         const uint32_t seq_id = doc_seq_id_op.ok() ? doc_seq_id_op.get().seq_id : 0;
         index_record record(i, seq_id, document, operation, dirty_values);
@@ -458,6 +522,7 @@ nlohmann::json Collection::add_many(std::vector<std::string>& json_lines, nlohma
 
             if(repeated_doc) {
                 // when a document repeats, we send the batch until this document so that we can deal with conflicts
+                parsed_docs[i - parsed_begin] = std::move(document);
                 i--;
                 goto do_batched_index;
             }
@@ -643,62 +708,76 @@ void Collection::batch_index(std::vector<index_record>& index_records, std::vect
                              size_t &num_indexed, const bool& return_doc, const bool& return_id, const size_t remote_embedding_batch_size,
                              const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries) {
 
-    batch_index_in_memory(index_records, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries, true);
+    bool defer_embeddings = false;
+    if(EmbeddingPipeline::get_instance().is_enabled()) {
+        std::shared_lock lock(mutex);
+        defer_embeddings = !embedding_fields.empty() && are_embedding_sources_stored();
+    }
 
-    // store only documents that were indexed in-memory successfully
-    for(auto& index_record: index_records) {
-        nlohmann::json res;
+    batch_index_in_memory(index_records, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries, true,
+                          defer_embeddings);
 
-        if(index_record.indexed.ok()) {
-            if(index_record.is_update) {
-                remove_flat_fields(index_record.new_doc);
-                for(auto& field: fields) {
-                    if(!field.store) {
-                        index_record.new_doc.erase(field.name);
-                    }
-                }
-                const std::string& serialized_json = index_record.new_doc.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+    std::vector<uint32_t> seq_ids_to_embed;
 
-                bool write_ok = store->insert(get_seq_id_key(index_record.seq_id), serialized_json);
+    // documents of the whole batch are written to disk at once
+    rocksdb::WriteBatch batch;
 
-                if(!write_ok) {
-                    // we will attempt to reindex the old doc on a best-effort basis
-                    LOG(ERROR) << "Update to disk failed. Will restore old document";
-                    remove_document(index_record.new_doc, index_record.seq_id, false);
-                    index_in_memory(index_record.old_doc, index_record.seq_id, index_record.operation, index_record.dirty_values);
-                    index_record.index_failure(500, "Could not write to on-disk storage.");
-                } else {
-                    num_indexed++;
-                    index_record.index_success();
-                }
+    // checked before the fields that are not stored are removed from the documents
+    std::vector<bool> needs_embedding(index_records.size(), false);
+
+    for(size_t i = 0; i < index_records.size(); i++) {
+        auto& index_record = index_records[i];
+        if(!index_record.indexed.ok()) {
+            continue;
+        }
+
+        needs_embedding[i] = defer_embeddings && needs_embeddings(index_record.doc, false);
+        nlohmann::json& document = index_record.is_update ? index_record.new_doc : index_record.doc;
 
+        // remove flattened field values before storing on disk
+        remove_flat_fields(document);
+        for(auto& field: fields) {
+            if(!field.store) {
+                document.erase(field.name);
+            }
+        }
+
+        const std::string& serialized_json = document.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+
+        if(!index_record.is_update) {
+            store->batch_put(batch, get_doc_id_key(index_record.doc["id"]), std::to_string(index_record.seq_id));
+        }
+
+        store->batch_put(batch, get_seq_id_key(index_record.seq_id), serialized_json);
+    }
+
+    const bool write_ok = (batch.Count() == 0) || store->batch_write(batch);
+
+    // store only documents that were indexed in-memory successfully
+    for(size_t i = 0; i < index_records.size(); i++) {
+        auto& index_record = index_records[i];
+        nlohmann::json res;
+
+        if(index_record.indexed.ok()) {
+            if(!write_ok && index_record.is_update) {
+                // we will attempt to reindex the old doc on a best-effort basis
+                LOG(ERROR) << "Update to disk failed. Will restore old document";
+                remove_document(index_record.new_doc, index_record.seq_id, false);
+                index_in_memory(index_record.old_doc, index_record.seq_id, index_record.operation, index_record.dirty_values);
+                index_record.index_failure(500, "Could not write to on-disk storage.");
+            } else if(!write_ok) {
+                // remove from in-memory store to keep the state synced
+                LOG(ERROR) << "Write to disk failed. Will restore old document";
+                remove_document(index_record.doc, index_record.seq_id, false);
+                index_record.index_failure(500, "Could not write to on-disk storage.");
             } else {
-                // remove flattened field values before storing on disk
-                remove_flat_fields(index_record.doc);
-                for(auto& field: fields) {
-                    if(!field.store) {
-                        index_record.doc.erase(field.name);
-                    }
-                }
-                const std::string& seq_id_str = std::to_string(index_record.seq_id);
-                const std::string& serialized_json = index_record.doc.dump(-1, ' ', false,
-                                                                           nlohmann::detail::error_handler_t::ignore);
-
-                rocksdb::WriteBatch batch;
-                batch.Put(get_doc_id_key(index_record.doc["id"]), seq_id_str);
-                batch.Put(get_seq_id_key(index_record.seq_id), serialized_json);
-                bool write_ok = store->batch_write(batch);
-
-                if(!write_ok) {
-                    // remove from in-memory store to keep the state synced
-                    LOG(ERROR) << "Write to disk failed. Will restore old document";
-                    remove_document(index_record.doc, index_record.seq_id, false);
-                    index_record.index_failure(500, "Could not write to on-disk storage.");
-                } else {
-                    num_indexed++;
-                    index_record.index_success();
+                num_indexed++;
+                index_record.index_success();
+                if(needs_embedding[i]) {
+                    seq_ids_to_embed.push_back(index_record.seq_id);
                 }
             }
+
             res["success"] = index_record.indexed.ok();
 
             if (return_doc & index_record.indexed.ok()) {
@@ -735,6 +814,9 @@ void Collection::batch_index(std::vector<index_record>& index_records, std::vect
         json_out[index_record.position] = res.dump(-1, ' ', false,
                                                    nlohmann::detail::error_handler_t::ignore);
     }
+
+    EmbeddingPipeline::get_instance().enqueue(collection_id, std::move(seq_ids_to_embed), remote_embedding_batch_size,
+                                              remote_embedding_timeout_ms);
 }
 
 Option<uint32_t> Collection::index_in_memory(nlohmann::json &document, uint32_t seq_id,
@@ -761,17 +843,149 @@ Option<uint32_t> Collection::index_in_memory(nlohmann::json &document, uint32_t
 }
 
 size_t Collection::batch_index_in_memory(std::vector<index_record>& index_records, const size_t remote_embedding_batch_size,
-                                         const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries, const bool generate_embeddings) {
+                                         const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries, const bool generate_embeddings,
+                                         const bool defer_embeddings) {
     std::unique_lock lock(mutex);
     size_t num_indexed = Index::batch_memory_index(index, index_records, default_sorting_field,
                                                    search_schema, embedding_fields, fallback_field_type,
                                                    token_separators, symbols_to_index, true, remote_embedding_batch_size,
                                                    remote_embedding_timeout_ms, remote_embedding_num_tries,generate_embeddings,
-                                                   false, tsl::htrie_map<char, field>(), name, async_referenced_ins);
+                                                   false, tsl::htrie_map<char, field>(), name, async_referenced_ins,
+                                                   defer_embeddings);
     num_documents += num_indexed;
     return num_indexed;
 }
 
+bool Collection::are_embedding_sources_stored() const {
+    for(const auto& embedding_field: embedding_fields) {
+        for(const auto& field_name: embedding_field.embed[fields::from].get<std::vector<std::string>>()) {
+            auto field_it = search_schema.find(field_name);
+            if(field_it == search_schema.end() || !field_it.value().store) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Collection::needs_embeddings(const nlohmann::json& document, const bool stored_fields_only) const {
+    std::shared_lock lock(mutex);
+
+    for(const auto& embedding_field: embedding_fields) {
+        if(document.contains(embedding_field.name) || (stored_fields_only && !embedding_field.store)) {
+            continue;
+        }
+
+        const auto& embed_from = embedding_field.embed[fields::from].get<std::vector<std::string>>();
+        for(const auto& field_name: embed_from) {
+            auto doc_field_it = document.find(field_name);
+            if(doc_field_it != document.end() && !doc_field_it.value().is_null()) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void Collection::embed_documents(const std::vector<uint32_t>& seq_ids, const size_t remote_embedding_batch_size,
+                                 const size_t remote_embedding_timeout_ms, std::vector<uint32_t>& failed_seq_ids,
+                                 std::vector<std::pair<uint32_t, std::string>>& update_docs) {
+    tsl::htrie_map<char, field> embed_fields;
+    tsl::htrie_map<char, field> schema;
+    bool sources_stored;
+
+    {
+        std::shared_lock lock(mutex);
+        embed_fields = embedding_fields;
+        schema = search_schema;
+        sources_stored = are_embedding_sources_stored();
+    }
+
+    if(!sources_stored) {
+        LOG(ERROR) << "Cannot embed " << seq_ids.size() << " documents of collection " << name
+                   << ", since the fields that they are embedded from are not stored.";
+        failed_seq_ids.insert(failed_seq_ids.end(), seq_ids.begin(), seq_ids.end());
+        return;
+    }
+
+    // documents are read again, since they could have been updated or deleted after they were queued
+    std::vector<index_record> records;
+    for(const uint32_t seq_id: seq_ids) {
+        nlohmann::json document;
+        if(!get_document_from_store(seq_id, document).ok()) {
+            continue;
+        }
+
+        for(const auto& embedding_field: embed_fields) {
+            document.erase(embedding_field.name);
+        }
+
+        records.emplace_back(records.size(), seq_id, document, UPDATE, DIRTY_VALUES::REJECT);
+    }
+
+    std::vector<index_record*> records_to_embed;
+    for(auto& record: records) {
+        records_to_embed.push_back(&record);
+    }
+
+    Index::batch_embed_fields(records_to_embed, embed_fields, schema, remote_embedding_batch_size,
+                              remote_embedding_timeout_ms, 1);
+
+    for(auto& record: records) {
+        if(!record.indexed.ok()) {
+            failed_seq_ids.push_back(record.seq_id);
+            continue;
+        }
+
+        nlohmann::json current_doc;
+        if(!get_document_from_store(record.seq_id, current_doc).ok()) {
+            continue;
+        }
+
+        nlohmann::json update_doc;
+        update_doc["id"] = record.doc["id"];
+
+        for(const auto& embedding_field: embed_fields) {
+            if(!record.doc.contains(embedding_field.name)) {
+                continue;
+            }
+
+            // A document that was changed while being embedded is queued again by that change. Changes that are yet to
+            // be written are ordered before the update, so an embedding that is stale by then is replaced later.
+            bool is_stale = false;
+            for(const auto& field_name: embedding_field.embed[fields::from].get<std::vector<std::string>>()) {
+                if(record.doc.value(field_name, nlohmann::json()) != current_doc.value(field_name, nlohmann::json())) {
+                    is_stale = true;
+                    break;
+                }
+            }
+
+            if(!is_stale) {
+                update_doc[embedding_field.name] = record.doc[embedding_field.name];
+            }
+        }
+
+        if(update_doc.size() > 1) {
+            update_docs.emplace_back(record.seq_id, update_doc.dump());
+        }
+    }
+}
+
+void Collection::remove_embedded_documents(std::vector<uint32_t>& seq_ids) {
+    std::vector<uint32_t> pending_seq_ids;
+
+    for(const uint32_t seq_id: seq_ids) {
+        nlohmann::json document;
+        if(get_document_from_store(seq_id, document).ok() && needs_embeddings(document, true)) {
+            pending_seq_ids.push_back(seq_id);
+        }
+    }
+
+    seq_ids = std::move(pending_seq_ids);
+}
+
 bool Collection::does_override_match(const override_t& override, std::string& query,
                                      std::set<uint32_t>& excluded_set,
                                      string& actual_query, const string& filter_query,
@@ -1208,8 +1422,8 @@ Option<bool> Collection::validate_and_standardize_sort_fields(const std::vector<
                             }
                         }
 
-                        std::string embed_query = embedder_manager.get_query_prefix(vector_field_it.value().embed[fields::model_config]) + q;
-                        auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+                        auto embedding_op = embedder_manager.embed_query(vector_field_it.value().embed[fields::model_config], embedder, q,
+                                                                         remote_embedding_timeout_ms, remote_embedding_num_tries);
 
                         if(!embedding_op.success) {
                             if(embedding_op.error.contains("error")) {
@@ -1263,8 +1477,8 @@ Option<bool> Collection::validate_and_standardize_sort_fields(const std::vector<
                         return Option<bool>(400, error);
                     }
 
-                    std::string embed_query = embedder_manager.get_query_prefix(vector_field_it.value().embed[fields::model_config]) + query;
-                    auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+                    auto embedding_op = embedder_manager.embed_query(vector_field_it.value().embed[fields::model_config], embedder, query,
+                                                                     remote_embedding_timeout_ms, remote_embedding_num_tries);
 
                     if(!embedding_op.success) {
                         if(embedding_op.error.contains("error")) {
@@ -1673,6 +1887,11 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
                            std::chrono::system_clock::now().time_since_epoch()).count();
     search_cutoff = false;
 
+    if(is_search_cancelled()) {
+        // client went away while the request was waiting to be processed
+        return Option<nlohmann::json>(408, "Request Timeout");
+    }
+
     if(raw_query != "*" && raw_search_fields.empty()) {
         return Option<nlohmann::json>(400, "No search fields specified for the query.");
     }
@@ -1867,18 +2086,25 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
                     }
                 }
 
-                std::string embed_query = embedder_manager.get_query_prefix(search_field.embed[fields::model_config]) + query;
-                auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
-                if(!embedding_op.success) {
-                    if(embedding_op.error.contains("error")) {
-                        return Option<nlohmann::json>(400, embedding_op.error["error"].get<std::string>());
-                    } else {
-                        return Option<nlohmann::json>(400, embedding_op.error.dump());
-                    }
-                }
-                std::vector<float> embedding = embedding_op.embedding;
-                // params could have been set for an embed field, so we take a backup and restore
-                vector_query.values = embedding;
+                // The query is embedded on the search thread pool, so that a hybrid search can run its keyword leg
+                // in the meantime. Index::search() waits for the embedding only when its vector leg needs it.
+                const nlohmann::json model_config = search_field.embed[fields::model_config];
+                vector_query.pending_values = pooled_task_t<Option<std::vector<float>>>::run(
+                    CollectionManager::get_instance().get_thread_pool(),
+                    [model_config, embedder, query, remote_embedding_timeout_ms, remote_embedding_num_tries]() {
+                        auto embedding_op = EmbedderManager::get_instance().embed_query(model_config, embedder, query,
+                                                                                        remote_embedding_timeout_ms,
+                                                                                        remote_embedding_num_tries);
+                        if(!embedding_op.success) {
+                            if(embedding_op.error.contains("error")) {
+                                return Option<std::vector<float>>(400, embedding_op.error["error"].get<std::string>());
+                            } else {
+                                return Option<std::vector<float>>(400, embedding_op.error.dump());
+                            }
+                        }
+
+                        return Option<std::vector<float>>(embedding_op.embedding);
+                    });
                 vector_query.field_name = field_name;
                 continue;
             }
@@ -2165,6 +2391,17 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
     // Set query to * if it is semantic search
     if(!vector_query.field_name.empty() && processed_search_fields.empty()) {
         query = "*";
+
+        // there is no keyword leg to overlap the embedding with
+        if(vector_query.pending_values != nullptr) {
+            auto values_op = vector_query.get_values();
+            if(!values_op.ok()) {
+                return Option<nlohmann::json>(values_op.code(), values_op.error());
+            }
+
+            vector_query.values = values_op.get();
+            vector_query.pending_values = nullptr;
+        }
     }
 
     // validate sort fields and standardize
@@ -2290,7 +2527,7 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
                                                  default_sorting_field,
                                                  prioritize_exact_match, prioritize_token_position,
                                                  prioritize_num_matching_fields,
-                                                 exhaustive_search, 4,
+                                                 exhaustive_search, Index::MAX_SEARCH_CONCURRENCY,
                                                  search_stop_millis,
                                                  min_len_1typo, min_len_2typo, max_candidates, infixes,
                                                  max_extra_prefix, max_extra_suffix, facet_query_num_typos,
@@ -2470,6 +2707,11 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
 
     // construct results array
     for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
+        if(is_search_cancelled()) {
+            // no point in fetching and highlighting documents that nobody will receive
+            return Option<nlohmann::json>(408, "Request Timeout");
+        }
+
         const std::vector<KV*> & kv_group = result_group_kvs[result_kvs_index];
 
         nlohmann::json group_hits;
@@ -2779,8 +3021,7 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
         }
 
         // check for search cutoff elapse
-        if((std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().
-            time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+        if(should_stop_search()) {
             search_cutoff = true;
             break;
         }
@@ -2991,6 +3232,15 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
 
     result["search_cutoff"] = search_cutoff;
 
+    if(exclude_fields.count("search_concurrency") == 0) {
+        result["search_concurrency"] = search_params->concurrency;
+    }
+
+    if(search_params->vector_search_strategy != vector_search_strategy_t::none &&
+       exclude_fields.count("vector_search_strategy") == 0) {
+        result["vector_search_strategy"] = magic_enum::enum_name(search_params->vector_search_strategy);
+    }
+
     result["request_params"] = nlohmann::json::object();
     result["request_params"]["collection_name"] = name;
     result["request_params"]["per_page"] = per_page;
@@ -4373,7 +4623,17 @@ void Collection::remove_document(nlohmann::json & document, const uint32_t seq_i
     {
         std::unique_lock lock(mutex);
 
-        index->remove(seq_id, document, {}, false);
+        // References are resolved through the field indices, so documents of collections that take part in joins are
+        // removed from them right away.
+        const bool remove_lazily = remove_from_store && Config::get_instance().get_enable_lazy_deletes() &&
+                                   referenced_in.empty() && async_referenced_ins.empty() && reference_fields.empty();
+
+        if(remove_lazily) {
+            index->remove_lazily(seq_id, document);
+        } else {
+            index->remove(seq_id, document, {}, false);
+        }
+
         if (num_documents != 0) {
             num_documents -= 1;
         }
@@ -4802,6 +5062,14 @@ void Collection::update_metadata(const nlohmann::json& meta) {
     metadata = meta;
 }
 
+void Collection::set_index_concurrency(size_t concurrency) {
+    index->set_index_concurrency(concurrency);
+}
+
+size_t Collection::get_index_concurrency() const {
+    return index->get_index_concurrency();
+}
+
 Option<bool> Collection::get_document_from_store(const uint32_t& seq_id,
                                                  nlohmann::json& document, bool raw_doc) const {
     return get_document_from_store(get_seq_id_key(seq_id), document, raw_doc);
@@ -5140,18 +5408,27 @@ Option<bool> Collection::batch_alter_data(const std::vector<field>& alter_fields
                                       found_embedding_field, true, schema_additions);
 
             if(found_embedding_field) {
+                rocksdb::WriteBatch embedding_batch;
                 for(auto& index_record : iter_batch) {
                     if(index_record.indexed.ok()) {
                         remove_flat_fields(index_record.doc);
                         const std::string& serialized_json = index_record.doc.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
-                        bool write_ok = store->insert(get_seq_id_key(index_record.seq_id), serialized_json);
+                        store->batch_put(embedding_batch, get_seq_id_key(index_record.seq_id), serialized_json);
+                    }
+                }
 
-                        if(!write_ok) {
-                            LOG(ERROR) << "Inserting doc with new embedding field failed for seq id: " << index_record.seq_id;
-                            index_record.index_failure(500, "Could not write to on-disk storage.");
-                        } else {
-                            index_record.index_success();
-                        }
+                const bool write_ok = (embedding_batch.Count() == 0) || store->batch_write(embedding_batch);
+
+                for(auto& index_record : iter_batch) {
+                    if(!index_record.indexed.ok()) {
+                        continue;
+                    }
+
+                    if(!write_ok) {
+                        LOG(ERROR) << "Inserting doc with new embedding field failed for seq id: " << index_record.seq_id;
+                        index_record.index_failure(500, "Could not write to on-disk storage.");
+                    } else {
+                        index_record.index_success();
                     }
                 }
             }
@@ -5986,6 +6263,7 @@ Index* Collection::init_index() {
                      store,
                      synonym_index,
                      CollectionManager::get_instance().get_thread_pool(),
+                     CollectionManager::get_instance().get_index_thread_pool(),
                      search_schema,
                      symbols_to_index, token_separators);
 }
@@ -6409,7 +6687,14 @@ void Collection::hide_credential(nlohmann::json& json, const std::string& creden
     }
 }
 
+size_t Collection::purge_tombstones() {
+    return index->purge_tombstones();
+}
+
 Option<bool> Collection::truncate_after_top_k(const string &field_name, size_t k) {
+    // the numeric index must not count the documents that are deleted already
+    index->purge_tombstones();
+
     std::shared_lock slock(mutex);
 
     std::vector<uint32_t> seq_ids;
@@ -6534,6 +6819,39 @@ void Collection::do_housekeeping() {
     index->repair_hnsw_index();
 }
 
+void Collection::save_vector_indices(const std::string& dir_path) const {
+    nlohmann::json meta = nlohmann::json::object();
+    index->save_vector_indices(dir_path, std::to_string(collection_id), meta);
+
+    if(meta.empty()) {
+        return;
+    }
+
+    std::ofstream meta_file(dir_path + "/" + std::to_string(collection_id) + ".json");
+    meta_file << meta.dump();
+}
+
+void Collection::load_vector_indices(const std::string& dir_path) {
+    const std::string meta_file_path = dir_path + "/" + std::to_string(collection_id) + ".json";
+    if(!file_exists(meta_file_path)) {
+        return;
+    }
+
+    std::ifstream meta_file(meta_file_path);
+    nlohmann::json meta = nlohmann::json::parse(meta_file, nullptr, false);
+
+    if(meta.is_discarded()) {
+        LOG(ERROR) << "Unable to parse the saved vector index meta of collection " << name;
+        return;
+    }
+
+    index->load_vector_indices(dir_path, meta);
+}
+
+void Collection::finish_vector_index_restore() {
+    index->finish_vector_index_restore();
+}
+
 Option<bool> Collection::parse_and_validate_vector_query(const std::string& vector_query_str,
                                                          vector_query_t& vector_query,
                                                          const bool is_wildcard_query,
@@ -6585,8 +6903,8 @@ Option<bool> Collection::parse_and_validate_vector_query(const std::string& vect
                 }
             }
 
-            std::string embed_query = embedder_manager.get_query_prefix(vector_field_it.value().embed[fields::model_config]) + q;
-            auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+            auto embedding_op = embedder_manager.embed_query(vector_field_it.value().embed[fields::model_config], embedder, q,
+                                                             remote_embedding_timeout_ms, remote_embedding_num_tries);
 
             if(!embedding_op.success) {
                 if(embedding_op.error.contains("error")) {
@@ -1,16 +1,19 @@
 #include <string>
 #include <vector>
+#include <fstream>
 #include <json.hpp>
 #include <app_metrics.h>
 #include <analytics_manager.h>
 #include <event_manager.h>
 #include "collection_manager.h"
 #include "batched_indexer.h"
+#include "embedding_pipeline.h"
 #include "logger.h"
 #include "magic_enum.hpp"
 #include "stopwords_manager.h"
 #include "conversation_model.h"
 #include "field.h"
+#include "file_utils.h"
 
 constexpr const size_t CollectionManager::DEFAULT_NUM_MEMORY_SHARDS;
 
@@ -120,6 +123,10 @@ Collection* CollectionManager::init_collection(const nlohmann::json & collection
                 -1, field_obj[fields::infix], field_obj[fields::nested], field_obj[fields::nested_array],
                 field_obj[fields::num_dim], vec_dist_type, field_obj[fields::reference], field_obj[fields::embed], field_obj[fields::range_index], field_obj[fields::store], field_obj[fields::stem], field_obj[fields::hnsw_params]);
 
+        if(field_obj.count(fields::ivf_params) != 0) {
+            f.ivf_params = field_obj[fields::ivf_params];
+        }
+
         // value of `sort` depends on field type
         if(field_obj.count(fields::sort) == 0) {
             f.sort = f.is_num_sort_field();
@@ -204,6 +211,10 @@ Collection* CollectionManager::init_collection(const nlohmann::json & collection
                                             enable_nested_fields, model, std::move(referenced_in),
                                             metadata, std::move(async_referenced_ins));
 
+    if(collection_meta.count(Collection::COLLECTION_INDEX_CONCURRENCY) != 0) {
+        collection->set_index_concurrency(collection_meta[Collection::COLLECTION_INDEX_CONCURRENCY].get<size_t>());
+    }
+
     return collection;
 }
 
@@ -216,6 +227,8 @@ void CollectionManager::add_to_collections(Collection* collection) {
 }
 
 void CollectionManager::init(Store *store, ThreadPool* thread_pool,
+                             ThreadPool* index_thread_pool,
+                             ThreadPool* background_thread_pool,
                              const float max_memory_ratio,
                              const std::string & auth_key,
                              std::atomic<bool>& quit,
@@ -224,6 +237,8 @@ void CollectionManager::init(Store *store, ThreadPool* thread_pool,
 
     this->store = store;
     this->thread_pool = thread_pool;
+    this->index_thread_pool = index_thread_pool;
+    this->background_thread_pool = background_thread_pool;
     this->bootstrap_auth_key = auth_key;
     this->max_memory_ratio = max_memory_ratio;
     this->quit = &quit;
@@ -234,8 +249,11 @@ void CollectionManager::init(Store *store, ThreadPool* thread_pool,
 void CollectionManager::init(Store *store, const float max_memory_ratio, const std::string & auth_key,
                              std::atomic<bool>& quit,
                              const uint16_t& filter_by_max_operations) {
-    ThreadPool* thread_pool = new ThreadPool(8);
-    init(store, thread_pool, max_memory_ratio, auth_key, quit, filter_by_max_operations);
+    ThreadPool* thread_pool = new ThreadPool(8, "search");
+    ThreadPool* index_thread_pool = new ThreadPool(8, "index");
+    ThreadPool* background_thread_pool = new ThreadPool(2, "background");
+    init(store, thread_pool, index_thread_pool, background_thread_pool, max_memory_ratio, auth_key, quit,
+         filter_by_max_operations);
 }
 
 void CollectionManager::_populate_referenced_ins(const std::string& collection_meta_json,
@@ -357,6 +375,16 @@ Option<bool> CollectionManager::load(const size_t collection_batch_size, const s
 
         collection_name = collection_meta[Collection::COLLECTION_NAME_KEY].get<std::string>();
 
+        if(Config::get_instance().get_enable_collection_column_families()) {
+            const uint32_t collection_id = collection_meta[Collection::COLLECTION_ID_KEY].get<uint32_t>();
+            if(!store->has_collection_family(collection_id)) {
+                LOG(INFO) << "Moving the documents of collection " << collection_name << " into its own column family.";
+                if(!store->migrate_to_collection_family(collection_id)) {
+                    LOG(ERROR) << "Documents of collection " << collection_name << " stay in the default column family.";
+                }
+            }
+        }
+
         auto captured_store = store;
         loading_pool.enqueue([captured_store, num_collections, collection_meta, document_batch_size,
                               &m_process, &cv_process, &num_processed, &next_coll_id_status, quit = quit,
@@ -508,7 +536,8 @@ Option<Collection*> CollectionManager::create_collection(const std::string& name
                                                          const std::vector<std::string>& symbols_to_index,
                                                          const std::vector<std::string>& token_separators,
                                                          const bool enable_nested_fields, std::shared_ptr<VQModel> model,
-                                                         const nlohmann::json& metadata) {
+                                                         const nlohmann::json& metadata,
+                                                         const size_t index_concurrency) {
     std::unique_lock lock(mutex);
 
     if(store->contains(Collection::get_meta_key(name))) {
@@ -555,6 +584,15 @@ Option<Collection*> CollectionManager::create_collection(const std::string& name
         collection_meta[Collection::COLLECTION_METADATA] = metadata;
     }
 
+    if(index_concurrency != 0) {
+        collection_meta[Collection::COLLECTION_INDEX_CONCURRENCY] = index_concurrency;
+    }
+
+    if(Config::get_instance().get_enable_collection_column_families() &&
+       !store->create_collection_family(new_coll_id)) {
+        LOG(ERROR) << "Documents of collection " << name << " will be stored in the default column family.";
+    }
+
     rocksdb::WriteBatch batch;
     batch.Put(Collection::get_next_seq_id_key(name), StringUtils::serialize_uint32_t(0));
     batch.Put(Collection::get_meta_key(name), collection_meta.dump());
@@ -574,6 +612,7 @@ Option<Collection*> CollectionManager::create_collection(const std::string& name
                                                 enable_nested_fields, model,
                                                 spp::sparse_hash_map<std::string, std::string>(),
                                                 metadata);
+    new_collection->set_index_concurrency(index_concurrency);
 
     add_to_collections(new_collection);
 
@@ -687,13 +726,16 @@ Option<nlohmann::json> CollectionManager::drop_collection(const std::string& col
     nlohmann::json collection_json = collection->get_summary_json();
 
     if(remove_from_store) {
-        const std::string& del_key_prefix = std::to_string(collection->get_collection_id()) + "_";
-        const std::string& del_end_prefix = std::to_string(collection->get_collection_id()) + "`";
-        store->delete_range(del_key_prefix, del_end_prefix);
-
-        if(compact_store) {
-            store->flush();
-            store->compact_range(del_key_prefix, del_end_prefix);
+        // documents in a column family of the collection are dropped along with it, without any compaction
+        if(!store->drop_collection_family(collection->get_collection_id())) {
+            const std::string& del_key_prefix = std::to_string(collection->get_collection_id()) + "_";
+            const std::string& del_end_prefix = std::to_string(collection->get_collection_id()) + "`";
+            store->delete_range(del_key_prefix, del_end_prefix);
+
+            if(compact_store) {
+                store->flush();
+                store->compact_range(del_key_prefix, del_end_prefix);
+            }
         }
 
         // delete overrides
@@ -1235,6 +1277,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     const char *PRE_SEGMENTED_QUERY = "pre_segmented_query";
 
     const char *SEARCH_CUTOFF_MS = "search_cutoff_ms";
+    const char *DEADLINE_MS = http_req::DEADLINE_HEADER;
     const char *EXHAUSTIVE_SEARCH = "exhaustive_search";
     const char *SPLIT_JOIN_TOKENS = "split_join_tokens";
 
@@ -1383,6 +1426,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     std::string highlight_fields;
     bool exhaustive_search = false;
     size_t search_cutoff_ms = 30 * 1000;
+    size_t deadline_ms = 0;
     enable_t split_join_tokens = fallback;
     size_t max_candidates = 0;
     std::vector<enable_t> infixes;
@@ -1428,6 +1472,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         {LIMIT, &per_page},
         {GROUP_LIMIT, &group_limit},
         {SEARCH_CUTOFF_MS, &search_cutoff_ms},
+        {DEADLINE_MS, &deadline_ms},
         {MAX_EXTRA_PREFIX, &max_extra_prefix},
         {MAX_EXTRA_SUFFIX, &max_extra_suffix},
         {MAX_CANDIDATES, &max_candidates},
@@ -1576,6 +1621,20 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         }
     }
 
+    // A client supplied deadline is measured from when the request was received and can only shorten the time budget
+    // of the search, which is also measured from then.
+    if(deadline_ms != 0) {
+        uint64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        uint64_t elapsed_ms = (start_ts != 0 && now_us > start_ts) ? (now_us - start_ts) / 1000 : 0;
+
+        if(elapsed_ms >= deadline_ms) {
+            return Option<bool>(408, "Request Timeout");
+        }
+
+        search_cutoff_ms = std::min(search_cutoff_ms, deadline_ms);
+    }
+
     // special defaults
     if(!req_params[FACET_QUERY].empty() && req_params.count(PER_PAGE) == 0) {
         // for facet query we will set per_page to zero if it is not explicitly overridden
@@ -1700,6 +1759,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
 
     AppMetrics::get_instance().increment_count(AppMetrics::SEARCH_LABEL, 1);
     AppMetrics::get_instance().increment_duration(AppMetrics::SEARCH_LABEL, timeMillis);
+    AppMetrics::get_instance().increment_collection_duration(collection->get_name(), timeMillis);
 
     if(!result_op.ok()) {
         return Option<bool>(result_op.code(), result_op.error());
@@ -1743,6 +1803,31 @@ ThreadPool* CollectionManager::get_thread_pool() const {
     return thread_pool;
 }
 
+ThreadPool* CollectionManager::get_index_thread_pool() const {
+    return index_thread_pool;
+}
+
+ThreadPool* CollectionManager::get_background_thread_pool() const {
+    return background_thread_pool;
+}
+
+void CollectionManager::get_thread_pool_stats(nlohmann::json& result) const {
+    result = nlohmann::json::object();
+
+    for(ThreadPool* pool: {thread_pool, index_thread_pool, background_thread_pool}) {
+        if(pool == nullptr) {
+            continue;
+        }
+
+        nlohmann::json pool_stats;
+        pool_stats["num_threads"] = pool->get_num_threads();
+        pool_stats["active_tasks"] = pool->get_num_active();
+        pool_stats["queued_tasks"] = pool->get_num_queued();
+        pool_stats["completed_tasks"] = pool->get_num_completed();
+        result[pool->get_name()] = pool_stats;
+    }
+}
+
 Option<nlohmann::json> CollectionManager::get_collection_summaries(uint32_t limit, uint32_t offset,
                                                                    const std::vector<std::string>& exclude_fields,
                                                                    const std::vector<std::string>& api_key_collections) const {
@@ -1776,6 +1861,7 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
     const char* ENABLE_NESTED_FIELDS = "enable_nested_fields";
     const char* DEFAULT_SORTING_FIELD = "default_sorting_field";
     const char* METADATA = "metadata";
+    const char* INDEX_CONCURRENCY = "index_concurrency";
 
     // validate presence of mandatory fields
 
@@ -1849,6 +1935,15 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
         return Option<Collection*>(400, std::string("`") + NUM_MEMORY_SHARDS + "` should be a positive integer.");
     }
 
+    size_t index_concurrency = 0;
+    if(req_json.count(INDEX_CONCURRENCY) != 0) {
+        if(!req_json[INDEX_CONCURRENCY].is_number_unsigned() || req_json[INDEX_CONCURRENCY].get<size_t>() == 0) {
+            return Option<Collection*>(400, std::string("`") + INDEX_CONCURRENCY + "` should be a positive integer.");
+        }
+
+        index_concurrency = req_json[INDEX_CONCURRENCY].get<size_t>();
+    }
+
     // field specific validation
 
     if(!req_json["fields"].is_array() || req_json["fields"].empty()) {
@@ -1914,7 +2009,7 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
                                                                 req_json[SYMBOLS_TO_INDEX],
                                                                 req_json[TOKEN_SEPARATORS],
                                                                 req_json[ENABLE_NESTED_FIELDS],
-                                                                model, req_json[METADATA]);
+                                                                model, req_json[METADATA], index_concurrency);
 }
 
 Option<bool> CollectionManager::load_collection(const nlohmann::json &collection_meta,
@@ -1973,6 +2068,12 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
 
     LOG(INFO) << "Loading collection " << collection->get_name();
 
+    // vectors of documents that are already in a saved graph are not inserted again
+    const bool restore_vector_indices = !cm.vector_index_snapshot_path.empty();
+    if(restore_vector_indices) {
+        collection->load_vector_indices(cm.vector_index_snapshot_path);
+    }
+
     // initialize overrides
     std::vector<std::string> collection_override_jsons;
     cm.store->scan_fill(Collection::get_override_key(this_collection_name, ""),
@@ -2012,6 +2113,11 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
 
     std::vector<index_record> index_records;
 
+    // documents that were written without their embeddings before a restart are embedded again
+    const bool embed_pending_docs = EmbeddingPipeline::get_instance().is_enabled() &&
+                                    !collection->get_embedding_fields().empty();
+    std::vector<uint32_t> seq_ids_to_embed;
+
     size_t num_found_docs = 0;
     size_t num_valid_docs = 0;
     size_t num_indexed_docs = 0;
@@ -2044,6 +2150,10 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
 
         num_valid_docs++;
 
+        if(embed_pending_docs && collection->needs_embeddings(document, true)) {
+            seq_ids_to_embed.push_back(seq_id);
+        }
+
         index_records.emplace_back(index_record(0, seq_id, document, CREATE, dirty_values));
 
         // Peek and check for last record right here so that we handle batched indexing correctly
@@ -2088,14 +2198,85 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
         }
     }
 
+    if(restore_vector_indices) {
+        collection->finish_vector_index_restore();
+    }
+
     cm.add_to_collections(collection);
 
+    if(!seq_ids_to_embed.empty()) {
+        LOG(INFO) << "Queued " << seq_ids_to_embed.size() << " documents of collection " << collection->get_name()
+                  << " for embedding.";
+        EmbeddingPipeline::get_instance().enqueue(collection->get_collection_id(), std::move(seq_ids_to_embed),
+                                                  Config::get_instance().get_async_embedding_batch_size(),
+                                                  Config::get_instance().get_async_embedding_timeout_ms());
+    }
+
     LOG(INFO) << "Indexed " << num_indexed_docs << "/" << num_found_docs
               << " documents into collection " << collection->get_name();
 
     return Option<bool>(true);
 }
 
+void CollectionManager::save_vector_indices(const std::string& dir_path, int64_t applied_index) const {
+    if(!create_directory(dir_path)) {
+        LOG(ERROR) << "Unable to create the vector index snapshot directory " << dir_path;
+        return;
+    }
+
+    std::vector<std::string> coll_names;
+
+    {
+        std::shared_lock lock(mutex);
+        for(const auto& kv: collections) {
+            coll_names.push_back(kv.first);
+        }
+    }
+
+    // writes are not paused during the save, so a collection could be dropped meanwhile
+    for(const auto& coll_name: coll_names) {
+        auto collection = get_collection(coll_name);
+        if(collection == nullptr) {
+            continue;
+        }
+
+        collection->save_vector_indices(dir_path);
+    }
+
+    // written last, so that an incomplete save is never loaded
+    nlohmann::json meta;
+    meta["applied_index"] = applied_index;
+    std::ofstream meta_file(dir_path + "/meta.json");
+    meta_file << meta.dump();
+}
+
+void CollectionManager::set_vector_index_snapshot_path(const std::string& dir_path) {
+    vector_index_snapshot_path.clear();
+
+    if(dir_path.empty() || !file_exists(dir_path + "/meta.json")) {
+        return;
+    }
+
+    std::ifstream meta_file(dir_path + "/meta.json");
+    nlohmann::json meta = nlohmann::json::parse(meta_file, nullptr, false);
+
+    std::string store_applied_index;
+    // The indices are saved after the store is checkpointed, while writes continue, so they can be ahead of the
+    // documents. Documents are reconciled against them during load, and later writes are replayed from the raft log.
+    // Indices saved before the checkpoint could miss documents that were removed since, so they are not loaded.
+    if(meta.is_discarded() || !meta.contains("applied_index") || !meta["applied_index"].is_number_integer() ||
+       store->get(VECTOR_INDEX_SNAPSHOT_KEY, store_applied_index) != StoreStatus::FOUND ||
+       !StringUtils::is_int64_t(store_applied_index) ||
+       meta["applied_index"].get<int64_t>() < std::stoll(store_applied_index)) {
+        LOG(WARNING) << "Saved vector indices do not match the snapshot, they will be rebuilt.";
+        return;
+    }
+
+    LOG(INFO) << "Loading vector indices saved at raft index " << meta["applied_index"].get<int64_t>()
+              << ", snapshot raft index: " << store_applied_index;
+    vector_index_snapshot_path = dir_path;
+}
+
 spp::sparse_hash_map<std::string, nlohmann::json> CollectionManager::get_presets() const {
     std::shared_lock lock(mutex);
     return preset_configs;
@@ -19,6 +19,9 @@
 #include "conversation_manager.h"
 #include "conversation_model_manager.h"
 #include "conversation_model.h"
+#include "embedder_manager.h"
+#include "embedding_pipeline.h"
+#include "thread_local_vars.h"
 
 using namespace std::chrono_literals;
 
@@ -48,6 +51,19 @@ public:
     }
 };
 
+// Ties the searches run on this thread to the client connection, so that they are abandoned once the client goes away.
+class search_client_guard_t {
+public:
+    search_client_guard_t(const std::shared_ptr<http_res>& res) {
+        // responses that are not backed by a client connection are never alive to begin with
+        search_client_alive = res->is_alive ? &res->is_alive : nullptr;
+    }
+
+    ~search_client_guard_t() {
+        search_client_alive = nullptr;
+    }
+};
+
 void init_api(uint32_t cache_num_entries) {
     std::unique_lock lock(mutex);
     res_cache.capacity(cache_num_entries);
@@ -505,11 +521,47 @@ bool get_stats_json(const std::shared_ptr<http_req>& req, const std::shared_ptr<
     nlohmann::json result;
     AppMetrics::get_instance().get("requests_per_second", "latency_ms", result);
     result["pending_write_batches"] = server->get_num_queued_writes();
+    server->get_write_queue_stats(result["write_queues"]);
+    CollectionManager::get_instance().get_thread_pool_stats(result["thread_pools"]);
+    EmbedderManager::get_instance().get_query_embedding_cache_stats(result["query_embedding_cache"]);
+    EmbeddingPipeline::get_instance().get_stats(result["async_embedding"]);
 
     res->set_body(200, result.dump(2));
     return true;
 }
 
+bool get_stats_prometheus(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
+    std::string body;
+    AppMetrics::get_instance().get_prometheus(body);
+
+    body += "# HELP typesense_pending_write_batches Number of write batches waiting to be indexed.\n";
+    body += "# TYPE typesense_pending_write_batches gauge\n";
+    body += "typesense_pending_write_batches " + std::to_string(server->get_num_queued_writes()) + "\n";
+
+    nlohmann::json embedding_cache_stats;
+    EmbedderManager::get_instance().get_query_embedding_cache_stats(embedding_cache_stats);
+
+    body += "# HELP typesense_query_embedding_cache_hits_total Query embeddings served from the cache.\n";
+    body += "# TYPE typesense_query_embedding_cache_hits_total counter\n";
+    body += "typesense_query_embedding_cache_hits_total " + embedding_cache_stats["hits"].dump() + "\n";
+    body += "# HELP typesense_query_embedding_cache_misses_total Query embeddings that had to be computed.\n";
+    body += "# TYPE typesense_query_embedding_cache_misses_total counter\n";
+    body += "typesense_query_embedding_cache_misses_total " + embedding_cache_stats["misses"].dump() + "\n";
+
+    nlohmann::json async_embedding_stats;
+    EmbeddingPipeline::get_instance().get_stats(async_embedding_stats);
+
+    body += "# HELP typesense_async_embedding_pending_documents Number of documents waiting for their embeddings.\n";
+    body += "# TYPE typesense_async_embedding_pending_documents gauge\n";
+    body += "typesense_async_embedding_pending_documents " + async_embedding_stats["pending_documents"].dump() + "\n";
+    body += "# HELP typesense_async_embedding_failed_documents_total Documents whose embeddings could not be generated.\n";
+    body += "# TYPE typesense_async_embedding_failed_documents_total counter\n";
+    body += "typesense_async_embedding_failed_documents_total " + async_embedding_stats["failed_documents"].dump() + "\n";
+
+    res->set_content(200, "text/plain; version=0.0.4; charset=utf-8", body, true);
+    return true;
+}
+
 bool get_status(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
     nlohmann::json status = server->node_status();
     res->set_body(200, status.dump());
@@ -521,7 +573,7 @@ uint64_t hash_request(const std::shared_ptr<http_req>& req) {
     ss << req->route_hash << req->body;
 
     for(auto& kv: req->params) {
-        if(kv.first != "use_cache") {
+        if(kv.first != "use_cache" && kv.first != http_req::DEADLINE_HEADER) {
             ss << kv.second;
         }
     }
@@ -536,6 +588,7 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
     uint64_t req_hash = 0;
 
     in_flight_req_guard_t in_flight_req_guard(req);
+    search_client_guard_t search_client_guard(res);
 
     if(use_cache) {
         // cache enabled, let's check if request is already in the cache
@@ -583,8 +636,9 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
 
     res->set_200(results_json_str);
 
-    // we will cache only successful requests
-    if(use_cache) {
+    // we will cache only successful requests whose results are complete: a search that was cut off by its time budget
+    // or by the client going away is set on the thread local by the search
+    if(use_cache && !search_cutoff) {
         //LOG(INFO) << "Adding to cache, key = " << req_hash;
         auto now = std::chrono::high_resolution_clock::now();
         const auto cache_ttl_it = req->params.find("cache_ttl");
@@ -609,6 +663,7 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
     uint64_t req_hash = 0;
 
     in_flight_req_guard_t in_flight_req_guard(req);
+    search_client_guard_t search_client_guard(res);
 
     if(use_cache) {
         // cache enabled, let's check if request is already in the cache
@@ -688,6 +743,7 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
     nlohmann::json response;
     response["results"] = nlohmann::json::array();
+    bool is_search_cutoff = false;
 
     nlohmann::json& searches = req_json["searches"];
 
@@ -840,6 +896,7 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
         if(search_op.ok()) {
             auto results_json = nlohmann::json::parse(results_json_str);
+            is_search_cutoff = is_search_cutoff || results_json.value("search_cutoff", false);
             if(conversation) {
                 results_json["request_params"]["q"] = common_query;
             }
@@ -988,8 +1045,8 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
     res->set_200(response.dump());
 
-    // we will cache only successful requests
-    if(use_cache) {
+    // we will cache only successful requests whose results are complete
+    if(use_cache && !is_search_cutoff) {
         //LOG(INFO) << "Adding to cache, key = " << req_hash;
         auto now = std::chrono::high_resolution_clock::now();
         const auto cache_ttl_it = req->params.find("cache_ttl");
@@ -1405,6 +1462,37 @@ bool post_import_documents(const std::shared_ptr<http_req>& req, const std::shar
     return true;
 }
 
+// sets the error response of a document write from its result line of `add_many`
+static void set_add_document_error(const std::string& result_line, const std::shared_ptr<http_res>& res) {
+    nlohmann::json res_doc;
+
+    try {
+        res_doc = nlohmann::json::parse(result_line);
+    } catch(const std::exception& e) {
+        LOG(ERROR) << "JSON error: " << e.what();
+        res->set_400("Bad JSON.");
+        return;
+    }
+
+    res->status_code = res_doc["code"].get<size_t>();
+    // erase keys from res_doc except error and embedding_error
+    for(auto it = res_doc.begin(); it != res_doc.end(); ) {
+        if(it.key() != "error" && it.key() != "embedding_error") {
+            it = res_doc.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // rename error to message if not empty and exists
+    if(res_doc.count("error") != 0 && !res_doc["error"].get<std::string>().empty()) {
+        res_doc["message"] = res_doc["error"];
+        res_doc.erase("error");
+    }
+
+    res->body = res_doc.dump();
+}
+
 bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
     const char *ACTION = "action";
     const char *DIRTY_VALUES_PARAM = "dirty_values";
@@ -1453,38 +1541,66 @@ bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_p
                                                                  remote_embedding_num_tries);
 
     if(!inserted_doc_op["success"].get<bool>()) {
-        nlohmann::json res_doc;
+        set_add_document_error(json_lines[0], res);
+        return false;
+    }
 
-        try {
-            res_doc = nlohmann::json::parse(json_lines[0]);
-        } catch(const std::exception& e) {
-            LOG(ERROR) << "JSON error: " << e.what();
-            res->set_400("Bad JSON.");
-            return false;
-        }
+    res->set_201(document.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
+    return true;
+}
 
-        res->status_code = res_doc["code"].get<size_t>();
-        // erase keys from res_doc except error and embedding_error
-        for(auto it = res_doc.begin(); it != res_doc.end(); ) {
-            if(it.key() != "error" && it.key() != "embedding_error") {
-                it = res_doc.erase(it);
-            } else {
-                ++it;
-            }
-        }
+void post_add_coalesced_documents(const std::vector<std::shared_ptr<http_req>>& reqs,
+                                  const std::vector<std::shared_ptr<http_res>>& ress) {
+    if(reqs.empty()) {
+        return;
+    }
+
+    const std::shared_ptr<http_req>& req = reqs.front();
 
-        // rename error to message if not empty and exists
-        if(res_doc.count("error") != 0 && !res_doc["error"].get<std::string>().empty()) {
-            res_doc["message"] = res_doc["error"];
-            res_doc.erase("error");
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    auto collection = collectionManager.get_collection(req->params["collection"]);
+
+    if(collection == nullptr) {
+        for(const auto& res: ress) {
+            res->set_404();
         }
+        return;
+    }
 
-        res->body = res_doc.dump();
-        return false;
+    const std::string& action = (req->params.count("action") == 0) ? "create" : req->params["action"];
+    const index_operation_t operation = get_index_operation(action);
+    const auto& dirty_values = collection->parse_dirty_values_option(req->params["dirty_values"]);
+
+    size_t remote_embedding_timeout_ms = 60000;
+    size_t remote_embedding_num_tries = 2;
+
+    if(req->params.count("remote_embedding_timeout_ms") != 0) {
+        remote_embedding_timeout_ms = std::stoul(req->params["remote_embedding_timeout_ms"]);
     }
 
-    res->set_201(document.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
-    return true;
+    if(req->params.count("remote_embedding_num_tries") != 0) {
+        remote_embedding_num_tries = std::stoul(req->params["remote_embedding_num_tries"]);
+    }
+
+    std::vector<std::string> json_lines;
+    for(const auto& coalesced_req: reqs) {
+        json_lines.push_back(coalesced_req->body);
+    }
+
+    nlohmann::json document;
+    collection->add_many(json_lines, document, operation, "", dirty_values, true, false, 200,
+                         remote_embedding_timeout_ms, remote_embedding_num_tries);
+
+    for(size_t i = 0; i < ress.size(); i++) {
+        nlohmann::json result = nlohmann::json::parse(json_lines[i], nullptr, false);
+        if(result.is_discarded() || !result.is_object() || !result.value("success", false)) {
+            set_add_document_error(json_lines[i], ress[i]);
+            continue;
+        }
+
+        Collection::remove_reference_helper_fields(result["document"]);
+        ress[i]->set_201(result["document"].dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
+    }
 }
 
 bool patch_update_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
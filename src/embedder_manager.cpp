@@ -1,5 +1,7 @@
 #include "embedder_manager.h"
 #include "system_metrics.h"
+#include "tsconfig.h"
+#include <cctype>
 
 
 EmbedderManager& EmbedderManager::get_instance() {
@@ -7,6 +9,10 @@ EmbedderManager& EmbedderManager::get_instance() {
     return instance;
 }
 
+EmbedderManager::EmbedderManager() {
+    set_query_embedding_cache_capacity(Config::get_instance().get_embedding_cache_num_entries());
+}
+
 Option<bool> EmbedderManager::validate_and_init_model(const nlohmann::json& model_config, size_t& num_dims) {
     const std::string& model_name = model_config["model_name"].get<std::string>();
 
@@ -145,10 +151,14 @@ Option<bool> EmbedderManager::validate_and_init_local_model(const nlohmann::json
     return Option<bool>(true);
 }
 
+std::string EmbedderManager::get_model_key(const nlohmann::json& model_config) {
+    const std::string& model_name = model_config.at("model_name");
+    return is_remote_model(model_name) ? RemoteEmbedder::get_model_key(model_config) : model_name;
+}
+
 Option<TextEmbedder*> EmbedderManager::get_text_embedder(const nlohmann::json& model_config) {
     std::unique_lock<std::mutex> lock(text_embedders_mutex);
-    const std::string& model_name = model_config.at("model_name");
-    std::string model_key = is_remote_model(model_name) ? RemoteEmbedder::get_model_key(model_config) : model_name;
+    const std::string& model_key = get_model_key(model_config);
     auto text_embedder_it = text_embedders.find(model_key);
 
     if(text_embedder_it == text_embedders.end()) {
@@ -171,19 +181,105 @@ Option<ImageEmbedder*> EmbedderManager::get_image_embedder(const nlohmann::json&
 }
 
 void EmbedderManager::delete_text_embedder(const std::string& model_path) {
-    std::unique_lock<std::mutex> lock(text_embedders_mutex);
-    if (text_embedders.find(model_path) != text_embedders.end()) {
-        text_embedders.erase(model_path);
-    }
+    {
+        std::unique_lock<std::mutex> lock(text_embedders_mutex);
+        if (text_embedders.find(model_path) != text_embedders.end()) {
+            text_embedders.erase(model_path);
+        }
 
-    if (public_models.find(model_path) != public_models.end()) {
-        public_models.erase(model_path);
+        if (public_models.find(model_path) != public_models.end()) {
+            public_models.erase(model_path);
+        }
     }
+
+    // a model that is created again under the same name could produce different embeddings
+    clear_query_embedding_cache();
 }
 
 void EmbedderManager::delete_all_text_embedders() {
-    std::unique_lock<std::mutex> lock(text_embedders_mutex);
-    text_embedders.clear();
+    {
+        std::unique_lock<std::mutex> lock(text_embedders_mutex);
+        text_embedders.clear();
+    }
+
+    clear_query_embedding_cache();
+}
+
+embedding_res_t EmbedderManager::embed_query(const nlohmann::json& model_config, TextEmbedder* embedder,
+                                             const std::string& query, size_t remote_embedding_timeout_ms,
+                                             size_t remote_embedding_num_tries) {
+    const std::string& embed_text = get_query_prefix(model_config) + normalize_query(query);
+
+    if(query_embedding_cache_capacity == 0) {
+        return embedder->Embed(embed_text, remote_embedding_timeout_ms, remote_embedding_num_tries);
+    }
+
+    const std::string& cache_key = get_model_key(model_config) + '\n' + embed_text;
+
+    {
+        std::unique_lock<std::mutex> lock(query_embedding_cache_mutex);
+        auto hit_it = query_embedding_cache.find(cache_key);
+        if(hit_it != query_embedding_cache.end()) {
+            query_embedding_cache_hits++;
+            return embedding_res_t(hit_it->second);
+        }
+    }
+
+    query_embedding_cache_misses++;
+
+    // the lock is not held while embedding, so concurrent misses on the same query could both run the model
+    auto embedding_res = embedder->Embed(embed_text, remote_embedding_timeout_ms, remote_embedding_num_tries);
+
+    if(embedding_res.success) {
+        std::unique_lock<std::mutex> lock(query_embedding_cache_mutex);
+        query_embedding_cache.insert(cache_key, embedding_res.embedding);
+    }
+
+    return embedding_res;
+}
+
+void EmbedderManager::set_query_embedding_cache_capacity(size_t capacity) {
+    std::unique_lock<std::mutex> lock(query_embedding_cache_mutex);
+    query_embedding_cache_capacity = capacity;
+    if(capacity == 0) {
+        query_embedding_cache.clear();
+    } else {
+        query_embedding_cache.capacity(capacity);
+    }
+}
+
+void EmbedderManager::clear_query_embedding_cache() {
+    std::unique_lock<std::mutex> lock(query_embedding_cache_mutex);
+    query_embedding_cache.clear();
+}
+
+void EmbedderManager::get_query_embedding_cache_stats(nlohmann::json& result) {
+    std::unique_lock<std::mutex> lock(query_embedding_cache_mutex);
+    result["num_entries"] = query_embedding_cache.size();
+    result["capacity"] = query_embedding_cache_capacity.load();
+    result["hits"] = query_embedding_cache_hits.load();
+    result["misses"] = query_embedding_cache_misses.load();
+}
+
+std::string EmbedderManager::normalize_query(const std::string& query) {
+    std::string normalized;
+    normalized.reserve(query.size());
+
+    for(const char c: query) {
+        if(std::isspace(static_cast<unsigned char>(c))) {
+            if(!normalized.empty() && normalized.back() != ' ') {
+                normalized += ' ';
+            }
+        } else {
+            normalized += c;
+        }
+    }
+
+    if(!normalized.empty() && normalized.back() == ' ') {
+        normalized.pop_back();
+    }
+
+    return normalized;
 }
 
 void EmbedderManager::delete_image_embedder(const std::string& model_path) {
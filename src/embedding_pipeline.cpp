@@ -0,0 +1,224 @@
+#include <thread>
+#include "collection_manager.h"
+#include "embedding_pipeline.h"
+#include "http_client.h"
+#include "raft_server.h"
+#include "string_utils.h"
+#include "logger.h"
+
+void EmbeddingPipeline::init(size_t concurrency, size_t num_tries) {
+    std::unique_lock lk(mutex);
+    this->concurrency = std::max<size_t>(1, concurrency);
+    this->num_tries = std::max<size_t>(1, num_tries);
+    quit = false;
+    enabled = true;
+}
+
+void EmbeddingPipeline::enqueue(uint32_t collection_id, std::vector<uint32_t>&& seq_ids,
+                                size_t remote_embedding_batch_size, size_t remote_embedding_timeout_ms) {
+    if(seq_ids.empty() || !enabled) {
+        return;
+    }
+
+    std::unique_lock lk(mutex);
+    num_pending_docs += seq_ids.size();
+
+    for(size_t i = 0; i < seq_ids.size(); i += MAX_JOB_SIZE) {
+        job_t job;
+        job.collection_id = collection_id;
+        job.seq_ids.assign(seq_ids.begin() + i, seq_ids.begin() + std::min(i + MAX_JOB_SIZE, seq_ids.size()));
+        job.remote_embedding_batch_size = remote_embedding_batch_size;
+        job.remote_embedding_timeout_ms = remote_embedding_timeout_ms;
+        jobs.push_back(std::move(job));
+    }
+
+    cv.notify_all();
+}
+
+bool EmbeddingPipeline::next_job(job_t& job) {
+    std::unique_lock lk(mutex);
+
+    while(!quit) {
+        if(!retry_jobs.empty() && retry_jobs.begin()->first <= std::chrono::steady_clock::now()) {
+            job = std::move(retry_jobs.begin()->second);
+            retry_jobs.erase(retry_jobs.begin());
+            return true;
+        }
+
+        if(!jobs.empty()) {
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            return true;
+        }
+
+        if(retry_jobs.empty()) {
+            cv.wait(lk);
+        } else {
+            cv.wait_until(lk, retry_jobs.begin()->first);
+        }
+    }
+
+    return false;
+}
+
+void EmbeddingPipeline::retry_job(job_t&& job, size_t delay_ms) {
+    const auto retry_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+
+    std::unique_lock lk(mutex);
+    retry_jobs.emplace(retry_time, std::move(job));
+    cv.notify_one();
+}
+
+void EmbeddingPipeline::process_jobs(ReplicationState* raft_server) {
+    job_t job;
+
+    while(next_job(job)) {
+        auto collection = CollectionManager::get_instance().get_collection_with_id(job.collection_id);
+        if(collection == nullptr) {
+            // collection has been dropped since
+            num_pending_docs -= job.seq_ids.size();
+            continue;
+        }
+
+        if(raft_server != nullptr && !raft_server->is_leader()) {
+            // the documents are kept until the leader's update reaches this node, in case it becomes the leader
+            const size_t num_queued_docs = job.seq_ids.size();
+            collection->remove_embedded_documents(job.seq_ids);
+            num_pending_docs -= (num_queued_docs - job.seq_ids.size());
+
+            if(!job.seq_ids.empty()) {
+                retry_job(std::move(job), FOLLOWER_RECHECK_MS);
+            }
+
+            continue;
+        }
+
+        std::vector<uint32_t> failed_seq_ids;
+        std::vector<std::pair<uint32_t, std::string>> update_docs;
+        collection->embed_documents(job.seq_ids, job.remote_embedding_batch_size, job.remote_embedding_timeout_ms,
+                                    failed_seq_ids, update_docs);
+
+        const std::string collection_name = collection->get_name();
+
+        // the collection must not be held while its write waits for the indexer
+        collection.unlock();
+
+        num_embedded_docs += write_embeddings(raft_server, collection_name, update_docs, failed_seq_ids);
+        job.num_tries++;
+
+        if(failed_seq_ids.empty() || job.num_tries >= num_tries) {
+            if(!failed_seq_ids.empty()) {
+                LOG(ERROR) << "Giving up on embedding " << failed_seq_ids.size() << " documents of collection "
+                           << collection_name << " after " << job.num_tries << " tries.";
+            }
+
+            num_failed_docs += failed_seq_ids.size();
+            num_pending_docs -= job.seq_ids.size();
+            continue;
+        }
+
+        num_pending_docs -= (job.seq_ids.size() - failed_seq_ids.size());
+        job.seq_ids = std::move(failed_seq_ids);
+
+        const size_t backoff_ms = RETRY_BACKOFF_MS << (job.num_tries - 1);
+        retry_job(std::move(job), backoff_ms);
+    }
+}
+
+size_t EmbeddingPipeline::write_embeddings(ReplicationState* raft_server, const std::string& collection_name,
+                                           const std::vector<std::pair<uint32_t, std::string>>& update_docs,
+                                           std::vector<uint32_t>& failed_seq_ids) {
+    if(update_docs.empty()) {
+        return 0;
+    }
+
+    std::vector<std::string> json_lines;
+    for(const auto& update_doc: update_docs) {
+        json_lines.push_back(update_doc.second);
+    }
+
+    if(raft_server == nullptr) {
+        auto collection = CollectionManager::get_instance().get_collection(collection_name);
+        if(collection == nullptr) {
+            return 0;
+        }
+
+        nlohmann::json document;
+        collection->add_many(json_lines, document, UPDATE, "", DIRTY_VALUES::REJECT);
+    } else {
+        const std::string leader_url = raft_server->get_leader_url();
+        if(leader_url.empty()) {
+            for(const auto& update_doc: update_docs) {
+                failed_seq_ids.push_back(update_doc.first);
+            }
+
+            return 0;
+        }
+
+        const std::string import_url = leader_url + "collections/" + collection_name +
+                                       "/documents/import?action=update&dirty_values=reject";
+        std::string import_payload = StringUtils::join(json_lines, "\n");
+        std::string res;
+        std::map<std::string, std::string> res_headers;
+
+        long status_code = HttpClient::post_response(import_url, import_payload, res, res_headers, {},
+                                                     WRITE_TIMEOUT_MS, true);
+
+        if(status_code != 200) {
+            LOG(ERROR) << "Error while writing embeddings of collection " << collection_name
+                       << ". Status code: " << status_code << ", response: " << res;
+            for(const auto& update_doc: update_docs) {
+                failed_seq_ids.push_back(update_doc.first);
+            }
+
+            return 0;
+        }
+
+        StringUtils::split(res, json_lines, "\n");
+    }
+
+    // a document that could not be updated has been removed or changed since
+    size_t num_embedded = 0;
+    for(const auto& json_line: json_lines) {
+        auto res = nlohmann::json::parse(json_line, nullptr, false);
+        if(!res.is_discarded() && res.value("success", false)) {
+            num_embedded++;
+        } else {
+            LOG(ERROR) << "Could not update document of collection " << collection_name << " with its embeddings: "
+                       << json_line;
+        }
+    }
+
+    return num_embedded;
+}
+
+void EmbeddingPipeline::run(ReplicationState* raft_server) {
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < concurrency; i++) {
+        workers.emplace_back([this, raft_server]() {
+            process_jobs(raft_server);
+        });
+    }
+
+    for(auto& worker: workers) {
+        worker.join();
+    }
+
+    std::unique_lock lk(mutex);
+    jobs.clear();
+    retry_jobs.clear();
+    num_pending_docs = 0;
+}
+
+void EmbeddingPipeline::stop() {
+    std::unique_lock lk(mutex);
+    enabled = false;
+    quit = true;
+    cv.notify_all();
+}
+
+void EmbeddingPipeline::get_stats(nlohmann::json& stats) const {
+    stats["pending_documents"] = num_pending_docs.load();
+    stats["embedded_documents"] = num_embedded_docs.load();
+    stats["failed_documents"] = num_failed_docs.load();
+}
@@ -347,10 +347,19 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
             return Option<bool>(400, "Property `" + fields::hnsw_params + ".M` must be a positive integer.");
         }
 
+        if(field_json[fields::hnsw_params].count("quantization") != 0 &&
+           (!field_json[fields::hnsw_params]["quantization"].is_string() ||
+            !magic_enum::enum_cast<vector_quantization_t>(
+                    field_json[fields::hnsw_params]["quantization"].get<std::string>()).has_value())) {
+            return Option<bool>(400, "Property `" + fields::hnsw_params + ".quantization` must be one of "
+                                     "`none`, `float16` or `int8`.");
+        }
+
         // remove unrelated properties except for m ef_construction and M
         auto it = field_json[fields::hnsw_params].begin();
         while(it != field_json[fields::hnsw_params].end()) {
-            if(it.key() != "max_elements" && it.key() != "ef_construction" && it.key() != "M" && it.key() != "ef") {
+            if(it.key() != "max_elements" && it.key() != "ef_construction" && it.key() != "M" && it.key() != "ef" &&
+               it.key() != "quantization") {
                 it = field_json[fields::hnsw_params].erase(it);
             } else {
                 ++it;
@@ -371,6 +380,45 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
                                         })"_json;
     }
 
+    if(field_json.count(fields::ivf_params) != 0) {
+        auto& ivf_params = field_json[fields::ivf_params];
+        if(!ivf_params.is_object()) {
+            return Option<bool>(400, "Property `" + fields::ivf_params + "` must be an object.");
+        }
+
+        for(const std::string& param: {"nlist", "nprobe"}) {
+            if(ivf_params.count(param) != 0 && (!ivf_params[param].is_number_unsigned() || ivf_params[param] == 0)) {
+                return Option<bool>(400, "Property `" + fields::ivf_params + "." + param + "` must be a positive integer.");
+            }
+        }
+
+        if(ivf_params.count("pq_m") != 0) {
+            const size_t num_dim = field_json.value(fields::num_dim, size_t(0));
+            if(!ivf_params["pq_m"].is_number_unsigned() ||
+               (num_dim != 0 && ivf_params["pq_m"].get<size_t>() != 0 && num_dim % ivf_params["pq_m"].get<size_t>() != 0)) {
+                return Option<bool>(400, "Property `" + fields::ivf_params + ".pq_m` must be a non-negative integer "
+                                         "that divides `" + fields::num_dim + "`.");
+            }
+        }
+
+        if(hnsw_index_t::get_quantization(field_json[fields::hnsw_params]) != vector_quantization_t::none) {
+            return Option<bool>(400, "Property `" + fields::ivf_params + "` cannot be combined with "
+                                     "`" + fields::hnsw_params + ".quantization`.");
+        }
+
+        if(ivf_params.count("nlist") == 0) {
+            ivf_params["nlist"] = hnsw_index_t::DEFAULT_IVF_NLIST;
+        }
+
+        if(ivf_params.count("nprobe") == 0) {
+            ivf_params["nprobe"] = hnsw_index_t::DEFAULT_IVF_NPROBE;
+        }
+
+        if(ivf_params.count("pq_m") == 0) {
+            ivf_params["pq_m"] = 0;
+        }
+    }
+
     if(field_json.count(fields::optional) == 0) {
         // dynamic type fields are always optional
         bool is_dynamic = field::is_dynamic(field_json[fields::name], field_json[fields::type]);
@@ -427,6 +475,10 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
                   field_json[fields::async_reference])
     );
 
+    if(field_json.count(fields::ivf_params) != 0) {
+        the_fields.back().ivf_params = field_json[fields::ivf_params];
+    }
+
     if (!field_json[fields::reference].get<std::string>().empty()) {
         // Add a reference helper field in the schema. It stores the doc id of the document it references to reduce the
         // computation while searching.
@@ -821,6 +873,15 @@ Option<bool> field::fields_to_json_fields(const std::vector<field>& fields, cons
         if(field.num_dim > 0) {
             field_val[fields::num_dim] = field.num_dim;
             field_val[fields::vec_dist] = field.vec_dist == ip ? "ip" : "cosine";
+
+            // default params are not persisted, so that they are applied again on load
+            if(field.hnsw_params.is_object() && field.hnsw_params != R"({"M": 16, "ef_construction": 200})"_json) {
+                field_val[fields::hnsw_params] = field.hnsw_params;
+            }
+
+            if(!field.ivf_params.empty()) {
+                field_val[fields::ivf_params] = field.ivf_params;
+            }
         }
 
         if (!field.reference.empty()) {
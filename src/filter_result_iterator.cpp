@@ -2703,7 +2703,8 @@ bool filter_result_iterator_t::is_timed_out(const bool& override_function_call_c
     }
 
     if (override_function_call_counter || ++(timeout_info->function_call_counter) % function_call_modulo == 0) {
-        if ((std::chrono::duration_cast<std::chrono::microseconds>(
+        if ((timeout_info->client_alive != nullptr && !timeout_info->client_alive->load(std::memory_order_relaxed)) ||
+            (std::chrono::duration_cast<std::chrono::microseconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count() - timeout_info->search_begin_us) > timeout_info->search_stop_us) {
             validity = timed_out;
             return true;
@@ -2716,4 +2717,5 @@ bool filter_result_iterator_t::is_timed_out(const bool& override_function_call_c
 filter_result_iterator_timeout_info::filter_result_iterator_timeout_info(uint64_t search_begin,
                                                                          uint64_t search_stop) :
                                                                          search_begin_us(search_begin),
-                                                                         search_stop_us(search_stop) {}
+                                                                         search_stop_us(search_stop),
+                                                                         client_alive(search_client_alive) {}
@@ -0,0 +1,530 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "hnsw_index.h"
+#include "magic_enum.hpp"
+
+namespace {
+    std::array<float, 1 << 16> build_float16_table() {
+        std::array<float, 1 << 16> table{};
+        for(size_t code = 0; code < table.size(); code++) {
+            table[code] = Float16InnerProductSpace::decode(code);
+        }
+        return table;
+    }
+
+    // decoding through a table is cheaper than bit twiddling in the distance function
+    const std::array<float, 1 << 16> float16_table = build_float16_table();
+}
+
+float Float16InnerProductSpace::distance(const void* a, const void* b, const void* param) {
+    const size_t dim = *((const size_t*) param);
+    const uint16_t* x = (const uint16_t*) a;
+    const uint16_t* y = (const uint16_t*) b;
+
+    float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    size_t i = 0;
+
+    for(; i + 4 <= dim; i += 4) {
+        sums[0] += float16_table[x[i]] * float16_table[y[i]];
+        sums[1] += float16_table[x[i + 1]] * float16_table[y[i + 1]];
+        sums[2] += float16_table[x[i + 2]] * float16_table[y[i + 2]];
+        sums[3] += float16_table[x[i + 3]] * float16_table[y[i + 3]];
+    }
+
+    for(; i < dim; i++) {
+        sums[0] += float16_table[x[i]] * float16_table[y[i]];
+    }
+
+    return 1.0f - ((sums[0] + sums[1]) + (sums[2] + sums[3]));
+}
+
+uint16_t Float16InnerProductSpace::encode(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint16_t sign = (bits >> 16) & 0x8000;
+    const uint32_t float_exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if(float_exponent == 0xff) {
+        // infinity or NaN
+        return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+    }
+
+    const int32_t exponent = int32_t(float_exponent) - 127 + 15;
+
+    if(exponent >= 31) {
+        return sign | 0x7c00;
+    }
+
+    if(exponent <= 0) {
+        if(exponent < -10) {
+            return sign;
+        }
+
+        // subnormal half: make the implicit leading bit explicit and shift it into place
+        mantissa |= 0x800000;
+        const uint32_t shift = 14 - exponent;
+        uint32_t half_mantissa = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+
+        if(remainder > halfway || (remainder == halfway && (half_mantissa & 1))) {
+            half_mantissa++;
+        }
+
+        return sign | half_mantissa;
+    }
+
+    // round to nearest even: a carry out of the mantissa correctly bumps the exponent
+    uint16_t half = sign | (exponent << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1fff;
+
+    if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+
+    return half;
+}
+
+float Float16InnerProductSpace::decode(uint16_t code) {
+    const uint32_t sign = uint32_t(code & 0x8000) << 16;
+    int32_t exponent = (code >> 10) & 0x1f;
+    uint32_t mantissa = code & 0x3ff;
+    uint32_t bits;
+
+    if(exponent == 0) {
+        if(mantissa == 0) {
+            bits = sign;
+        } else {
+            // subnormal half is a normal float
+            exponent = 1;
+            while((mantissa & 0x400) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+
+            mantissa &= 0x3ff;
+            bits = sign | (uint32_t(exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+    } else if(exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | (uint32_t(exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+Int8InnerProductSpace::Int8InnerProductSpace(size_t dim): scales(dim, 1.0f / 127), sq_scales(dim, 1.0f / (127 * 127)) {
+    params.dim = dim;
+    params.sq_scales = sq_scales.data();
+}
+
+void Int8InnerProductSpace::set_scales(const std::vector<float>& max_abs_values) {
+    for(size_t i = 0; i < params.dim; i++) {
+        scales[i] = (max_abs_values[i] > 0) ? (max_abs_values[i] / 127) : (1.0f / 127);
+        sq_scales[i] = scales[i] * scales[i];
+    }
+}
+
+void Int8InnerProductSpace::encode(const float* values, int8_t* codes) const {
+    for(size_t i = 0; i < params.dim; i++) {
+        // values beyond the range seen during training are clamped
+        const float code = std::round(values[i] / scales[i]);
+        codes[i] = int8_t(std::max(-127.0f, std::min(127.0f, code)));
+    }
+}
+
+void Int8InnerProductSpace::decode(const int8_t* codes, float* values) const {
+    for(size_t i = 0; i < params.dim; i++) {
+        values[i] = codes[i] * scales[i];
+    }
+}
+
+void Int8InnerProductSpace::restore_scales(const std::vector<float>& saved_scales) {
+    for(size_t i = 0; i < params.dim; i++) {
+        scales[i] = saved_scales[i];
+        sq_scales[i] = scales[i] * scales[i];
+    }
+}
+
+float Int8InnerProductSpace::distance(const void* a, const void* b, const void* param) {
+    const params_t* space_params = (const params_t*) param;
+    const size_t dim = space_params->dim;
+    const float* sq_scales = space_params->sq_scales;
+    const int8_t* x = (const int8_t*) a;
+    const int8_t* y = (const int8_t*) b;
+
+    float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    size_t i = 0;
+
+    for(; i + 4 <= dim; i += 4) {
+        sums[0] += sq_scales[i] * float(int32_t(x[i]) * y[i]);
+        sums[1] += sq_scales[i + 1] * float(int32_t(x[i + 1]) * y[i + 1]);
+        sums[2] += sq_scales[i + 2] * float(int32_t(x[i + 2]) * y[i + 2]);
+        sums[3] += sq_scales[i + 3] * float(int32_t(x[i + 3]) * y[i + 3]);
+    }
+
+    for(; i < dim; i++) {
+        sums[0] += sq_scales[i] * float(int32_t(x[i]) * y[i]);
+    }
+
+    return 1.0f - ((sums[0] + sums[1]) + (sums[2] + sums[3]));
+}
+
+hnsw_index_t::hnsw_index_t(size_t num_dim, size_t init_size, vector_distance_type_t distance_type, size_t M,
+                           size_t ef_construction, vector_quantization_t quantization, const nlohmann::json& ivf_params) :
+        space(new FloatInnerProductSpace(num_dim)), num_dim(num_dim), distance_type(distance_type),
+        quantization(quantization), trained(quantization != vector_quantization_t::int8) {
+
+    if(ivf_params.is_object() && !ivf_params.empty()) {
+        const size_t nlist = ivf_params.value("nlist", DEFAULT_IVF_NLIST);
+        ivf = new ivf_index_t(num_dim, nlist, ivf_params.value("pq_m", size_t(0)));
+        ivf_nprobe = ivf_params.value("nprobe", DEFAULT_IVF_NPROBE);
+        training_size = std::max(QUANTIZATION_TRAINING_SIZE, nlist * IVF_TRAINING_SIZE_PER_LIST);
+
+        // vectors in partitions are not quantized by the graph's space
+        this->quantization = vector_quantization_t::none;
+        trained = false;
+    }
+
+    switch(quantization) {
+        case vector_quantization_t::float16:
+            graph_space = new Float16InnerProductSpace(num_dim);
+            break;
+        case vector_quantization_t::int8:
+            graph_space = new Int8InnerProductSpace(num_dim);
+            break;
+        default:
+            graph_space = space;
+            break;
+    }
+
+    vecdex = new hnswlib::HierarchicalNSW<float>(graph_space, init_size, M, ef_construction, 100, true);
+}
+
+hnsw_index_t::~hnsw_index_t() {
+    std::lock_guard lk(repair_m);
+    delete vecdex;
+    delete ivf;
+
+    if(graph_space != space) {
+        delete graph_space;
+    }
+
+    delete space;
+}
+
+void hnsw_index_t::encode(const std::vector<float>& values, std::vector<uint8_t>& codes) const {
+    codes.resize(graph_space->get_data_size());
+
+    if(quantization == vector_quantization_t::float16) {
+        uint16_t* half_codes = (uint16_t*) codes.data();
+        for(size_t i = 0; i < num_dim; i++) {
+            half_codes[i] = Float16InnerProductSpace::encode(values[i]);
+        }
+    } else if(quantization == vector_quantization_t::int8) {
+        static_cast<Int8InnerProductSpace*>(graph_space)->encode(values.data(), (int8_t*) codes.data());
+    }
+}
+
+void hnsw_index_t::train() {
+    if(ivf != nullptr) {
+        std::vector<float> points;
+        points.reserve(training_points.size() * num_dim);
+        for(const auto& point: training_points) {
+            points.insert(points.end(), point.second.begin(), point.second.end());
+        }
+
+        ivf->train(points.data(), training_points.size());
+
+        for(const auto& point: training_points) {
+            ivf->add_point(point.second.data(), point.first);
+        }
+
+        training_points.clear();
+        trained = true;
+        return;
+    }
+
+    std::vector<float> max_abs_values(num_dim, 0.0f);
+
+    for(const auto& point: training_points) {
+        for(size_t i = 0; i < num_dim; i++) {
+            max_abs_values[i] = std::max(max_abs_values[i], std::abs(point.second[i]));
+        }
+    }
+
+    static_cast<Int8InnerProductSpace*>(graph_space)->set_scales(max_abs_values);
+
+    // capacity was reserved only for points that went directly into the graph
+    vecdex->resizeIndex(vecdex->getMaxElements() + training_points.size());
+
+    std::vector<uint8_t> codes;
+    for(const auto& point: training_points) {
+        encode(point.second, codes);
+        vecdex->addPoint(codes.data(), point.first, true);
+    }
+
+    training_points.clear();
+    trained = true;
+}
+
+void hnsw_index_t::add_point(const std::vector<float>& values, size_t label) {
+    if(restoring) {
+        std::unique_lock lock(restore_m);
+        if(restoring) {
+            restored_labels.insert(label);
+
+            // the graph can be saved after the document was updated, so the vector in the graph must match too
+            std::vector<uint8_t> codes;
+            if(quantization != vector_quantization_t::none && trained) {
+                encode(values, codes);
+            }
+
+            if(contains(label, codes.empty() ? static_cast<const void*>(values.data()) : codes.data())) {
+                return;
+            }
+        }
+    }
+
+    if(!trained) {
+        std::unique_lock lock(training_m);
+        if(!trained) {
+            training_points[label] = values;
+            if(training_points.size() >= training_size) {
+                train();
+            }
+
+            return;
+        }
+    }
+
+    if(ivf != nullptr) {
+        ivf->add_point(values.data(), label);
+        return;
+    }
+
+    if(quantization == vector_quantization_t::none) {
+        vecdex->addPoint(values.data(), label, true);
+        return;
+    }
+
+    std::vector<uint8_t> codes;
+    encode(values, codes);
+    vecdex->addPoint(codes.data(), label, true);
+}
+
+void hnsw_index_t::remove_point(size_t label) {
+    if(!trained) {
+        std::unique_lock lock(training_m);
+        if(!trained) {
+            training_points.erase(label);
+            return;
+        }
+    }
+
+    if(ivf != nullptr) {
+        ivf->remove_point(label);
+        return;
+    }
+
+    vecdex->markDelete(label);
+}
+
+std::vector<float> hnsw_index_t::get_point(size_t label) {
+    if(!trained) {
+        std::shared_lock lock(training_m);
+        if(!trained) {
+            auto it = training_points.find(label);
+            if(it == training_points.end()) {
+                throw std::runtime_error("Label not found");
+            }
+
+            return it->second;
+        }
+    }
+
+    if(ivf != nullptr) {
+        return ivf->get_point(label);
+    }
+
+    if(quantization == vector_quantization_t::float16) {
+        const auto& codes = vecdex->getDataByLabel<uint16_t>(label);
+        std::vector<float> values(num_dim);
+        for(size_t i = 0; i < num_dim; i++) {
+            values[i] = float16_table[codes[i]];
+        }
+        return values;
+    }
+
+    if(quantization == vector_quantization_t::int8) {
+        const auto& codes = vecdex->getDataByLabel<int8_t>(label);
+        std::vector<float> values(num_dim);
+        static_cast<Int8InnerProductSpace*>(graph_space)->decode(codes.data(), values.data());
+        return values;
+    }
+
+    return vecdex->getDataByLabel<float>(label);
+}
+
+std::vector<std::pair<float, size_t>> hnsw_index_t::search_knn(const std::vector<float>& query, size_t k, size_t ef,
+                                                               hnswlib::BaseFilterFunctor* filter, size_t nprobe,
+                                                               ThreadPool* thread_pool) {
+    if(!trained) {
+        std::shared_lock lock(training_m);
+        if(!trained) {
+            std::vector<std::pair<float, size_t>> dist_labels;
+            const auto dist_func = space->get_dist_func();
+
+            for(const auto& point: training_points) {
+                if(filter != nullptr && !(*filter)(point.first)) {
+                    continue;
+                }
+
+                const float dist = dist_func(query.data(), point.second.data(), space->get_dist_func_param());
+                dist_labels.emplace_back(dist, point.first);
+            }
+
+            std::sort(dist_labels.begin(), dist_labels.end());
+            if(dist_labels.size() > k) {
+                dist_labels.resize(k);
+            }
+
+            return dist_labels;
+        }
+    }
+
+    if(ivf != nullptr) {
+        return ivf->search_knn(query.data(), k, (nprobe == 0) ? ivf_nprobe : nprobe, filter, thread_pool);
+    }
+
+    if(quantization == vector_quantization_t::none) {
+        return vecdex->searchKnnCloserFirst(query.data(), k, ef, filter);
+    }
+
+    std::vector<uint8_t> codes;
+    encode(query, codes);
+    return vecdex->searchKnnCloserFirst(codes.data(), k, ef, filter);
+}
+
+vector_quantization_t hnsw_index_t::get_quantization(const nlohmann::json& hnsw_params) {
+    if(!hnsw_params.is_object() || hnsw_params.count("quantization") == 0 || !hnsw_params["quantization"].is_string()) {
+        return vector_quantization_t::none;
+    }
+
+    auto quantization_op = magic_enum::enum_cast<vector_quantization_t>(hnsw_params["quantization"].get<std::string>());
+    return quantization_op.has_value() ? quantization_op.value() : vector_quantization_t::none;
+}
+
+bool hnsw_index_t::contains(size_t label, const void* data) {
+    if(ivf != nullptr) {
+        return ivf->contains(label);
+    }
+
+    std::unique_lock lock(vecdex->label_lookup_lock);
+    auto it = vecdex->label_lookup_.find(label);
+    return it != vecdex->label_lookup_.end() && !vecdex->isMarkedDeleted(it->second) &&
+           std::memcmp(vecdex->getDataByInternalId(it->second), data, vecdex->data_size_) == 0;
+}
+
+Option<bool> hnsw_index_t::save(const std::string& file_path, nlohmann::json& meta) {
+    if(ivf != nullptr) {
+        return Option<bool>(400, "Saving of IVF indexes is not supported.");
+    }
+
+    std::shared_lock lock(training_m);
+
+    if(!trained) {
+        return Option<bool>(400, "Quantization is not trained yet.");
+    }
+
+    try {
+        vecdex->saveIndex(file_path);
+    } catch(const std::exception& e) {
+        return Option<bool>(500, e.what());
+    }
+
+    meta["num_dim"] = num_dim;
+    meta["quantization"] = magic_enum::enum_name(quantization);
+
+    if(quantization == vector_quantization_t::int8) {
+        meta["scales"] = static_cast<Int8InnerProductSpace*>(graph_space)->get_scales();
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> hnsw_index_t::load(const std::string& file_path, const nlohmann::json& meta) {
+    if(ivf != nullptr || !meta.is_object() || meta.value("num_dim", size_t(0)) != num_dim ||
+       meta.value("quantization", std::string()) != magic_enum::enum_name(quantization)) {
+        return Option<bool>(400, "Saved index does not match the field.");
+    }
+
+    std::vector<float> scales;
+    if(quantization == vector_quantization_t::int8) {
+        if(meta.count("scales") == 0 || !meta["scales"].is_array() || meta["scales"].size() != num_dim) {
+            return Option<bool>(400, "Saved index does not have quantization scales.");
+        }
+
+        scales = meta["scales"].get<std::vector<float>>();
+    }
+
+    hnswlib::HierarchicalNSW<float>* loaded_vecdex = nullptr;
+
+    try {
+        loaded_vecdex = new hnswlib::HierarchicalNSW<float>(graph_space, file_path, false, 0, true);
+    } catch(const std::exception& e) {
+        return Option<bool>(500, e.what());
+    }
+
+    std::unique_lock lock(training_m);
+    std::lock_guard repair_lock(repair_m);
+
+    if(quantization == vector_quantization_t::int8) {
+        static_cast<Int8InnerProductSpace*>(graph_space)->restore_scales(scales);
+        training_points.clear();
+        trained = true;
+    }
+
+    delete vecdex;
+    vecdex = loaded_vecdex;
+
+    std::unique_lock restore_lock(restore_m);
+    restored_labels.clear();
+    restoring = true;
+
+    return Option<bool>(true);
+}
+
+size_t hnsw_index_t::finish_restore() {
+    std::unique_lock lock(restore_m);
+
+    if(!restoring) {
+        return 0;
+    }
+
+    std::vector<size_t> removed_labels;
+
+    {
+        std::unique_lock lookup_lock(vecdex->label_lookup_lock);
+        for(const auto& label_id: vecdex->label_lookup_) {
+            if(restored_labels.count(label_id.first) == 0 && !vecdex->isMarkedDeleted(label_id.second)) {
+                removed_labels.push_back(label_id.first);
+            }
+        }
+    }
+
+    for(const auto label: removed_labels) {
+        vecdex->markDelete(label);
+    }
+
+    restored_labels.clear();
+    restoring = false;
+
+    return removed_labels.size();
+}
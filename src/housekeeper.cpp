@@ -27,7 +27,9 @@ void HouseKeeper::run() {
         if(Config::get_instance().get_db_compaction_interval() > 0) {
             if(now_ts_seconds - prev_db_compaction_s >= Config::get_instance().get_db_compaction_interval()) {
                 LOG(INFO) << "Starting DB compaction.";
-                CollectionManager::get_instance().get_store()->compact_all();
+                run_in_background([]() {
+                    CollectionManager::get_instance().get_store()->compact_all();
+                });
                 LOG(INFO) << "Finished DB compaction.";
                 prev_db_compaction_s = std::chrono::duration_cast<std::chrono::seconds>(
                         std::chrono::system_clock::now().time_since_epoch()).count();
@@ -55,9 +57,32 @@ void HouseKeeper::run() {
                     std::chrono::system_clock::now().time_since_epoch()).count();
         }*/
 
+        if(Config::get_instance().get_enable_lazy_deletes()) {
+            // documents that were deleted lazily are removed from the in-memory indices in small batches
+            run_in_background([]() {
+                auto coll_names = CollectionManager::get_instance().get_collection_names();
+                size_t num_purged = 0;
+
+                for(auto& coll_name: coll_names) {
+                    auto coll = CollectionManager::get_instance().get_collection(coll_name);
+                    if(coll == nullptr) {
+                        continue;
+                    }
+
+                    num_purged += coll->purge_tombstones();
+                }
+
+                if(num_purged != 0) {
+                    LOG(INFO) << "Purged " << num_purged << " deleted documents from the in-memory indices.";
+                }
+            });
+        }
+
         if (now_ts_seconds - prev_remove_expired_keys_s >= remove_expired_keys_interval_s) {
             // Do housekeeping for authmanager
-            CollectionManager::get_instance().getAuthManager().do_housekeeping();
+            run_in_background([]() {
+                CollectionManager::get_instance().getAuthManager().do_housekeeping();
+            });
 
             prev_remove_expired_keys_s = std::chrono::duration_cast<std::chrono::seconds>(
                     std::chrono::system_clock::now().time_since_epoch()).count();
@@ -67,6 +92,17 @@ void HouseKeeper::run() {
     }
 }
 
+void HouseKeeper::run_in_background(const std::function<void()>& job) {
+    // housekeeping jobs are run on the low priority background pool so that they don't compete with searches
+    ThreadPool* background_thread_pool = CollectionManager::get_instance().get_background_thread_pool();
+    if(background_thread_pool == nullptr) {
+        job();
+        return;
+    }
+
+    background_thread_pool->enqueue(job).wait();
+}
+
 void HouseKeeper::stop() {
     quit = true;
     cv.notify_all();
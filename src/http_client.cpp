@@ -6,6 +6,30 @@
 
 std::string HttpClient::api_key = "";
 std::string HttpClient::ca_cert_path = "";
+std::mutex HttpClient::idle_handles_mutex;
+std::unordered_map<std::string, std::vector<CURL*>> HttpClient::idle_handles;
+
+struct curl_share_t {
+    CURLSH* share;
+    std::mutex mutexes[CURL_LOCK_DATA_LAST];
+
+    curl_share_t() {
+        share = curl_share_init();
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    static void lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr) {
+        static_cast<curl_share_t*>(userptr)->mutexes[data].lock();
+    }
+
+    static void unlock(CURL* handle, curl_lock_data data, void* userptr) {
+        static_cast<curl_share_t*>(userptr)->mutexes[data].unlock();
+    }
+};
 
 struct client_state_t: public req_state_t {
     CURL* curl;
@@ -199,6 +223,7 @@ long HttpClient::perform_curl(CURL *curl, std::map<std::string, std::string>& re
             status_code = 500;
         }
 
+        // the connection could be in a bad state, so the handle is not reused
         curl_easy_cleanup(curl);
         curl_slist_free_all(chunk);
 
@@ -210,7 +235,7 @@ long HttpClient::perform_curl(CURL *curl, std::map<std::string, std::string>& re
 
     extract_response_headers(curl, res_headers);
 
-    curl_easy_cleanup(curl);
+    release_handle(curl);
     curl_slist_free_all(chunk);
 
     return http_code == 0 ? 500 : http_code;
@@ -447,8 +472,64 @@ CURL *HttpClient::init_curl_async(const std::string& url, deferred_req_res_t* re
     return curl;
 }
 
+CURLSH* HttpClient::get_share() {
+    static curl_share_t* share = new curl_share_t();
+    return share->share;
+}
+
+std::string HttpClient::get_host_key(const std::string& url) {
+    const size_t scheme_end = url.find("://");
+    const size_t host_begin = (scheme_end == std::string::npos) ? 0 : scheme_end + 3;
+    const size_t host_end = url.find_first_of("/?#", host_begin);
+    return url.substr(0, host_end);
+}
+
+CURL* HttpClient::acquire_handle(const std::string& url) {
+    {
+        std::lock_guard<std::mutex> lock(idle_handles_mutex);
+        auto handles_it = idle_handles.find(get_host_key(url));
+        if(handles_it != idle_handles.end() && !handles_it->second.empty()) {
+            CURL* curl = handles_it->second.back();
+            handles_it->second.pop_back();
+            return curl;
+        }
+    }
+
+    return curl_easy_init();
+}
+
+void HttpClient::release_handle(CURL* curl) {
+    char* url = nullptr;
+    curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &url);
+    const std::string host_key = (url == nullptr) ? "" : get_host_key(url);
+
+    // clears the options, which point to the data of the finished request, but keeps the live connection
+    curl_easy_reset(curl);
+
+    if(!host_key.empty()) {
+        std::lock_guard<std::mutex> lock(idle_handles_mutex);
+        auto& handles = idle_handles[host_key];
+        if(handles.size() < MAX_IDLE_HANDLES_PER_HOST) {
+            handles.push_back(curl);
+            return;
+        }
+    }
+
+    curl_easy_cleanup(curl);
+}
+
+size_t HttpClient::get_num_idle_handles() {
+    std::lock_guard<std::mutex> lock(idle_handles_mutex);
+    size_t num_idle_handles = 0;
+    for(const auto& host_handles: idle_handles) {
+        num_idle_handles += host_handles.second.size();
+    }
+
+    return num_idle_handles;
+}
+
 CURL *HttpClient::init_curl(const std::string& url, std::string& response, const size_t timeout_ms) {
-    CURL *curl = curl_easy_init();
+    CURL *curl = acquire_handle(url);
 
     if(curl == nullptr) {
         nlohmann::json res;
@@ -467,6 +548,8 @@ CURL *HttpClient::init_curl(const std::string& url, std::string& response, const
     curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 4000);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
     curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
+    curl_easy_setopt(curl, CURLOPT_SHARE, get_share());
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
 
     // to allow self-signed certs
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
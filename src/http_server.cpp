@@ -415,6 +415,15 @@ int HttpServer::catch_all_handler(h2o_handler_t *_h2o_handler, h2o_req_t *req) {
         query_map[http_req::USER_HEADER] = client_ip;
     }
 
+    // searches are abandoned once the client supplied deadline elapses
+    ssize_t deadline_header_cursor = h2o_find_header_by_str(&req->headers, http_req::DEADLINE_HEADER,
+                                                            strlen(http_req::DEADLINE_HEADER), -1);
+
+    if(deadline_header_cursor != -1) {
+        h2o_iovec_t & slot = req->headers.entries[deadline_header_cursor].value;
+        query_map[http_req::DEADLINE_HEADER] = std::string(slot.base, slot.len);
+    }
+
     route_path *rpath = nullptr;
     uint64_t route_hash = h2o_handler->http_server->find_route(path_parts, http_method, &rpath);
 
@@ -429,7 +438,7 @@ int HttpServer::catch_all_handler(h2o_handler_t *_h2o_handler, h2o_req_t *req) {
     bool needs_readiness_check = (root_resource == "collections") ||
          !(
              root_resource == "health" || root_resource == "debug" || root_resource == "proxy" ||
-             root_resource == "stats.json" || root_resource == "metrics.json" ||
+             root_resource == "stats.json" || root_resource == "metrics.json" || root_resource == "metrics" ||
              root_resource == "sequence" || root_resource == "operations" ||
              root_resource == "config" || root_resource == "status"
          );
@@ -1140,6 +1149,10 @@ int64_t HttpServer::get_num_queued_writes() {
     return replication_state->get_num_queued_writes();
 }
 
+void HttpServer::get_write_queue_stats(nlohmann::json& stats) {
+    replication_state->get_write_queue_stats(stats);
+}
+
 bool HttpServer::is_leader() const {
     return replication_state->is_leader();
 }
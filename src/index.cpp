@@ -24,21 +24,19 @@
 #include "logger.h"
 #include "validator.h"
 #include <collection_manager.h>
+#include "tsconfig.h"
 
-#define RETURN_CIRCUIT_BREAKER if((std::chrono::duration_cast<std::chrono::microseconds>( \
-                  std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) { \
+#define RETURN_CIRCUIT_BREAKER if(should_stop_search()) { \
                     search_cutoff = true; \
                     return ;\
             }
 
-#define RETURN_CIRCUIT_BREAKER_OP if((std::chrono::duration_cast<std::chrono::microseconds>( \
-                  std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) { \
+#define RETURN_CIRCUIT_BREAKER_OP if(should_stop_search()) { \
                     search_cutoff = true; \
                     return Option<bool>(true);\
             }
 
-#define BREAK_CIRCUIT_BREAKER if((std::chrono::duration_cast<std::chrono::microseconds>( \
-                 std::chrono::system_clock::now().time_since_epoch()).count() - search_begin_us) > search_stop_us) { \
+#define BREAK_CIRCUIT_BREAKER if(should_stop_search()) { \
                     search_cutoff = true; \
                     break;\
                 }
@@ -52,11 +50,31 @@ spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::str_sentinel_value;
 spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::vector_distance_sentinel_value;
 spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::vector_query_sentinel_value;
 
+// Nearest neighbours found by the vector leg of a hybrid search.
+struct hybrid_vector_leg_t {
+    Option<bool> status = Option<bool>(true);
+    std::vector<std::pair<float, size_t>> dist_labels;
+    vector_search_strategy_t strategy = vector_search_strategy_t::none;
+    bool timed_out = false;
+};
+
+// The vector leg reads the index, so it must be finished before the search releases the index lock on any return.
+struct hybrid_vector_leg_guard_t {
+    std::shared_ptr<pooled_task_t<hybrid_vector_leg_t>> task;
+
+    ~hybrid_vector_leg_guard_t() {
+        if(task != nullptr) {
+            task->cancel();
+        }
+    }
+};
+
 Index::Index(const std::string& name, const uint32_t collection_id, const Store* store,
-             SynonymIndex* synonym_index, ThreadPool* thread_pool,
+             SynonymIndex* synonym_index, ThreadPool* thread_pool, ThreadPool* index_thread_pool,
              const tsl::htrie_map<char, field> & search_schema,
              const std::vector<char>& symbols_to_index, const std::vector<char>& token_separators):
         name(name), collection_id(collection_id), store(store), synonym_index(synonym_index), thread_pool(thread_pool),
+        index_thread_pool(index_thread_pool),
         search_schema(search_schema),
         seq_ids(new id_list_t(256)), symbols_to_index(symbols_to_index), token_separators(token_separators) {
 
@@ -68,7 +86,9 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
         }
 
         if(a_field.num_dim > 0) {
-            auto hnsw_index = new hnsw_index_t(a_field.num_dim, 16, a_field.vec_dist, a_field.hnsw_params["M"].get<uint32_t>(), a_field.hnsw_params["ef_construction"].get<uint32_t>());
+            auto hnsw_index = new hnsw_index_t(a_field.num_dim, 16, a_field.vec_dist, a_field.hnsw_params["M"].get<uint32_t>(),
+                                               a_field.hnsw_params["ef_construction"].get<uint32_t>(),
+                                               hnsw_index_t::get_quantization(a_field.hnsw_params), a_field.ivf_params);
             vector_index.emplace(a_field.name, hnsw_index);
             continue;
         }
@@ -451,7 +471,8 @@ void Index::validate_and_preprocess(Index *index,
                                     const std::vector<char>& token_separators,
                                     const std::vector<char>& symbols_to_index,
                                     const bool do_validation, const size_t remote_embedding_batch_size,
-                                    const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries, const bool generate_embeddings) {
+                                    const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries, const bool generate_embeddings,
+                                    const bool defer_embeddings) {
 
     // runs in a partitioned thread
     std::vector<index_record*> records_to_embed;
@@ -499,18 +520,13 @@ void Index::validate_and_preprocess(Index *index,
                     LOG(INFO) << "index_rec.del_doc: " << index_rec.del_doc;
                 }*/
 
+                // only the changed values are left in the document, so an update that leaves every source field of
+                // the embeddings untouched is not embedded again
                 if(generate_embeddings) {
-                    for(auto& field: index_rec.doc.items()) {
-                        for(auto& embedding_field : embedding_fields) {
-                            if(!embedding_field.embed[fields::from].is_null()) {
-                                auto embed_from_vector = embedding_field.embed[fields::from].get<std::vector<std::string>>();
-                                for(auto& embed_from: embed_from_vector) {
-                                    if(embed_from == field.key()) {
-                                        records_to_embed.push_back(&index_rec);
-                                        break;
-                                    }
-                                }
-                            }
+                    for(const auto& embedding_field: embedding_fields) {
+                        if(embedding_source_changed(embedding_field, index_rec.doc)) {
+                            records_to_embed.push_back(&index_rec);
+                            break;
                         }
                     }
                 }
@@ -548,7 +564,8 @@ void Index::validate_and_preprocess(Index *index,
         }
     }
 
-    if(generate_embeddings) {
+    // deferred embeddings are validated here, but are generated by the embedding pipeline once the batch is written
+    if(generate_embeddings && !defer_embeddings) {
         batch_embed_fields(records_to_embed, embedding_fields, search_schema, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries);
     }
 }
@@ -567,13 +584,17 @@ batch_memory_index(Index *index,
                  const bool generate_embeddings,
                  const bool use_addition_fields, const tsl::htrie_map<char, field>& addition_fields,
                  const std::string& collection_name,
-                 const spp::sparse_hash_map<std::string, std::vector<reference_pair_t>>& async_referenced_ins) {
-    const size_t concurrency = 4;
-    const size_t num_threads = std::min(concurrency, iter_batch.size());
-    const size_t window_size = (num_threads == 0) ? 0 :
-                               (iter_batch.size() + num_threads - 1) / num_threads;  // rounds up
+                 const spp::sparse_hash_map<std::string, std::vector<reference_pair_t>>& async_referenced_ins,
+                 const bool defer_embeddings) {
+    const size_t concurrency = index->get_effective_index_concurrency();
     const auto& indexable_schema = use_addition_fields ? addition_fields : actual_search_schema;
-    
+
+    // Embeddings are generated per slice, so smaller slices would only mean more calls to the model.
+    const bool embeds_in_slices = generate_embeddings && !defer_embeddings && !embedding_fields.empty();
+    const size_t num_slices = std::min(iter_batch.size(),
+                                       embeds_in_slices ? concurrency : concurrency * VALIDATION_SLICES_PER_TASK);
+    const size_t slice_size = (num_slices == 0) ? 0 :
+                              (iter_batch.size() + num_slices - 1) / num_slices;  // rounds up
 
     size_t num_indexed = 0;
     size_t num_processed = 0;
@@ -581,32 +602,38 @@ batch_memory_index(Index *index,
     std::condition_variable cv_process;
 
     size_t num_queued = 0;
-    size_t batch_index = 0;
 
     // local is need to propogate the thread local inside threads launched below
     auto local_write_log_index = write_log_index;
+    auto local_write_log_last_index = write_log_last_index;
 
-    for(size_t thread_id = 0; thread_id < num_threads && batch_index < iter_batch.size(); thread_id++) {
-        size_t batch_len = window_size;
-
-        if(batch_index + window_size > iter_batch.size()) {
-            batch_len = iter_batch.size() - batch_index;
-        }
+    // slices are handed out to the tasks as they free up, so that slices of large documents don't hold up the batch
+    std::atomic<size_t> next_slice = 0;
 
+    for(size_t task_id = 0; task_id < std::min(concurrency, num_slices); task_id++) {
         num_queued++;
 
-        index->thread_pool->enqueue([&, batch_index, batch_len]() {
+        index->index_thread_pool->enqueue([&]() {
             write_log_index = local_write_log_index;
-            validate_and_preprocess(index, iter_batch, batch_index, batch_len, default_sorting_field, actual_search_schema,
-                                    embedding_fields, fallback_field_type, token_separators, symbols_to_index, do_validation, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries, generate_embeddings);
+            write_log_last_index = local_write_log_last_index;
+
+            for(size_t slice = next_slice++; slice < num_slices; slice = next_slice++) {
+                const size_t batch_index = slice * slice_size;
+                if(batch_index >= iter_batch.size()) {
+                    break;
+                }
+
+                const size_t batch_len = std::min(slice_size, iter_batch.size() - batch_index);
+                validate_and_preprocess(index, iter_batch, batch_index, batch_len, default_sorting_field, actual_search_schema,
+                                        embedding_fields, fallback_field_type, token_separators, symbols_to_index, do_validation, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries, generate_embeddings,
+                                        defer_embeddings);
+            }
 
             std::unique_lock<std::mutex> lock(m_process);
             num_processed++;
 
             cv_process.notify_one();
         });
-
-        batch_index += batch_len;
     }
 
     {
@@ -614,7 +641,8 @@ batch_memory_index(Index *index,
         cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
     }
 
-    std::unordered_set<std::string> found_fields;
+    // estimated work of indexing each field: a unit per value, and another per token of a string value
+    std::unordered_map<std::string, size_t> found_fields;
 
     for(size_t i = 0; i < iter_batch.size(); i++) {
         auto& index_rec = iter_batch[i];
@@ -631,53 +659,123 @@ batch_memory_index(Index *index,
         }
 
         for(const auto& kv: index_rec.doc.items()) {
-            found_fields.insert(kv.key());
+            found_fields[kv.key()]++;
         }
-    }
 
-    num_queued = num_processed = 0;
-    std::unique_lock ulock(index->mutex);
+        for(const auto& field_index: index_rec.field_index) {
+            found_fields[field_index.first] += field_index.second.offsets.size();
+        }
+    }
 
-    for(const auto& field_name: found_fields) {
-        //LOG(INFO) << "field name: " << field_name;
-        if(field_name != "id" && indexable_schema.count(field_name) == 0) {
-            continue;
+    // the heaviest fields are indexed first, so that they don't end up running alone at the end
+    std::vector<std::pair<size_t, std::string>> field_work;
+    for(const auto& found_field: found_fields) {
+        if(found_field.first == "id" || indexable_schema.count(found_field.first) != 0) {
+            field_work.emplace_back(found_field.second, found_field.first);
         }
+    }
 
-        num_queued++;
+    std::sort(field_work.begin(), field_work.end(), std::greater<>());
 
-        index->thread_pool->enqueue([&]() {
-            write_log_index = local_write_log_index;
+    // The exclusive lock is held for a bounded slice of records at a time, so that searches arriving in the middle
+    // of a large write batch only wait for the current slice instead of the whole batch. Every record is indexed
+    // fully within a single slice, so searches never see a partially indexed document.
+    std::vector<index_record> slice_records;
+
+    for(size_t slice_start = 0; slice_start < iter_batch.size(); slice_start += WRITE_LOCK_BATCH_SIZE) {
+        const size_t slice_end = std::min(iter_batch.size(), slice_start + WRITE_LOCK_BATCH_SIZE);
+        const bool is_whole_batch = (slice_start == 0 && slice_end == iter_batch.size());
 
-            const field& f = (field_name == "id") ?
-                             field("id", field_types::STRING, false) : indexable_schema.at(field_name);
-            std::vector<reference_pair_t> async_references;
-            auto it = async_referenced_ins.find(field_name);
-            if (it != async_referenced_ins.end()) {
-                async_references = it->second;
+        if(!is_whole_batch) {
+            slice_records.clear();
+            for(size_t i = slice_start; i < slice_end; i++) {
+                slice_records.push_back(std::move(iter_batch[i]));
             }
+        }
 
-            try {
-                index->index_field_in_memory(collection_name, f, iter_batch, async_references);
-            } catch(std::exception& e) {
-                LOG(ERROR) << "Unhandled Typesense error: " << e.what();
-                for(auto& record: iter_batch) {
-                    record.index_failure(500, "Unhandled Typesense error in index batch, check logs for details.");
+        std::vector<index_record>& records = is_whole_batch ? iter_batch : slice_records;
+
+        num_queued = num_processed = 0;
+        std::unique_lock ulock(index->mutex);
+
+        // a field is indexed by a single task, since its indices are not safe for concurrent writes
+        std::atomic<size_t> next_field = 0;
+
+        for(size_t task_id = 0; task_id < std::min(concurrency, field_work.size()); task_id++) {
+            num_queued++;
+
+            index->index_thread_pool->enqueue([&]() {
+                write_log_index = local_write_log_index;
+                write_log_last_index = local_write_log_last_index;
+
+                for(size_t field_id = next_field++; field_id < field_work.size(); field_id = next_field++) {
+                    const std::string& field_name = field_work[field_id].second;
+                    //LOG(INFO) << "field name: " << field_name;
+
+                    const field& f = (field_name == "id") ?
+                                     field("id", field_types::STRING, false) : indexable_schema.at(field_name);
+                    std::vector<reference_pair_t> async_references;
+                    auto it = async_referenced_ins.find(field_name);
+                    if (it != async_referenced_ins.end()) {
+                        async_references = it->second;
+                    }
+
+                    try {
+                        index->index_field_in_memory(collection_name, f, records, async_references);
+                    } catch(std::exception& e) {
+                        LOG(ERROR) << "Unhandled Typesense error: " << e.what();
+                        for(auto& record: records) {
+                            record.index_failure(500, "Unhandled Typesense error in index batch, check logs for details.");
+                        }
+                    }
                 }
+
+                std::unique_lock<std::mutex> lock(m_process);
+                num_processed++;
+                cv_process.notify_one();
+            });
+        }
+
+        {
+            std::unique_lock<std::mutex> lock_process(m_process);
+            cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+        }
+
+        ulock.unlock();
+
+        if(!is_whole_batch) {
+            for(size_t i = slice_start; i < slice_end; i++) {
+                iter_batch[i] = std::move(slice_records[i - slice_start]);
             }
 
-            std::unique_lock<std::mutex> lock(m_process);
-            num_processed++;
-            cv_process.notify_one();
-        });
+            // give waiting readers a chance to acquire the lock before the next slice
+            std::this_thread::yield();
+        }
     }
 
-    {
-        std::unique_lock<std::mutex> lock_process(m_process);
-        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+    return num_indexed;
+}
+
+void Index::set_index_concurrency(size_t concurrency) {
+    index_concurrency = concurrency;
+}
+
+size_t Index::get_index_concurrency() const {
+    return index_concurrency;
+}
+
+size_t Index::get_effective_index_concurrency() const {
+    size_t concurrency = index_concurrency;
+
+    if(concurrency == 0) {
+        concurrency = Config::get_instance().get_index_concurrency();
     }
 
-    return num_indexed;
+    if(concurrency == 0 && index_thread_pool != nullptr) {
+        concurrency = index_thread_pool->get_num_threads();
+    }
+
+    return std::max<size_t>(1, concurrency);
 }
 
 void Index::index_field_in_memory(const std::string& collection_name, const field& afield,
@@ -972,9 +1070,10 @@ void Index::index_field_in_memory(const std::string& collection_name, const fiel
         } else if(afield.is_array()) {
             // handle vector index first
             if(afield.type == field_types::FLOAT_ARRAY && afield.num_dim > 0) {
-                auto vec_index = vector_index[afield.name]->vecdex;
+                auto field_vector_index = vector_index[afield.name];
+                auto vec_index = field_vector_index->vecdex;
                 size_t curr_ele_count = vec_index->getCurrentElementCount();
-                if(curr_ele_count + iter_batch.size() > vec_index->getMaxElements()) {
+                if(field_vector_index->ivf == nullptr && curr_ele_count + iter_batch.size() > vec_index->getMaxElements()) {
                     vec_index->resizeIndex((curr_ele_count + iter_batch.size()) * 1.3);
                 }
 
@@ -997,7 +1096,7 @@ void Index::index_field_in_memory(const std::string& collection_name, const fiel
 
                     num_queued++;
 
-                    thread_pool->enqueue([thread_id, &afield, &vec_index, &records = iter_batch,
+                    index_thread_pool->enqueue([thread_id, &afield, field_vector_index, &records = iter_batch,
                                           result_index, batch_len, &num_processed, &m_process, &cv_process]() {
 
                         size_t batch_counter = 0;
@@ -1016,9 +1115,9 @@ void Index::index_field_in_memory(const std::string& collection_name, const fiel
                                     if(afield.vec_dist == cosine) {
                                         std::vector<float> normalized_vals(afield.num_dim);
                                         hnsw_index_t::normalize_vector(float_vals, normalized_vals);
-                                        vec_index->addPoint(normalized_vals.data(), (size_t)record.seq_id, true);
+                                        field_vector_index->add_point(normalized_vals, (size_t)record.seq_id);
                                     } else {
-                                        vec_index->addPoint(float_vals.data(), (size_t)record.seq_id, true);
+                                        field_vector_index->add_point(float_vals, (size_t)record.seq_id);
                                     }
                                 }
                             } catch(const std::exception &e) {
@@ -2376,6 +2475,7 @@ Option<bool> Index::run_search(search_args* search_params, const std::string& co
                   search_params->filter_curated_hits,
                   search_params->split_join_tokens,
                   search_params->vector_query,
+                  search_params->vector_search_strategy,
                   search_params->facet_sample_percent,
                   search_params->facet_sample_threshold,
                   collection_name,
@@ -2794,14 +2894,17 @@ Option<bool> Index::search_infix(const std::string& query, const std::string& fi
 
     const auto parent_search_begin = search_begin_us;
     const auto parent_search_stop_ms = search_stop_us;
+    const auto parent_search_client_alive = search_client_alive;
     auto parent_search_cutoff = search_cutoff;
 
     for(auto infix_set: infix_sets) {
         thread_pool->enqueue([infix_set, &leaves, search_tree, &query, max_extra_prefix, max_extra_suffix,
                                      &num_processed, &m_process, &cv_process,
-                                     &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff]() {
+                                     &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                                     parent_search_client_alive]() {
 
             search_begin_us = parent_search_begin;
+            search_client_alive = parent_search_client_alive;
             search_cutoff = false;
             auto op_search_stop_ms = parent_search_stop_ms/2;
 
@@ -2826,7 +2929,8 @@ Option<bool> Index::search_infix(const std::string& query, const std::string& fi
 
                 // check for search cutoff but only once every 2^10 docs to reduce overhead
                 if(((num_iterated + 1) % (1 << 12)) == 0) {
-                    if ((std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().
+                    if (is_search_cancelled() ||
+                        (std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().
                         time_since_epoch()).count() - search_begin_us) > op_search_stop_ms) {
                         search_cutoff = true;
                         break;
@@ -2838,6 +2942,7 @@ Option<bool> Index::search_infix(const std::string& query, const std::string& fi
             leaves.insert(leaves.end(), this_leaves.begin(), this_leaves.end());
             num_processed++;
             parent_search_cutoff = parent_search_cutoff || search_cutoff;
+            search_client_alive = nullptr;
             cv_process.notify_one();
         });
     }
@@ -2853,6 +2958,152 @@ Option<bool> Index::search_infix(const std::string& query, const std::string& fi
     return Option<bool>(true);
 }
 
+size_t Index::compute_search_concurrency(const std::vector<query_tokens_t>& field_query_tokens,
+                                         const std::vector<search_field_t>& the_fields, const size_t num_search_fields,
+                                         const bool is_wildcard_query, const bool filter_by_provided,
+                                         const size_t approx_filter_ids_length, const size_t num_facets,
+                                         const size_t max_concurrency) const {
+    // estimate the number of documents that the search will have to score
+    size_t estimated_docs = 0;
+
+    if(is_wildcard_query) {
+        estimated_docs = filter_by_provided ? approx_filter_ids_length : seq_ids->num_ids();
+    } else {
+        for(size_t i = 0; i < num_search_fields && i < field_query_tokens.size(); i++) {
+            auto tree_it = search_index.find(the_fields[i].str_name);
+            if(tree_it == search_index.end()) {
+                continue;
+            }
+
+            // only exact token matches are looked up: typo and prefix expansions are not known at this point
+            for(const auto& token: field_query_tokens[i].q_include_tokens) {
+                art_leaf* leaf = (art_leaf *) art_search(tree_it->second,
+                                                         (const unsigned char *) token.value.c_str(),
+                                                         token.value.size() + 1);
+                if(leaf != nullptr) {
+                    estimated_docs += posting_t::num_ids(leaf->values);
+                }
+            }
+        }
+
+        if(filter_by_provided) {
+            estimated_docs = std::min(estimated_docs, approx_filter_ids_length);
+        }
+    }
+
+    // every facet field is computed over the whole result set
+    const size_t estimated_work = estimated_docs * (1 + num_facets);
+    size_t search_concurrency = std::min(max_concurrency,
+                                         (estimated_work + SEARCH_DOCS_PER_THREAD - 1) / SEARCH_DOCS_PER_THREAD);
+
+    // when the pool is busy, favour throughput by not forking into more threads than are idle
+    const size_t pool_size = thread_pool->get_num_threads();
+    const size_t pool_load = thread_pool->get_num_active() + thread_pool->get_num_queued();
+    const size_t num_idle_threads = (pool_load < pool_size) ? (pool_size - pool_load) : 0;
+    search_concurrency = std::min(search_concurrency, num_idle_threads);
+
+    return std::max<size_t>(1, search_concurrency);
+}
+
+std::vector<std::pair<float, size_t>> Index::search_vector_index(hnsw_index_t* field_vector_index,
+                                                                 const std::vector<float>& query_values, size_t k,
+                                                                 size_t ef, size_t nprobe, const bool filter_by_provided,
+                                                                 filter_result_iterator_t* filter_result_iterator,
+                                                                 const uint32_t* excluded_ids,
+                                                                 const size_t excluded_ids_length,
+                                                                 vector_search_strategy_t& strategy) const {
+    std::vector<float> normalized_q;
+    if(field_vector_index->distance_type == cosine) {
+        normalized_q.resize(query_values.size());
+        hnsw_index_t::normalize_vector(query_values, normalized_q);
+    }
+
+    const auto& query = normalized_q.empty() ? query_values : normalized_q;
+    VectorFilterFunctor filterFunctor(filter_result_iterator, excluded_ids, excluded_ids_length);
+
+    const bool is_ivf = (field_vector_index->ivf != nullptr);
+
+    if(!filter_by_provided) {
+        strategy = is_ivf ? vector_search_strategy_t::ivf : vector_search_strategy_t::hnsw;
+
+        // without a filter, IVF partitions can be probed in parallel
+        hnswlib::BaseFilterFunctor* filter = (excluded_ids_length == 0) ? nullptr : &filterFunctor;
+        return field_vector_index->search_knn(query, k, ef, filter, nprobe, thread_pool);
+    }
+
+    const size_t filter_ids_length = filter_result_iterator->approx_filter_ids_length;
+    const size_t num_docs = std::max<size_t>(1, seq_ids->num_ids());
+    const float selectivity = std::min(1.0f, float(filter_ids_length) / num_docs);
+
+    if(filter_ids_length <= VECTOR_BRUTE_FORCE_MAX_IDS) {
+        // few enough candidates that computing all of their distances is cheaper than rejecting most of the graph
+        strategy = vector_search_strategy_t::brute_force;
+        std::vector<std::pair<float, size_t>> dist_labels;
+        const auto dist_func = field_vector_index->space->get_dist_func();
+
+        filter_result_iterator->reset();
+        while(filter_result_iterator->validity == filter_result_iterator_t::valid) {
+            const uint32_t seq_id = filter_result_iterator->seq_id;
+            filter_result_iterator->next();
+
+            if(excluded_ids_length > 0 && std::binary_search(excluded_ids, excluded_ids + excluded_ids_length, seq_id)) {
+                continue;
+            }
+
+            std::vector<float> values;
+            try {
+                values = field_vector_index->get_point(seq_id);
+            } catch(...) {
+                // document does not have a vector
+                continue;
+            }
+
+            dist_labels.emplace_back(dist_func(query.data(), values.data(), &field_vector_index->num_dim), seq_id);
+        }
+
+        filter_result_iterator->reset();
+
+        if(dist_labels.size() > k) {
+            std::nth_element(dist_labels.begin(), dist_labels.begin() + k, dist_labels.end());
+            dist_labels.resize(k);
+        }
+
+        std::sort(dist_labels.begin(), dist_labels.end());
+        return dist_labels;
+    }
+
+    if(selectivity >= VECTOR_POST_FILTER_MIN_SELECTIVITY) {
+        // most neighbours will pass the filter anyway: over-fetch and filter only the results
+        strategy = vector_search_strategy_t::post_filter;
+        const size_t fetch_k = std::ceil(k / selectivity);
+        auto dist_labels = field_vector_index->search_knn(query, fetch_k, std::max(ef, fetch_k), nullptr, nprobe,
+                                                          thread_pool);
+        const bool graph_exhausted = dist_labels.size() < fetch_k;
+
+        std::vector<std::pair<float, size_t>> filtered_dist_labels;
+        for(const auto& dist_label: dist_labels) {
+            if(filtered_dist_labels.size() == k) {
+                break;
+            }
+
+            if(filterFunctor(dist_label.second)) {
+                filtered_dist_labels.push_back(dist_label);
+            }
+        }
+
+        filter_result_iterator->reset();
+
+        if(filtered_dist_labels.size() == k || graph_exhausted) {
+            return filtered_dist_labels;
+        }
+    }
+
+    // visits to the nodes that are rejected by the filter are wasted, so widen the search to compensate for them
+    strategy = is_ivf ? vector_search_strategy_t::ivf : vector_search_strategy_t::filtered_hnsw;
+    const size_t filtered_ef = std::max<size_t>(ef, std::min<size_t>(VECTOR_FILTERED_MAX_EF, ef / selectivity));
+    return field_vector_index->search_knn(query, k, filtered_ef, &filterFunctor, nprobe, thread_pool);
+}
+
 Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::vector<search_field_t>& the_fields,
                    const text_match_type_t match_type,
                    filter_node_t*& filter_tree_root, std::vector<facet>& facets, facet_query_t& facet_query,
@@ -2872,11 +3123,11 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                    const bool group_missing_values,
                    const string& default_sorting_field, bool prioritize_exact_match,
                    const bool prioritize_token_position, const bool prioritize_num_matching_fields, bool exhaustive_search,
-                   size_t concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
+                   size_t& concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
                    size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                    const size_t max_extra_suffix, const size_t facet_query_num_typos,
                    const bool filter_curated_hits, const enable_t split_join_tokens,
-                   const vector_query_t& vector_query,
+                   const vector_query_t& vector_query, vector_search_strategy_t& vector_search_strategy,
                    size_t facet_sample_percent, size_t facet_sample_threshold,
                    const std::string& collection_name,
                    const drop_tokens_param_t drop_tokens_mode,
@@ -2945,6 +3196,16 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
     size_t exclude_token_ids_size = 0;
     handle_exclusion(num_search_fields, field_query_tokens, the_fields, exclude_token_ids, exclude_token_ids_size);
 
+    // deleted documents that are not purged yet are excluded like the documents of excluded tokens
+    if(tombstone_ids.size() > tombstone_ids_head) {
+        uint32_t* exclude_ids = nullptr;
+        exclude_token_ids_size = ArrayUtils::or_scalar(exclude_token_ids, exclude_token_ids_size,
+                                                       &tombstone_ids[tombstone_ids_head],
+                                                       tombstone_ids.size() - tombstone_ids_head, &exclude_ids);
+        delete [] exclude_token_ids;
+        exclude_token_ids = exclude_ids;
+    }
+
     int sort_order[3];  // 1 or -1 based on DESC or ASC respectively
     std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values;
     std::vector<size_t> geopoint_indices;
@@ -2965,6 +3226,10 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
     // phrase queries are handled as a filtering query
     bool is_wildcard_non_phrase_query = is_wildcard_query && field_query_tokens[0].q_phrases.empty();
 
+    concurrency = compute_search_concurrency(field_query_tokens, the_fields, num_search_fields, is_wildcard_query,
+                                             filter_by_provided, filter_result_iterator->approx_filter_ids_length,
+                                             facets.size(), concurrency);
+
     // handle phrase searches
     if (!field_query_tokens[0].q_phrases.empty()) {
         auto do_phrase_search_op = do_phrase_search(num_search_fields, the_fields, field_query_tokens,
@@ -3046,6 +3311,12 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
         collate_included_ids({}, included_ids_map, curated_topster, searched_queries);
 
         if (!vector_query.field_name.empty()) {
+            auto vector_query_values_op = vector_query.get_values();
+            if(!vector_query_values_op.ok()) {
+                return Option<bool>(vector_query_values_op.code(), vector_query_values_op.error());
+            }
+
+            const std::vector<float>& vector_query_values = vector_query_values_op.get();
             auto k = vector_query.k == 0 ? std::max<size_t>(vector_query.k, fetch_size) : vector_query.k;
 
             VectorFilterFunctor filterFunctor(filter_result_iterator, excluded_result_ids, excluded_result_ids_size);
@@ -3064,6 +3335,17 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
             uint32_t filter_id_count = filter_result_iterator->approx_filter_ids_length;
             if (filter_by_provided && filter_id_count < vector_query.flat_search_cutoff) {
+                vector_search_strategy = vector_search_strategy_t::brute_force;
+
+                std::vector<float> normalized_q;
+                if (field_vector_index->distance_type == cosine) {
+                    normalized_q.resize(vector_query_values.size());
+                    hnsw_index_t::normalize_vector(vector_query_values, normalized_q);
+                }
+
+                const auto& query_values = normalized_q.empty() ? vector_query_values : normalized_q;
+                const auto dist_func = field_vector_index->space->get_dist_func();
+
                 while (filter_result_iterator->validity == filter_result_iterator_t::valid) {
                     auto seq_id = filter_result_iterator->seq_id;
                     auto filter_result = single_filter_result_t(seq_id, std::move(filter_result_iterator->reference));
@@ -3071,23 +3353,13 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                     std::vector<float> values;
 
                     try {
-                        values = field_vector_index->vecdex->getDataByLabel<float>(seq_id);
+                        values = field_vector_index->get_point(seq_id);
                     } catch (...) {
                         // likely not found
                         continue;
                     }
 
-                    float dist;
-                    if (field_vector_index->distance_type == cosine) {
-                        std::vector<float> normalized_q(vector_query.values.size());
-                        hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                        dist = field_vector_index->space->get_dist_func()(normalized_q.data(), values.data(),
-                                                                          &field_vector_index->num_dim);
-                    } else {
-                        dist = field_vector_index->space->get_dist_func()(vector_query.values.data(), values.data(),
-                                                                          &field_vector_index->num_dim);
-                    }
-
+                    float dist = dist_func(query_values.data(), values.data(), &field_vector_index->num_dim);
                     dist_results.emplace_back(dist, filter_result);
                 }
             }
@@ -3098,14 +3370,9 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 (filter_id_count >= vector_query.flat_search_cutoff && filter_result_iterator->validity == filter_result_iterator_t::valid)) {
                 dist_results.clear();
 
-                std::vector<std::pair<float, size_t>> pairs;
-                if(field_vector_index->distance_type == cosine) {
-                    std::vector<float> normalized_q(vector_query.values.size());
-                    hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                    pairs = field_vector_index->vecdex->searchKnnCloserFirst(normalized_q.data(), k, vector_query.ef, &filterFunctor);
-                } else {
-                    pairs = field_vector_index->vecdex->searchKnnCloserFirst(vector_query.values.data(), k, vector_query.ef, &filterFunctor);
-                }
+                auto pairs = search_vector_index(field_vector_index, vector_query_values, k, vector_query.ef, vector_query.nprobe,
+                                                 filter_by_provided, filter_result_iterator, excluded_result_ids,
+                                                 excluded_result_ids_size, vector_search_strategy);
 
                 std::sort(pairs.begin(), pairs.end(), [](auto& x, auto& y) {
                     return x.second < y.second;
@@ -3237,6 +3504,62 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
         // In multi-field searches, a record can be matched across different fields, so we use this for aggregation
         //begin = std::chrono::high_resolution_clock::now();
 
+        // check at least one of sort fields is text match
+        bool has_text_match = false;
+        for(auto& sort_field : sort_fields_std) {
+            if(sort_field.name == sort_field_const::text_match) {
+                has_text_match = true;
+                break;
+            }
+        }
+
+        const bool is_hybrid_search = !vector_query.field_name.empty() && has_text_match;
+
+        // use k as 100 by default for ensuring results stability in pagination
+        const size_t default_vector_k = 100;
+        const size_t vector_k = vector_query.k == 0 ? std::max<size_t>(fetch_size, default_vector_k) : vector_query.k;
+
+        // The vector leg of a hybrid search (including the embedding of the query) does not depend on the keyword leg
+        // until their ranks are fused, so it runs on the thread pool meanwhile. It needs a filter iterator of its own,
+        // which is cheap to make only when the filter's ids are already computed: otherwise it runs after the keyword leg.
+        hybrid_vector_leg_guard_t vector_leg_guard;
+        if(is_hybrid_search && (!filter_by_provided || filter_result_iterator->_get_is_filter_result_initialized())) {
+            uint32_t* filter_ids = nullptr;
+            const uint32_t filter_ids_length = filter_by_provided ?
+                                               filter_result_iterator->to_filter_id_array(filter_ids) : 0;
+            auto vector_leg_filter_iterator = std::make_shared<filter_result_iterator_t>(filter_ids, filter_ids_length,
+                                                                                         search_begin_us, search_stop_us);
+
+            auto field_vector_index = vector_index.at(vector_query.field_name);
+            const uint64_t parent_search_begin = search_begin_us;
+            const uint64_t parent_search_stop_us = search_stop_us;
+            const auto parent_search_client_alive = search_client_alive;
+
+            vector_leg_guard.task = pooled_task_t<hybrid_vector_leg_t>::run(thread_pool,
+                [this, &vector_query, field_vector_index, vector_k, filter_by_provided, vector_leg_filter_iterator,
+                 excluded_result_ids, excluded_result_ids_size,
+                 parent_search_begin, parent_search_stop_us, parent_search_client_alive]() {
+                search_begin_us = parent_search_begin;
+                search_stop_us = parent_search_stop_us;
+                search_client_alive = parent_search_client_alive;
+                search_cutoff = false;
+
+                hybrid_vector_leg_t vector_leg;
+                auto values_op = vector_query.get_values();
+                if(!values_op.ok()) {
+                    vector_leg.status = Option<bool>(values_op.code(), values_op.error());
+                    return vector_leg;
+                }
+
+                vector_leg.dist_labels = search_vector_index(field_vector_index, values_op.get(), vector_k,
+                                                             vector_query.ef, vector_query.nprobe, filter_by_provided,
+                                                             vector_leg_filter_iterator.get(), excluded_result_ids,
+                                                             excluded_result_ids_size, vector_leg.strategy);
+                vector_leg.timed_out = vector_leg_filter_iterator->validity == filter_result_iterator_t::timed_out;
+                return vector_leg;
+            });
+        }
+
         // FIXME: needed?
         std::set<uint64> query_hashes;
 
@@ -3478,213 +3801,212 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
         filter_result_iterator->reset();
         search_cutoff = search_cutoff || filter_result_iterator->validity == filter_result_iterator_t::timed_out;
 
-        if(!vector_query.field_name.empty()) {
-            // check at least one of sort fields is text match
-            bool has_text_match = false;
-            for(auto& sort_field : sort_fields_std) {
-                if(sort_field.name == sort_field_const::text_match) {
-                    has_text_match = true;
-                    break;
+        if(is_hybrid_search) {
+            // For hybrid search, we need to give weight to text match and vector search
+            const float VECTOR_SEARCH_WEIGHT = vector_query.alpha;
+            const float TEXT_MATCH_WEIGHT = 1.0 - VECTOR_SEARCH_WEIGHT;
+
+            auto& field_vector_index = vector_index.at(vector_query.field_name);
+
+            hybrid_vector_leg_t vector_leg;
+            if(vector_leg_guard.task != nullptr) {
+                vector_leg = vector_leg_guard.task->get();
+            } else {
+                auto values_op = vector_query.get_values();
+                if(!values_op.ok()) {
+                    vector_leg.status = Option<bool>(values_op.code(), values_op.error());
+                } else {
+                    vector_leg.dist_labels = search_vector_index(field_vector_index, values_op.get(), vector_k,
+                                                                 vector_query.ef, vector_query.nprobe, filter_by_provided,
+                                                                 filter_result_iterator, excluded_result_ids,
+                                                                 excluded_result_ids_size, vector_leg.strategy);
+                    filter_result_iterator->reset();
+                    vector_leg.timed_out = filter_result_iterator->validity == filter_result_iterator_t::timed_out;
                 }
             }
 
-            if(has_text_match) {
-                // For hybrid search, we need to give weight to text match and vector search
-                const float VECTOR_SEARCH_WEIGHT = vector_query.alpha;
-                const float TEXT_MATCH_WEIGHT = 1.0 - VECTOR_SEARCH_WEIGHT;
+            if(!vector_leg.status.ok()) {
+                return vector_leg.status;
+            }
+
+            const auto& dist_labels = vector_leg.dist_labels;
+            vector_search_strategy = vector_leg.strategy;
+            search_cutoff = search_cutoff || vector_leg.timed_out;
 
-                VectorFilterFunctor filterFunctor(filter_result_iterator, excluded_result_ids, excluded_result_ids_size);
-                auto& field_vector_index = vector_index.at(vector_query.field_name);
+            std::vector<std::pair<uint32_t,float>> vec_results;
+            for (const auto& dist_label : dist_labels) {
+                uint32_t seq_id = dist_label.second;
 
-                std::vector<std::pair<float, size_t>> dist_labels;
-                // use k as 100 by default for ensuring results stability in pagination
-                size_t default_k = 100;
-                auto k = vector_query.k == 0 ? std::max<size_t>(fetch_size, default_k) : vector_query.k;
-                if(field_vector_index->distance_type == cosine) {
-                    std::vector<float> normalized_q(vector_query.values.size());
-                    hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                    dist_labels = field_vector_index->vecdex->searchKnnCloserFirst(normalized_q.data(), k, vector_query.ef, &filterFunctor);
-                } else {
-                    dist_labels = field_vector_index->vecdex->searchKnnCloserFirst(vector_query.values.data(), k, vector_query.ef, &filterFunctor);
+                auto vec_dist_score = (field_vector_index->distance_type == cosine) ? std::abs(dist_label.first) :
+                                        dist_label.first;
+                if(vec_dist_score > vector_query.distance_threshold) {
+                    continue;
                 }
-                filter_result_iterator->reset();
-                search_cutoff = search_cutoff || filter_result_iterator->validity == filter_result_iterator_t::timed_out;
+                vec_results.emplace_back(seq_id, vec_dist_score);
+            }
 
-                std::vector<std::pair<uint32_t,float>> vec_results;
-                for (const auto& dist_label : dist_labels) {
-                    uint32_t seq_id = dist_label.second;
+            // iteration needs to happen on sorted sequence ID but score wise sort needed for compute rank fusion
+            std::sort(vec_results.begin(), vec_results.end(), [](const auto& a, const auto& b) {
+                return a.second < b.second;
+            });
 
-                    auto vec_dist_score = (field_vector_index->distance_type == cosine) ? std::abs(dist_label.first) :
-                                            dist_label.first;
-                    if(vec_dist_score > vector_query.distance_threshold) {
-                        continue;
+            std::unordered_map<uint32_t, uint32_t> seq_id_to_rank;
+
+            for(size_t vec_index = 0; vec_index < vec_results.size(); vec_index++) {
+                seq_id_to_rank.emplace(vec_results[vec_index].first, vec_index);
+            }
+
+            std::sort(vec_results.begin(), vec_results.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+
+            std::vector<KV*> kvs;
+            if(group_limit != 0) {
+                for(auto& kv_map : topster->group_kv_map) {
+                    for(int i = 0; i < kv_map.second->size; i++) {
+                        kvs.push_back(kv_map.second->getKV(i));
                     }
-                    vec_results.emplace_back(seq_id, vec_dist_score);
                 }
+                
+                std::sort(kvs.begin(), kvs.end(), Topster::is_greater);
+            } else {
+                topster->sort();
+            }
 
-                // iteration needs to happen on sorted sequence ID but score wise sort needed for compute rank fusion
-                std::sort(vec_results.begin(), vec_results.end(), [](const auto& a, const auto& b) {
-                    return a.second < b.second;
-                });
+            // Reciprocal rank fusion
+            // Score is  sum of (1 / rank_of_document) * WEIGHT from each list (text match and vector search)
+            auto size = (group_limit != 0) ? kvs.size() : topster->size;
+            for(uint32_t i = 0; i < size; i++) {
+                auto result = (group_limit != 0) ? kvs[i] : topster->getKV(i);
+                if(result->match_score_index < 0 || result->match_score_index > 2) {
+                    continue;
+                }
+                // (1 / rank_of_document) * WEIGHT)
 
-                std::unordered_map<uint32_t, uint32_t> seq_id_to_rank;
+                result->text_match_score = result->scores[result->match_score_index];
+                result->scores[result->match_score_index] = float_to_int64_t((1.0 / (i + 1)) * TEXT_MATCH_WEIGHT);
+            }
 
-                for(size_t vec_index = 0; vec_index < vec_results.size(); vec_index++) {
-                    seq_id_to_rank.emplace(vec_results[vec_index].first, vec_index);
-                }
+            std::vector<uint32_t> vec_search_ids;  // list of IDs found only in vector search
+            std::vector<uint32_t> eval_filter_indexes;
 
-                std::sort(vec_results.begin(), vec_results.end(), [](const auto& a, const auto& b) {
-                    return a.first < b.first;
-                });
+            std::vector<group_by_field_it_t> group_by_field_it_vec;
+            if (group_limit != 0) {
+                group_by_field_it_vec = get_group_by_field_iterators(group_by_fields);
+            }
+
+            for(size_t res_index = 0; res_index < vec_results.size() &&
+                            filter_result_iterator->validity != filter_result_iterator_t::timed_out; res_index++) {
+                auto& vec_result = vec_results[res_index];
+                auto seq_id = vec_result.first;
+
+                if (filter_by_provided && filter_result_iterator->is_valid(seq_id) != 1) {
+                    continue;
+                }
+                auto references = std::move(filter_result_iterator->reference);
+                filter_result_iterator->reset();
 
-                std::vector<KV*> kvs;
+                KV* found_kv = nullptr;
                 if(group_limit != 0) {
-                    for(auto& kv_map : topster->group_kv_map) {
-                        for(int i = 0; i < kv_map.second->size; i++) {
-                            kvs.push_back(kv_map.second->getKV(i));
+                    for(auto& kv : kvs) {
+                        if(kv->key == seq_id) {
+                            found_kv = kv;
+                            break;
                         }
                     }
-                    
-                    std::sort(kvs.begin(), kvs.end(), Topster::is_greater);
                 } else {
-                    topster->sort();
+                    auto result_it = topster->kv_map.find(seq_id);
+                    if(result_it != topster->kv_map.end()) {
+                        found_kv = result_it->second;
+                    }
                 }
-
-                // Reciprocal rank fusion
-                // Score is  sum of (1 / rank_of_document) * WEIGHT from each list (text match and vector search)
-                auto size = (group_limit != 0) ? kvs.size() : topster->size;
-                for(uint32_t i = 0; i < size; i++) {
-                    auto result = (group_limit != 0) ? kvs[i] : topster->getKV(i);
-                    if(result->match_score_index < 0 || result->match_score_index > 2) {
+                if(found_kv) {
+                    if(found_kv->match_score_index < 0 || found_kv->match_score_index > 2) {
                         continue;
                     }
-                    // (1 / rank_of_document) * WEIGHT)
-
-                    result->text_match_score = result->scores[result->match_score_index];
-                    result->scores[result->match_score_index] = float_to_int64_t((1.0 / (i + 1)) * TEXT_MATCH_WEIGHT);
-                }
 
-                std::vector<uint32_t> vec_search_ids;  // list of IDs found only in vector search
-                std::vector<uint32_t> eval_filter_indexes;
+                    // result overlaps with keyword search: we have to combine the scores
 
-                std::vector<group_by_field_it_t> group_by_field_it_vec;
-                if (group_limit != 0) {
-                    group_by_field_it_vec = get_group_by_field_iterators(group_by_fields);
-                }
+                    // old_score + (1 / rank_of_document) * WEIGHT)
+                    found_kv->vector_distance = vec_result.second;
+                    found_kv->text_match_score  = found_kv->scores[found_kv->match_score_index];
+                    int64_t match_score = float_to_int64_t(
+                            (int64_t_to_float(found_kv->scores[found_kv->match_score_index])) +
+                            ((1.0 / (seq_id_to_rank[seq_id] + 1)) * VECTOR_SEARCH_WEIGHT));
+                    int64_t match_score_index = -1;
+                    int64_t scores[3] = {0};
+                    bool should_skip = false;
 
-                for(size_t res_index = 0; res_index < vec_results.size() &&
-                                filter_result_iterator->validity != filter_result_iterator_t::timed_out; res_index++) {
-                    auto& vec_result = vec_results[res_index];
-                    auto seq_id = vec_result.first;
+                    auto compute_sort_scores_op = compute_sort_scores(sort_fields_std, sort_order, field_values,
+                                                                      geopoint_indices, seq_id, references, eval_filter_indexes,
+                                                                      match_score, scores, match_score_index, should_skip,
+                                                                      vec_result.second, collection_name);
+                    if (!compute_sort_scores_op.ok()) {
+                        return compute_sort_scores_op;
+                    }
 
-                    if (filter_by_provided && filter_result_iterator->is_valid(seq_id) != 1) {
+                    if(should_skip) {
                         continue;
                     }
-                    auto references = std::move(filter_result_iterator->reference);
-                    filter_result_iterator->reset();
 
-                    KV* found_kv = nullptr;
-                    if(group_limit != 0) {
-                        for(auto& kv : kvs) {
-                            if(kv->key == seq_id) {
-                                found_kv = kv;
-                                break;
-                            }
-                        }
-                    } else {
-                        auto result_it = topster->kv_map.find(seq_id);
-                        if(result_it != topster->kv_map.end()) {
-                            found_kv = result_it->second;
-                        }
+                    for(int i = 0; i < 3; i++) {
+                        found_kv->scores[i] = scores[i];
                     }
-                    if(found_kv) {
-                        if(found_kv->match_score_index < 0 || found_kv->match_score_index > 2) {
-                            continue;
-                        }
 
-                        // result overlaps with keyword search: we have to combine the scores
-
-                        // old_score + (1 / rank_of_document) * WEIGHT)
-                        found_kv->vector_distance = vec_result.second;
-                        found_kv->text_match_score  = found_kv->scores[found_kv->match_score_index];
-                        int64_t match_score = float_to_int64_t(
-                                (int64_t_to_float(found_kv->scores[found_kv->match_score_index])) +
-                                ((1.0 / (seq_id_to_rank[seq_id] + 1)) * VECTOR_SEARCH_WEIGHT));
-                        int64_t match_score_index = -1;
-                        int64_t scores[3] = {0};
-                        bool should_skip = false;
-
-                        auto compute_sort_scores_op = compute_sort_scores(sort_fields_std, sort_order, field_values,
-                                                                          geopoint_indices, seq_id, references, eval_filter_indexes,
-                                                                          match_score, scores, match_score_index, should_skip,
-                                                                          vec_result.second, collection_name);
-                        if (!compute_sort_scores_op.ok()) {
-                            return compute_sort_scores_op;
-                        }
+                    found_kv->match_score_index = match_score_index;
 
-                        if(should_skip) {
-                            continue;
-                        }
+                } else {
+                    // Result has been found only in vector search: we have to add it to both KV and result_ids
+                    // (1 / rank_of_document) * WEIGHT)
+                    int64_t scores[3] = {0};
+                    int64_t match_score = float_to_int64_t((1.0 / (seq_id_to_rank[seq_id] + 1)) * VECTOR_SEARCH_WEIGHT);
+                    int64_t match_score_index = -1;
+                    bool should_skip = false;
 
-                        for(int i = 0; i < 3; i++) {
-                            found_kv->scores[i] = scores[i];
-                        }
+                    auto compute_sort_scores_op = compute_sort_scores(sort_fields_std, sort_order, field_values,
+                                                                      geopoint_indices, seq_id, references, eval_filter_indexes,
+                                                                      match_score, scores, match_score_index, should_skip,
+                                                                      vec_result.second, collection_name);
+                    if (!compute_sort_scores_op.ok()) {
+                        return compute_sort_scores_op;
+                    }
 
-                        found_kv->match_score_index = match_score_index;
+                    if(should_skip) {
+                        continue;
+                    }
 
-                    } else {
-                        // Result has been found only in vector search: we have to add it to both KV and result_ids
-                        // (1 / rank_of_document) * WEIGHT)
-                        int64_t scores[3] = {0};
-                        int64_t match_score = float_to_int64_t((1.0 / (seq_id_to_rank[seq_id] + 1)) * VECTOR_SEARCH_WEIGHT);
-                        int64_t match_score_index = -1;
-                        bool should_skip = false;
-
-                        auto compute_sort_scores_op = compute_sort_scores(sort_fields_std, sort_order, field_values,
-                                                                          geopoint_indices, seq_id, references, eval_filter_indexes,
-                                                                          match_score, scores, match_score_index, should_skip,
-                                                                          vec_result.second, collection_name);
-                        if (!compute_sort_scores_op.ok()) {
-                            return compute_sort_scores_op;
-                        }
+                    uint64_t distinct_id = seq_id;
+                    if (group_limit != 0) {
+                        distinct_id = 1;
 
-                        if(should_skip) {
-                            continue;
+                        for(auto& kv : group_by_field_it_vec) {
+                            get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
                         }
 
-                        uint64_t distinct_id = seq_id;
-                        if (group_limit != 0) {
-                            distinct_id = 1;
-
-                            for(auto& kv : group_by_field_it_vec) {
-                                get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
-                            }
-
-                            if(excluded_group_ids.count(distinct_id) != 0) {
-                                continue;
-                            }
+                        if(excluded_group_ids.count(distinct_id) != 0) {
+                            continue;
                         }
-                        KV kv(searched_queries.size(), seq_id, distinct_id, match_score_index, scores, std::move(references));
-                        kv.text_match_score = 0;
-                        kv.vector_distance = vec_result.second;
+                    }
+                    KV kv(searched_queries.size(), seq_id, distinct_id, match_score_index, scores, std::move(references));
+                    kv.text_match_score = 0;
+                    kv.vector_distance = vec_result.second;
 
-                        auto ret = topster->add(&kv);
-                        vec_search_ids.push_back(seq_id);
+                    auto ret = topster->add(&kv);
+                    vec_search_ids.push_back(seq_id);
 
-                        if(group_limit != 0 && ret < 2) {
-                            groups_processed[distinct_id]++;
-                        }
+                    if(group_limit != 0 && ret < 2) {
+                        groups_processed[distinct_id]++;
                     }
                 }
-                search_cutoff = search_cutoff || filter_result_iterator->validity == filter_result_iterator_t::timed_out;
+            }
+            search_cutoff = search_cutoff || filter_result_iterator->validity == filter_result_iterator_t::timed_out;
 
-                if(!vec_search_ids.empty()) {
-                    uint32_t* new_all_result_ids = nullptr;
-                    all_result_ids_len = ArrayUtils::or_scalar(all_result_ids, all_result_ids_len, &vec_search_ids[0],
-                                                               vec_search_ids.size(), &new_all_result_ids);
-                    delete[] all_result_ids;
-                    all_result_ids = new_all_result_ids;
-                }
+            if(!vec_search_ids.empty()) {
+                uint32_t* new_all_result_ids = nullptr;
+                all_result_ids_len = ArrayUtils::or_scalar(all_result_ids, all_result_ids_len, &vec_search_ids[0],
+                                                           vec_search_ids.size(), &new_all_result_ids);
+                delete[] all_result_ids;
+                all_result_ids = new_all_result_ids;
             }
         }
 
@@ -3703,7 +4025,9 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
     bool estimate_facets = (facet_sample_percent > 0 && facet_sample_percent < 100 &&
                             all_result_ids_len > facet_sample_threshold);
-    bool is_wildcard_no_filter_query = is_wildcard_non_phrase_query && !filter_by_provided && vector_query.field_name.empty();
+    // the facet counts of the whole collection still count the deleted documents that are not purged yet
+    bool is_wildcard_no_filter_query = is_wildcard_non_phrase_query && !filter_by_provided && vector_query.field_name.empty() &&
+                                       tombstones.empty();
 
     if(!facets.empty()) {
         const size_t num_threads = std::min(concurrency, all_result_ids_len);
@@ -3748,6 +4072,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
         const auto parent_search_begin = search_begin_us;
         const auto parent_search_stop_ms = search_stop_us;
+        const auto parent_search_client_alive = search_client_alive;
         auto parent_search_cutoff = search_cutoff;
 
         //auto beginF = std::chrono::high_resolution_clock::now();
@@ -3771,8 +4096,10 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                                          is_wildcard_no_filter_query, estimate_facets,
                                          facet_sample_percent, group_missing_values,
                                          &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                                         parent_search_client_alive,
                                          &num_processed, &m_process, &cv_process, &facet_index_types]() {
                 search_begin_us = parent_search_begin;
+                search_client_alive = parent_search_client_alive;
                 search_stop_us = parent_search_stop_ms;
                 search_cutoff = false;
 
@@ -3792,6 +4119,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
                 num_processed++;
                 parent_search_cutoff = parent_search_cutoff || search_cutoff;
+                search_client_alive = nullptr;
                 cv_process.notify_one();
             });
 
@@ -3811,8 +4139,10 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                                          is_wildcard_no_filter_query, estimate_facets,
                                          facet_sample_percent, group_missing_values,
                                          &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                                         parent_search_client_alive,
                                          &num_processed, &m_process, &cv_process, facet_index_types]() {
                 search_begin_us = parent_search_begin;
+                search_client_alive = parent_search_client_alive;
                 search_stop_us = parent_search_stop_ms;
                 search_cutoff = false;
 
@@ -3832,6 +4162,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
                 num_processed++;
                 parent_search_cutoff = parent_search_cutoff || search_cutoff;
+                search_client_alive = nullptr;
                 cv_process.notify_one();
             });
         }
@@ -5200,7 +5531,7 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
         } else if(field_values[0] == &vector_query_sentinel_value) {
             scores[0] = float_to_int64_t(2.0f);
             try {
-                const auto& values = sort_fields[0].vector_query.vector_index->vecdex->getDataByLabel<float>(seq_id);
+                const auto& values = sort_fields[0].vector_query.vector_index->get_point(seq_id);
                 const auto& dist_func = sort_fields[0].vector_query.vector_index->space->get_dist_func();
                 float dist = dist_func(sort_fields[0].vector_query.query.values.data(), values.data(), &sort_fields[0].vector_query.vector_index->num_dim);
 
@@ -5318,7 +5649,7 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
         } else if(field_values[1] == &vector_query_sentinel_value) {
             scores[1] = float_to_int64_t(2.0f);
             try {
-                const auto& values = sort_fields[1].vector_query.vector_index->vecdex->getDataByLabel<float>(seq_id);
+                const auto& values = sort_fields[1].vector_query.vector_index->get_point(seq_id);
                 const auto& dist_func = sort_fields[1].vector_query.vector_index->space->get_dist_func();
                 float dist = dist_func(sort_fields[1].vector_query.query.values.data(), values.data(), &sort_fields[1].vector_query.vector_index->num_dim);
 
@@ -5434,7 +5765,7 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
         } else if(field_values[2] == &vector_query_sentinel_value) {
             scores[2] = float_to_int64_t(2.0f);
             try {
-                const auto& values = sort_fields[2].vector_query.vector_index->vecdex->getDataByLabel<float>(seq_id);
+                const auto& values = sort_fields[2].vector_query.vector_index->get_point(seq_id);
                 const auto& dist_func = sort_fields[2].vector_query.vector_index->space->get_dist_func();
                 float dist = dist_func(sort_fields[2].vector_query.query.values.data(), values.data(), &sort_fields[2].vector_query.vector_index->num_dim);
 
@@ -6170,6 +6501,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
 
     const auto parent_search_begin = search_begin_us;
     const auto parent_search_stop_ms = search_stop_us;
+    const auto parent_search_client_alive = search_client_alive;
     auto parent_search_cutoff = search_cutoff;
     uint32_t excluded_result_index = 0;
     Option<bool>* compute_sort_score_statuses[num_threads];
@@ -6191,6 +6523,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
         auto& compute_sort_score_status = compute_sort_score_statuses[thread_id] = nullptr;
 
         thread_pool->enqueue([this, &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                              parent_search_client_alive,
                               thread_id, &sort_fields, &searched_queries,
                               &group_limit, &group_by_fields, group_missing_values, 
                               &topsters, &tgroups_processed, &excluded_group_ids,
@@ -6201,6 +6534,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
             std::unique_ptr<filter_result_t> batch_result_guard(batch_result);
 
             search_begin_us = parent_search_begin;
+            search_client_alive = parent_search_client_alive;
             search_stop_us = parent_search_stop_ms;
             search_cutoff = false;
 
@@ -6266,6 +6600,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
             std::unique_lock<std::mutex> lock(m_process);
             num_processed++;
             parent_search_cutoff = parent_search_cutoff || search_cutoff;
+            search_client_alive = nullptr;
             cv_process.notify_one();
         });
     }
@@ -7040,7 +7375,7 @@ void Index::remove_field(uint32_t seq_id, nlohmann::json& document, const std::s
     } else if(search_field.num_dim) {
         if(!is_update) {
             // since vector index supports upsert natively, we should not attempt to delete for update
-            vector_index[search_field.name]->vecdex->markDelete(seq_id);
+            vector_index[search_field.name]->remove_point(seq_id);
         }
     } else if(search_field.is_float()) {
         const std::vector<float>& values = search_field.is_single_float() ?
@@ -7162,6 +7497,86 @@ Option<uint32_t> Index::remove(const uint32_t seq_id, nlohmann::json & document,
     return Option<uint32_t>(seq_id);
 }
 
+void Index::remove_lazily(const uint32_t seq_id, const nlohmann::json& document) {
+    std::unique_lock lock(mutex);
+
+    nlohmann::json tombstone = document;
+
+    // A vector search can scan the points of a field without looking at the excluded ids, so vectors are removed
+    // right away. Marking a point as deleted is cheap anyway.
+    for(auto it = document.begin(); it != document.end(); ++it) {
+        auto field_it = search_schema.find(it.key());
+        if(field_it == search_schema.end() || field_it->num_dim == 0) {
+            continue;
+        }
+
+        try {
+            remove_field(seq_id, tombstone, it.key(), false);
+        } catch(const std::exception& e) {
+            LOG(WARNING) << "Error while removing field `" << it.key() << "` from document, message: " << e.what();
+        }
+
+        tombstone.erase(it.key());
+    }
+
+    seq_ids->erase(seq_id);
+
+    // seq_ids mostly increase, so the id is usually appended
+    auto id_it = std::lower_bound(tombstone_ids.begin() + tombstone_ids_head, tombstone_ids.end(), seq_id);
+    if(id_it == tombstone_ids.end() || *id_it != seq_id) {
+        tombstone_ids.insert(id_it, seq_id);
+    }
+
+    tombstones[seq_id] = std::move(tombstone);
+}
+
+void Index::purge_tombstone(uint32_t seq_id, nlohmann::json& document) {
+    for(auto it = document.begin(); it != document.end(); ++it) {
+        const std::string& field_name = it.key();
+        try {
+            remove_field(seq_id, document, field_name, false);
+        } catch(const std::exception& e) {
+            LOG(WARNING) << "Error while removing field `" << field_name << "` from document, message: "
+                         << e.what();
+        }
+    }
+}
+
+size_t Index::purge_tombstones(size_t max_purged) {
+    size_t num_purged = 0;
+
+    while(num_purged < max_purged) {
+        // the lock is released between batches, so that searches and writes are not held up by a large purge
+        std::unique_lock lock(mutex);
+        if(tombstones.empty()) {
+            break;
+        }
+
+        size_t batch_purged = 0;
+        for(; batch_purged < TOMBSTONE_PURGE_BATCH_SIZE && num_purged < max_purged && !tombstones.empty();
+              batch_purged++) {
+            auto tombstone_it = tombstones.begin();
+            purge_tombstone(tombstone_it->first, tombstone_it->second);
+            tombstones.erase(tombstone_it);
+            num_purged++;
+        }
+
+        // tombstones are purged in the order of their seq_ids
+        tombstone_ids_head += batch_purged;
+        if(tombstone_ids_head * 2 >= tombstone_ids.size()) {
+            tombstone_ids.erase(tombstone_ids.begin(), tombstone_ids.begin() + tombstone_ids_head);
+            tombstone_ids_head = 0;
+        }
+    }
+
+    return num_purged;
+}
+
+size_t Index::num_tombstones() const {
+    std::shared_lock lock(mutex);
+    return tombstones.size();
+}
+
 void Index::tokenize_string_field(const nlohmann::json& document, const field& search_field,
                                   std::vector<std::string>& tokens, const std::string& locale,
                                   const std::vector<char>& symbols_to_index,
@@ -7220,7 +7635,9 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         search_schema.emplace(new_field.name, new_field);
 
         if(new_field.type == field_types::FLOAT_ARRAY && new_field.num_dim > 0) {
-            auto hnsw_index = new hnsw_index_t(new_field.num_dim, 16, new_field.vec_dist, new_field.hnsw_params["M"].get<uint32_t>(), new_field.hnsw_params["ef_construction"].get<uint32_t>());
+            auto hnsw_index = new hnsw_index_t(new_field.num_dim, 16, new_field.vec_dist, new_field.hnsw_params["M"].get<uint32_t>(),
+                                               new_field.hnsw_params["ef_construction"].get<uint32_t>(),
+                                               hnsw_index_t::get_quantization(new_field.hnsw_params), new_field.ivf_params);
             vector_index.emplace(new_field.name, hnsw_index);
             continue;
         }
@@ -7279,6 +7696,10 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
     }
 
+    // Structures of dropped fields are only detached while holding the exclusive lock: the (potentially slow)
+    // destruction of large indices happens after the lock is released, so that searches are not stalled on it.
+    std::vector<std::function<void()>> deferred_deletes;
+
     for(const auto & del_field: del_fields) {
         if(search_schema.count(del_field.name) == 0) {
             // could be a dynamic field
@@ -7292,38 +7713,58 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         if(del_field.is_string() || field_types::is_string_or_array(del_field.type)) {
-            art_tree_destroy(search_index[del_field.name]);
-            delete search_index[del_field.name];
+            art_tree* t = search_index[del_field.name];
             search_index.erase(del_field.name);
+            deferred_deletes.emplace_back([t]() {
+                art_tree_destroy(t);
+                delete t;
+            });
         } else if(del_field.is_geopoint()) {
-            delete geo_range_index[del_field.name];
+            NumericTrie* geo_trie = geo_range_index[del_field.name];
             geo_range_index.erase(del_field.name);
+            deferred_deletes.emplace_back([geo_trie]() {
+                delete geo_trie;
+            });
 
             if(!del_field.is_single_geopoint()) {
                 spp::sparse_hash_map<uint32_t, int64_t*>* geo_array_map = geo_array_index[del_field.name];
-                for(auto& kv: *geo_array_map) {
-                    delete [] kv.second;
-                }
-                delete geo_array_map;
                 geo_array_index.erase(del_field.name);
+                deferred_deletes.emplace_back([geo_array_map]() {
+                    for(auto& kv: *geo_array_map) {
+                        delete [] kv.second;
+                    }
+                    delete geo_array_map;
+                });
             }
         } else {
             if (del_field.range_index) {
-                delete range_index[del_field.name];
+                NumericTrie* trie = range_index[del_field.name];
                 range_index.erase(del_field.name);
+                deferred_deletes.emplace_back([trie]() {
+                    delete trie;
+                });
             } else {
-                delete numerical_index[del_field.name];
+                num_tree_t* num_tree = numerical_index[del_field.name];
                 numerical_index.erase(del_field.name);
+                deferred_deletes.emplace_back([num_tree]() {
+                    delete num_tree;
+                });
             }
         }
 
         if(del_field.is_sortable()) {
             if(del_field.is_num_sortable()) {
-                delete sort_index[del_field.name];
+                auto doc_to_score = sort_index[del_field.name];
                 sort_index.erase(del_field.name);
+                deferred_deletes.emplace_back([doc_to_score]() {
+                    delete doc_to_score;
+                });
             } else if(del_field.is_str_sortable()) {
-                delete str_sort_index[del_field.name];
+                adi_tree_t* tree = str_sort_index[del_field.name];
                 str_sort_index.erase(del_field.name);
+                deferred_deletes.emplace_back([tree]() {
+                    delete tree;
+                });
             }
         }
 
@@ -7331,27 +7772,39 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             facet_index_v4->erase(del_field.name);
 
             if(!del_field.is_string()) {
-                art_tree_destroy(search_index[del_field.faceted_name()]);
-                delete search_index[del_field.faceted_name()];
+                art_tree* ft = search_index[del_field.faceted_name()];
                 search_index.erase(del_field.faceted_name());
+                deferred_deletes.emplace_back([ft]() {
+                    art_tree_destroy(ft);
+                    delete ft;
+                });
             }
         }
 
         if(del_field.infix) {
-            auto& infix_set = infix_index[del_field.name];
-            for(size_t i = 0; i < infix_set.size(); i++) {
-                delete infix_set[i];
-            }
-
+            array_mapped_infix_t infix_sets = infix_index[del_field.name];
             infix_index.erase(del_field.name);
+            deferred_deletes.emplace_back([infix_sets]() {
+                for(auto infix_set: infix_sets) {
+                    delete infix_set;
+                }
+            });
         }
 
         if(del_field.num_dim) {
             auto hnsw_index = vector_index[del_field.name];
-            delete hnsw_index;
             vector_index.erase(del_field.name);
+            deferred_deletes.emplace_back([hnsw_index]() {
+                delete hnsw_index;
+            });
         }
     }
+
+    lock.unlock();
+
+    for(auto& deferred_delete: deferred_deletes) {
+        deferred_delete();
+    }
 }
 
 void Index::handle_doc_ops(const tsl::htrie_map<char, field>& search_schema,
@@ -7427,7 +7880,12 @@ void Index::get_doc_changes(const index_operation_t op, const tsl::htrie_map<cha
     auto it = update_doc.begin();
     while(it != update_doc.end()) {
         if(it.value().is_object() || (it.value().is_array() && !it.value().empty() && it.value()[0].is_object())) {
-            ++it;
+            // the flattened values of an object are compared on their own, so an unchanged object is only dropped
+            if(old_doc.contains(it.key()) && old_doc[it.key()] == it.value()) {
+                it = update_doc.erase(it);
+            } else {
+                ++it;
+            }
             continue;
         }
 
@@ -7640,6 +8098,20 @@ bool Index::common_results_exist(std::vector<art_leaf*>& leaves, bool must_match
 }
 
 
+bool Index::embedding_source_changed(const field& embedding_field, const nlohmann::json& changed_doc) {
+    if(embedding_field.embed.count(fields::from) == 0 || embedding_field.embed[fields::from].is_null()) {
+        return false;
+    }
+
+    for(const auto& embed_from: embedding_field.embed[fields::from]) {
+        if(changed_doc.contains(embed_from.get<std::string>())) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void Index::batch_embed_fields(std::vector<index_record*>& records, 
                                const tsl::htrie_map<char, field>& embedding_fields,
                                const tsl::htrie_map<char, field> & search_schema, const size_t remote_embedding_batch_size,
@@ -7653,6 +8125,11 @@ void Index::batch_embed_fields(std::vector<index_record*>& records,
             }
             nlohmann::json* document;
             if(record->is_update) {
+                if(!embedding_source_changed(field, record->doc)) {
+                    // other embedding fields of the document are being generated again
+                    continue;
+                }
+
                 document = &record->new_doc;
             } else {
                 document = &record->doc;
@@ -7831,6 +8308,74 @@ void Index::repair_hnsw_index() {
     }
 }
 
+void Index::save_vector_indices(const std::string& dir_path, const std::string& file_prefix,
+                                nlohmann::json& meta) const {
+    std::vector<std::string> vector_fields;
+
+    {
+        std::shared_lock lock(mutex);
+        for(const auto& vec_kv: vector_index) {
+            vector_fields.push_back(vec_kv.first);
+        }
+    }
+
+    // the lock is held for one graph at a time, so that writes are held up by the save of a single graph at the most
+    for(size_t file_id = 0; file_id < vector_fields.size(); file_id++) {
+        const std::string& vector_field = vector_fields[file_id];
+        const std::string file_name = file_prefix + "_" + std::to_string(file_id) + ".bin";
+        nlohmann::json field_meta;
+
+        std::shared_lock lock(mutex);
+        auto vec_it = vector_index.find(vector_field);
+        if(vec_it == vector_index.end()) {
+            continue;
+        }
+
+        auto save_op = vec_it->second->save(dir_path + "/" + file_name, field_meta);
+        if(!save_op.ok()) {
+            LOG(INFO) << "Not saving vector index of field " << vector_field << ": " << save_op.error();
+            continue;
+        }
+
+        field_meta["file"] = file_name;
+        meta[vector_field] = field_meta;
+    }
+}
+
+void Index::load_vector_indices(const std::string& dir_path, const nlohmann::json& meta) {
+    std::unique_lock lock(mutex);
+
+    for(auto& vec_kv: vector_index) {
+        if(!meta.contains(vec_kv.first) || !meta[vec_kv.first].contains("file")) {
+            continue;
+        }
+
+        const auto& field_meta = meta[vec_kv.first];
+        auto load_op = vec_kv.second->load(dir_path + "/" + field_meta["file"].get<std::string>(), field_meta);
+
+        if(!load_op.ok()) {
+            LOG(ERROR) << "Unable to load the saved vector index of field " << vec_kv.first << ", it will be "
+                       << "rebuilt. Error: " << load_op.error();
+        }
+    }
+}
+
+void Index::finish_vector_index_restore() {
+    {
+        std::shared_lock lock(mutex);
+
+        for(auto& vec_kv: vector_index) {
+            size_t num_removed = vec_kv.second->finish_restore();
+            if(num_removed != 0) {
+                LOG(WARNING) << "Removed " << num_removed << " stale vector(s) from the saved vector index of field "
+                             << vec_kv.first;
+            }
+        }
+    }
+
+    repair_hnsw_index();
+}
+
 int64_t Index::reference_string_sort_score(const string &field_name, const uint32_t &seq_id) const {
     std::shared_lock lock(mutex);
     return str_sort_index.at(field_name)->rank(seq_id);
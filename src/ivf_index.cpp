@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include "ivf_index.h"
+#include "pooled_task.h"
+#include "vector_distance.h"
+
+namespace {
+    // Lloyd's algorithm over `n` vectors of `dim` values stored contiguously, seeded with evenly spaced vectors
+    std::vector<float> kmeans(const float* data, size_t n, size_t dim, size_t k, size_t num_iterations) {
+        const auto& kernels = vector_distance::kernels();
+        std::vector<float> centroids(k * dim, 0.0f);
+
+        for(size_t c = 0; c < k && n != 0; c++) {
+            const float* seed = data + ((c * n) / k) * dim;
+            std::copy(seed, seed + dim, centroids.begin() + c * dim);
+        }
+
+        std::vector<uint32_t> assignments(n, 0);
+        std::vector<float> sums(k * dim);
+        std::vector<size_t> counts(k);
+
+        for(size_t iteration = 0; iteration < num_iterations; iteration++) {
+            bool changed = false;
+
+            for(size_t i = 0; i < n; i++) {
+                uint32_t nearest = 0;
+                float nearest_dist = std::numeric_limits<float>::max();
+
+                for(size_t c = 0; c < k; c++) {
+                    const float dist = kernels.l2_squared(data + i * dim, centroids.data() + c * dim, dim);
+                    if(dist < nearest_dist) {
+                        nearest_dist = dist;
+                        nearest = c;
+                    }
+                }
+
+                changed = changed || (iteration == 0) || (assignments[i] != nearest);
+                assignments[i] = nearest;
+            }
+
+            if(!changed) {
+                break;
+            }
+
+            std::fill(sums.begin(), sums.end(), 0.0f);
+            std::fill(counts.begin(), counts.end(), 0);
+
+            for(size_t i = 0; i < n; i++) {
+                const uint32_t c = assignments[i];
+                counts[c]++;
+                for(size_t d = 0; d < dim; d++) {
+                    sums[c * dim + d] += data[i * dim + d];
+                }
+            }
+
+            for(size_t c = 0; c < k; c++) {
+                // an empty cluster keeps its previous centroid
+                if(counts[c] == 0) {
+                    continue;
+                }
+
+                for(size_t d = 0; d < dim; d++) {
+                    centroids[c * dim + d] = sums[c * dim + d] / counts[c];
+                }
+            }
+        }
+
+        return centroids;
+    }
+
+    struct dist_label_cmp_t {
+        bool operator()(const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) const {
+            return a.first < b.first;
+        }
+    };
+}
+
+ivf_index_t::ivf_index_t(size_t num_dim, size_t nlist, size_t pq_m):
+        num_dim(num_dim), nlist(std::max<size_t>(1, nlist)),
+        pq_m((pq_m != 0 && num_dim % pq_m == 0) ? pq_m : 0),
+        pq_dsub((pq_m != 0 && num_dim % pq_m == 0) ? num_dim / pq_m : 0),
+        centroids(this->nlist * num_dim, 0.0f), partitions(this->nlist) {
+
+}
+
+void ivf_index_t::train(const float* points, size_t num_points) {
+    std::vector<float> trained_centroids = kmeans(points, num_points, num_dim, nlist, KMEANS_NUM_ITERATIONS);
+    std::vector<float> trained_codebooks;
+
+    if(pq_m != 0) {
+        trained_codebooks.resize(pq_m * PQ_NUM_CENTROIDS * pq_dsub);
+        std::vector<float> sub_points(num_points * pq_dsub);
+
+        for(size_t m = 0; m < pq_m; m++) {
+            for(size_t i = 0; i < num_points; i++) {
+                std::copy(points + i * num_dim + m * pq_dsub, points + i * num_dim + (m + 1) * pq_dsub,
+                          sub_points.begin() + i * pq_dsub);
+            }
+
+            auto codebook = kmeans(sub_points.data(), num_points, pq_dsub, PQ_NUM_CENTROIDS, KMEANS_NUM_ITERATIONS);
+            std::copy(codebook.begin(), codebook.end(), trained_codebooks.begin() + m * PQ_NUM_CENTROIDS * pq_dsub);
+        }
+    }
+
+    std::unique_lock lock(mutex);
+    centroids = std::move(trained_centroids);
+    pq_codebooks = std::move(trained_codebooks);
+}
+
+size_t ivf_index_t::nearest_centroid(const float* values) const {
+    const auto& kernels = vector_distance::kernels();
+    size_t nearest = 0;
+    float nearest_dist = std::numeric_limits<float>::max();
+
+    for(size_t c = 0; c < nlist; c++) {
+        const float dist = kernels.l2_squared(values, centroids.data() + c * num_dim, num_dim);
+        if(dist < nearest_dist) {
+            nearest_dist = dist;
+            nearest = c;
+        }
+    }
+
+    return nearest;
+}
+
+void ivf_index_t::encode(const float* values, uint8_t* codes) const {
+    const auto& kernels = vector_distance::kernels();
+
+    for(size_t m = 0; m < pq_m; m++) {
+        const float* codebook = pq_codebooks.data() + m * PQ_NUM_CENTROIDS * pq_dsub;
+        size_t nearest = 0;
+        float nearest_dist = std::numeric_limits<float>::max();
+
+        for(size_t c = 0; c < PQ_NUM_CENTROIDS; c++) {
+            const float dist = kernels.l2_squared(values + m * pq_dsub, codebook + c * pq_dsub, pq_dsub);
+            if(dist < nearest_dist) {
+                nearest_dist = dist;
+                nearest = c;
+            }
+        }
+
+        codes[m] = uint8_t(nearest);
+    }
+}
+
+void ivf_index_t::decode(const uint8_t* codes, float* values) const {
+    for(size_t m = 0; m < pq_m; m++) {
+        const float* codeword = pq_codebooks.data() + (m * PQ_NUM_CENTROIDS + codes[m]) * pq_dsub;
+        std::copy(codeword, codeword + pq_dsub, values + m * pq_dsub);
+    }
+}
+
+void ivf_index_t::remove_label(size_t label) {
+    auto position_it = label_positions.find(label);
+    if(position_it == label_positions.end()) {
+        return;
+    }
+
+    // the last vector of the partition takes the place of the removed one
+    const auto [partition_id, offset] = position_it->second;
+    label_positions.erase(position_it);
+
+    auto& partition = partitions[partition_id];
+    const size_t last = partition.labels.size() - 1;
+
+    if(offset != last) {
+        partition.labels[offset] = partition.labels[last];
+        label_positions[partition.labels[offset]] = {partition_id, offset};
+
+        if(pq_m != 0) {
+            std::copy(partition.codes.begin() + last * pq_m, partition.codes.begin() + (last + 1) * pq_m,
+                      partition.codes.begin() + offset * pq_m);
+        } else {
+            std::copy(partition.values.begin() + last * num_dim, partition.values.begin() + (last + 1) * num_dim,
+                      partition.values.begin() + offset * num_dim);
+        }
+    }
+
+    partition.labels.pop_back();
+    if(pq_m != 0) {
+        partition.codes.resize(last * pq_m);
+    } else {
+        partition.values.resize(last * num_dim);
+    }
+}
+
+void ivf_index_t::add_point(const float* values, size_t label) {
+    const size_t partition_id = nearest_centroid(values);
+    std::vector<uint8_t> codes(pq_m);
+    if(pq_m != 0) {
+        encode(values, codes.data());
+    }
+
+    std::unique_lock lock(mutex);
+    remove_label(label);
+
+    auto& partition = partitions[partition_id];
+    label_positions[label] = {uint32_t(partition_id), uint32_t(partition.labels.size())};
+    partition.labels.push_back(label);
+
+    if(pq_m != 0) {
+        partition.codes.insert(partition.codes.end(), codes.begin(), codes.end());
+    } else {
+        partition.values.insert(partition.values.end(), values, values + num_dim);
+    }
+}
+
+void ivf_index_t::remove_point(size_t label) {
+    std::unique_lock lock(mutex);
+    remove_label(label);
+}
+
+bool ivf_index_t::contains(size_t label) const {
+    std::shared_lock lock(mutex);
+    return label_positions.count(label) != 0;
+}
+
+std::vector<float> ivf_index_t::get_point(size_t label) const {
+    std::shared_lock lock(mutex);
+    auto position_it = label_positions.find(label);
+    if(position_it == label_positions.end()) {
+        throw std::runtime_error("Label not found");
+    }
+
+    const auto& partition = partitions[position_it->second.first];
+    const size_t offset = position_it->second.second;
+    std::vector<float> values(num_dim);
+
+    if(pq_m != 0) {
+        decode(partition.codes.data() + offset * pq_m, values.data());
+    } else {
+        std::copy(partition.values.begin() + offset * num_dim, partition.values.begin() + (offset + 1) * num_dim,
+                  values.begin());
+    }
+
+    return values;
+}
+
+std::vector<std::pair<float, size_t>> ivf_index_t::scan(const float* query, const float* pq_table, size_t k,
+                                                        const std::vector<size_t>& probes, size_t begin, size_t end,
+                                                        hnswlib::BaseFilterFunctor* filter) const {
+    const auto& kernels = vector_distance::kernels();
+
+    // max-heap of the nearest vectors found so far
+    std::priority_queue<std::pair<float, size_t>, std::vector<std::pair<float, size_t>>, dist_label_cmp_t> top;
+
+    for(size_t p = begin; p < end; p++) {
+        const auto& partition = partitions[probes[p]];
+
+        for(size_t i = 0; i < partition.labels.size(); i++) {
+            const size_t label = partition.labels[i];
+            if(filter != nullptr && !(*filter)(label)) {
+                continue;
+            }
+
+            float dist;
+            if(pq_m != 0) {
+                // asymmetric distance: the query is compared to the codewords through the precomputed table
+                float ip = 0;
+                const uint8_t* codes = partition.codes.data() + i * pq_m;
+                for(size_t m = 0; m < pq_m; m++) {
+                    ip += pq_table[m * PQ_NUM_CENTROIDS + codes[m]];
+                }
+                dist = 1.0f - ip;
+            } else {
+                dist = 1.0f - kernels.inner_product(query, partition.values.data() + i * num_dim, num_dim);
+            }
+
+            if(top.size() < k) {
+                top.emplace(dist, label);
+            } else if(dist < top.top().first) {
+                top.pop();
+                top.emplace(dist, label);
+            }
+        }
+    }
+
+    std::vector<std::pair<float, size_t>> dist_labels;
+    dist_labels.reserve(top.size());
+    while(!top.empty()) {
+        dist_labels.push_back(top.top());
+        top.pop();
+    }
+
+    return dist_labels;
+}
+
+std::vector<std::pair<float, size_t>> ivf_index_t::search_knn(const float* query, size_t k, size_t nprobe,
+                                                              hnswlib::BaseFilterFunctor* filter,
+                                                              ThreadPool* thread_pool) const {
+    const auto& kernels = vector_distance::kernels();
+    std::shared_lock lock(mutex);
+
+    std::vector<std::pair<float, size_t>> centroid_dists(nlist);
+    for(size_t c = 0; c < nlist; c++) {
+        centroid_dists[c] = {kernels.l2_squared(query, centroids.data() + c * num_dim, num_dim), c};
+    }
+
+    nprobe = std::min(std::max<size_t>(1, nprobe), nlist);
+    std::partial_sort(centroid_dists.begin(), centroid_dists.begin() + nprobe, centroid_dists.end());
+
+    std::vector<size_t> probes(nprobe);
+    for(size_t p = 0; p < nprobe; p++) {
+        probes[p] = centroid_dists[p].second;
+    }
+
+    std::vector<float> pq_table;
+    if(pq_m != 0) {
+        pq_table.resize(pq_m * PQ_NUM_CENTROIDS);
+        for(size_t m = 0; m < pq_m; m++) {
+            const float* codebook = pq_codebooks.data() + m * PQ_NUM_CENTROIDS * pq_dsub;
+            for(size_t c = 0; c < PQ_NUM_CENTROIDS; c++) {
+                pq_table[m * PQ_NUM_CENTROIDS + c] = kernels.inner_product(query + m * pq_dsub,
+                                                                           codebook + c * pq_dsub, pq_dsub);
+            }
+        }
+    }
+
+    // the filter functor is stateful, so filtered probes are scanned by this thread alone
+    const size_t num_tasks = (filter == nullptr && thread_pool != nullptr) ? std::min(nprobe, MAX_PROBE_TASKS) : 1;
+    const size_t probes_per_task = (nprobe + num_tasks - 1) / num_tasks;
+
+    std::vector<std::shared_ptr<pooled_task_t<std::vector<std::pair<float, size_t>>>>> tasks;
+    for(size_t begin = probes_per_task; begin < nprobe; begin += probes_per_task) {
+        const size_t end = std::min(nprobe, begin + probes_per_task);
+        tasks.push_back(pooled_task_t<std::vector<std::pair<float, size_t>>>::run(thread_pool,
+            [this, query, &pq_table, k, &probes, begin, end]() {
+                return scan(query, pq_table.data(), k, probes, begin, end, nullptr);
+            }
+        ));
+    }
+
+    auto dist_labels = scan(query, pq_table.data(), k, probes, 0, std::min(nprobe, probes_per_task), filter);
+
+    for(auto& task: tasks) {
+        const auto& task_dist_labels = task->get();
+        dist_labels.insert(dist_labels.end(), task_dist_labels.begin(), task_dist_labels.end());
+    }
+
+    std::sort(dist_labels.begin(), dist_labels.end());
+    if(dist_labels.size() > k) {
+        dist_labels.resize(k);
+    }
+
+    return dist_labels;
+}
+
+size_t ivf_index_t::size() const {
+    std::shared_lock lock(mutex);
+    return label_positions.size();
+}
@@ -8,9 +8,12 @@
 #include <unordered_map>
 #include <queue>
 #include <ctime>
+#include <random>
+#include <algorithm>
 #include "collection.h"
 #include "string_utils.h"
 #include "collection_manager.h"
+#include "vector_distance.h"
 
 using namespace std;
 
@@ -189,12 +192,162 @@ void generate_word_freq() {
     outfile.close();
 }
 
+void benchmark_vector_distance() {
+    using namespace vector_distance;
+
+    const size_t num_vectors = 10000;
+    const size_t num_rounds = 20;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1, 1);
+
+    for(size_t dim: {384, 768, 1536}) {
+        std::vector<float> vectors(num_vectors * dim);
+        std::vector<float> query(dim);
+        std::vector<float> normalized(dim);
+        std::generate(vectors.begin(), vectors.end(), [&](){ return dist(rng); });
+        std::generate(query.begin(), query.end(), [&](){ return dist(rng); });
+
+        for(isa_t isa: {isa_t::scalar, isa_t::sse, isa_t::avx2, isa_t::avx512}) {
+            const kernels_t& isa_kernels = get_kernels(isa);
+            if(isa_kernels.isa != isa) {
+                std::cout << "dim: " << dim << ", " << isa_name(isa) << ": not supported" << std::endl;
+                continue;
+            }
+
+            float total = 0;  // to prevent no-op optimization!
+            auto begin = std::chrono::high_resolution_clock::now();
+
+            for(size_t round = 0; round < num_rounds; round++) {
+                for(size_t i = 0; i < num_vectors; i++) {
+                    total += isa_kernels.inner_product(query.data(), vectors.data() + i * dim, dim);
+                }
+            }
+
+            auto ip_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::high_resolution_clock::now() - begin).count();
+            begin = std::chrono::high_resolution_clock::now();
+
+            for(size_t round = 0; round < num_rounds; round++) {
+                for(size_t i = 0; i < num_vectors; i++) {
+                    total += isa_kernels.l2_squared(query.data(), vectors.data() + i * dim, dim);
+                }
+            }
+
+            auto l2_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::high_resolution_clock::now() - begin).count();
+            begin = std::chrono::high_resolution_clock::now();
+
+            for(size_t round = 0; round < num_rounds; round++) {
+                for(size_t i = 0; i < num_vectors; i++) {
+                    isa_kernels.normalize(vectors.data() + i * dim, normalized.data(), dim);
+                    total += normalized[0];
+                }
+            }
+
+            auto normalize_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::high_resolution_clock::now() - begin).count();
+            const size_t num_ops = num_vectors * num_rounds;
+
+            std::cout << "dim: " << dim << ", " << isa_name(isa)
+                      << ", inner product: " << (ip_ns / num_ops) << "ns"
+                      << ", l2: " << (l2_ns / num_ops) << "ns"
+                      << ", normalize: " << (normalize_ns / num_ops) << "ns"
+                      << " (" << total << ")" << std::endl;
+        }
+    }
+}
+
+void benchmark_store_profiles(char* file_path) {
+    // documents of a JSONL file are stored with each tuning profile, and then fetched at random
+    std::vector<std::pair<std::string, store_tuning_t>> profiles;
+    profiles.emplace_back("default", store_tuning_t());
+
+    store_tuning_t cached;
+    cached.block_cache_mb = 256;
+    cached.bloom_filter_bits = 10;
+    profiles.emplace_back("cache_bloom", cached);
+
+    store_tuning_t partitioned = cached;
+    partitioned.partitioned_filters = true;
+    profiles.emplace_back("cache_bloom_partitioned", partitioned);
+
+    store_tuning_t compact = partitioned;
+    compact.compression = "zstd";
+    compact.compression_dict_kb = 16;
+    compact.write_buffer_mb = 64;
+    profiles.emplace_back("zstd_dict", compact);
+
+    std::vector<std::string> docs;
+    std::ifstream infile(file_path);
+    std::string json_line;
+    while (std::getline(infile, json_line)) {
+        docs.push_back(json_line);
+    }
+    infile.close();
+
+    const size_t num_fetches = 100000;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> dist(0, docs.size() - 1);
+
+    for(const auto& profile: profiles) {
+        const std::string& store_path = "/tmp/typesense-store-benchmark/" + profile.first;
+        system(("rm -rf " + store_path + " && mkdir -p " + store_path).c_str());
+
+        Store store(store_path, 24*60*60, 1024, true, 0, profile.second);
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        rocksdb::WriteBatch batch;
+
+        for(size_t i = 0; i < docs.size(); i++) {
+            batch.Put("0_$SI_" + StringUtils::serialize_uint32_t(i), docs[i]);
+            if(batch.Count() == 1000 || i == docs.size() - 1) {
+                store.batch_write(batch);
+                batch.Clear();
+            }
+        }
+
+        store.flush();
+        store.compact_all();
+
+        long long int write_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+
+        std::vector<long long int> fetch_ns;
+        fetch_ns.reserve(num_fetches);
+        size_t total_size = 0;  // to prevent no-op optimization!
+
+        for(size_t i = 0; i < num_fetches; i++) {
+            std::string value;
+            auto fetch_begin = std::chrono::high_resolution_clock::now();
+            store.get("0_$SI_" + StringUtils::serialize_uint32_t(dist(rng)), value);
+            fetch_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::high_resolution_clock::now() - fetch_begin).count());
+            total_size += value.size();
+        }
+
+        std::sort(fetch_ns.begin(), fetch_ns.end());
+        const long long int avg_ns = std::accumulate(fetch_ns.begin(), fetch_ns.end(), 0LL) / num_fetches;
+
+        std::string sst_size;
+        store._get_db_unsafe()->GetProperty("rocksdb.total-sst-files-size", &sst_size);
+
+        std::cout << profile.first
+                  << ", write + compaction: " << write_ms << "ms"
+                  << ", fetch avg: " << (avg_ns / 1000) << "us"
+                  << ", fetch p99: " << (fetch_ns[num_fetches * 99 / 100] / 1000) << "us"
+                  << ", disk: " << (std::stoull(sst_size) / 1048576) << "MB"
+                  << " (" << total_size << ")" << std::endl;
+    }
+}
+
 int main(int argc, char* argv[]) {
     srand(time(NULL));
 //    system("rm -rf /tmp/typesense-data && mkdir -p /tmp/typesense-data");
 
 //    benchmark_hn_titles(argv[1]);
 //    benchmark_reactjs_pages(argv[1]);
+//    benchmark_vector_distance();
+//    benchmark_store_profiles(argv[1]);
 
     generate_word_freq();
 
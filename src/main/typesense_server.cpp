@@ -85,6 +85,7 @@ void master_server_routes() {
     // meta
     server->get("/metrics.json", get_metrics_json);
     server->get("/stats.json", get_stats_json);
+    server->get("/metrics", get_stats_prometheus);
     server->get("/debug", get_debug);
     server->get("/health", get_health);
     server->get("/health_with_rusage", get_health_with_resource_usage);
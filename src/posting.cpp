@@ -287,6 +287,32 @@ void posting_t::upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& off
     list->upsert(id, offsets);
 }
 
+void posting_t::upsert_many(void*& obj, uint32_t num_ids, const uint32_t* ids, const uint32_t* offset_index,
+                            uint32_t num_offsets, const uint32_t* offsets) {
+    uint32_t i = 0;
+
+    // compact lists are small enough to be upserted one by one, until they are converted to a full list
+    while(i < num_ids && IS_COMPACT_POSTING(obj)) {
+        const uint32_t offsets_end = (i + 1 == num_ids) ? num_offsets : offset_index[i + 1];
+        std::vector<uint32_t> id_offsets(offsets + offset_index[i], offsets + offsets_end);
+        upsert(obj, ids[i], id_offsets);
+        i++;
+    }
+
+    if(i == num_ids) {
+        return;
+    }
+
+    std::vector<uint32_t> rest_offset_index(num_ids - i);
+    for(uint32_t j = i; j < num_ids; j++) {
+        rest_offset_index[j - i] = offset_index[j] - offset_index[i];
+    }
+
+    posting_list_t* list = (posting_list_t*)(obj);
+    list->upsert_many(num_ids - i, ids + i, rest_offset_index.data(), num_offsets - offset_index[i],
+                      offsets + offset_index[i]);
+}
+
 void posting_t::erase(void*& obj, uint32_t id) {
     if(IS_COMPACT_POSTING(obj)) {
         compact_posting_list_t* list = COMPACT_POSTING_PTR(obj);
@@ -497,6 +497,102 @@ void posting_list_t::upsert(const uint32_t id, const std::vector<uint32_t>& offs
     }
 }
 
+void posting_list_t::append_to_block(block_t* block, uint32_t num_ids, const uint32_t* ids,
+                                     const uint32_t* offset_index, const uint32_t* offsets, uint32_t offsets_end) {
+    const uint32_t num_existing_ids = block->ids.getLength();
+    const uint32_t num_existing_offsets = block->offsets.getLength();
+    const uint32_t num_new_offsets = offsets_end - offset_index[0];
+
+    uint32_t* raw_ids = new uint32_t[num_existing_ids + num_ids];
+    uint32_t* raw_offset_indices = new uint32_t[num_existing_ids + num_ids];
+    uint32_t* raw_offsets = new uint32_t[num_existing_offsets + num_new_offsets];
+
+    uint32_t m = std::numeric_limits<uint32_t>::max(), M = 0;
+
+    if(num_existing_ids != 0) {
+        uint32_t* existing_ids = block->ids.uncompress();
+        uint32_t* existing_offset_indices = block->offset_index.uncompress();
+        uint32_t* existing_offsets = block->offsets.uncompress();
+
+        std::memcpy(raw_ids, existing_ids, sizeof(uint32_t) * num_existing_ids);
+        std::memcpy(raw_offset_indices, existing_offset_indices, sizeof(uint32_t) * num_existing_ids);
+        std::memcpy(raw_offsets, existing_offsets, sizeof(uint32_t) * num_existing_offsets);
+
+        if(num_existing_offsets != 0) {
+            m = block->offsets.getMin();
+            M = block->offsets.getMax();
+        }
+
+        delete [] existing_ids;
+        delete [] existing_offset_indices;
+        delete [] existing_offsets;
+    }
+
+    for(uint32_t i = 0; i < num_ids; i++) {
+        raw_ids[num_existing_ids + i] = ids[i];
+        raw_offset_indices[num_existing_ids + i] = num_existing_offsets + (offset_index[i] - offset_index[0]);
+    }
+
+    for(uint32_t i = 0; i < num_new_offsets; i++) {
+        const uint32_t offset = offsets[offset_index[0] + i];
+        raw_offsets[num_existing_offsets + i] = offset;
+        m = std::min(m, offset);
+        M = std::max(M, offset);
+    }
+
+    if(num_existing_offsets + num_new_offsets == 0) {
+        m = 0;
+    }
+
+    block->ids.load(raw_ids, num_existing_ids + num_ids);
+    block->offset_index.load(raw_offset_indices, num_existing_ids + num_ids);
+    block->offsets.load(raw_offsets, num_existing_offsets + num_new_offsets, m, M);
+
+    delete [] raw_ids;
+    delete [] raw_offset_indices;
+    delete [] raw_offsets;
+}
+
+void posting_list_t::upsert_many(uint32_t num_ids, const uint32_t* ids, const uint32_t* offset_index,
+                                 uint32_t num_offsets, const uint32_t* offsets) {
+    auto get_offsets_end = [&](uint32_t i) {
+        return (i + 1 == num_ids) ? num_offsets : offset_index[i + 1];
+    };
+
+    uint32_t i = 0;
+
+    // IDs that are not beyond the last ID of the list have to be merged into existing blocks
+    while(i < num_ids && !id_block_map.empty() && ids[i] <= id_block_map.rbegin()->first) {
+        std::vector<uint32_t> id_offsets(offsets + offset_index[i], offsets + get_offsets_end(i));
+        upsert(ids[i], id_offsets);
+        i++;
+    }
+
+    block_t* block = id_block_map.empty() ? &root_block : id_block_map.rbegin()->second;
+
+    while(i < num_ids) {
+        if(block->size() >= BLOCK_MAX_ELEMENTS) {
+            block_t* new_block = new block_t;
+            new_block->next = block->next;
+            block->next = new_block;
+            block = new_block;
+        }
+
+        const uint32_t num_appended = std::min<uint32_t>(BLOCK_MAX_ELEMENTS - block->size(), num_ids - i);
+        const uint32_t offsets_end = get_offsets_end(i + num_appended - 1);
+
+        if(block->size() != 0) {
+            id_block_map.erase(block->ids.last());
+        }
+
+        append_to_block(block, num_appended, ids + i, offset_index + i, offsets, offsets_end);
+        id_block_map.emplace(block->ids.last(), block);
+
+        ids_length += num_appended;
+        i += num_appended;
+    }
+}
+
 void posting_list_t::dump() {
     auto it = new_iterator();
 
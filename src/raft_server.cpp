@@ -457,6 +457,7 @@ void ReplicationState::on_apply(braft::Iterator& iter) {
         }
 
         request_generated->log_index = iter.index();
+        last_applied_index = iter.index();
 
         // To avoid blocking the serial Raft write thread persist the log entry in local storage.
         // Actual operations will be done in collection-sharded batch indexing threads.
@@ -508,6 +509,23 @@ void* ReplicationState::save_snapshot(void* arg) {
         }
     }
 
+    // Saving the vector indices takes long for large graphs, so writes are not paused for it. They are reconciled
+    // with the db checkpoint when the snapshot is loaded.
+    CollectionManager::get_instance().save_vector_indices(sa->vector_index_snapshot_path,
+                                                          sa->replication_state->last_applied_index);
+
+    // vector index files are optional: they are rebuilt from the documents when missing
+    butil::FileEnumerator vector_index_dir_enum(butil::FilePath(sa->vector_index_snapshot_path), false,
+                                                butil::FileEnumerator::FILES);
+    for (butil::FilePath file = vector_index_dir_enum.Next(); !file.empty(); file = vector_index_dir_enum.Next()) {
+        auto file_name = std::string(vector_index_snapshot_name) + "/" + file.BaseName().value();
+        if (sa->writer->add_file(file_name) != 0) {
+            sa->done->status().set_error(EIO, "Fail to add vector index file to writer.");
+            sa->replication_state->snapshot_in_progress = false;
+            return nullptr;
+        }
+    }
+
     const std::string& temp_snapshot_dir = sa->writer->get_path();
 
     sa->done->Run();
@@ -556,6 +574,7 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     snapshot_in_progress = true;
     std::string db_snapshot_path = writer->get_path() + "/" + db_snapshot_name;
     std::string analytics_db_snapshot_path = writer->get_path() + "/" + analytics_db_snapshot_name;
+    std::string vector_index_snapshot_path = writer->get_path() + "/" + vector_index_snapshot_name;
 
     {
         // grab batch indexer lock so that we can take a clean snapshot
@@ -570,6 +589,9 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
         // this will block writes, but should be pretty fast
         batched_indexer->clear_skip_indices();
 
+        // vector indices saved with the snapshot must not be older than the db checkpoint
+        store->insert(CollectionManager::VECTOR_INDEX_SNAPSHOT_KEY, std::to_string(last_applied_index.load()));
+
         rocksdb::Checkpoint* checkpoint = nullptr;
         rocksdb::Status status = store->create_check_point(&checkpoint, db_snapshot_path);
         std::unique_ptr<rocksdb::Checkpoint> checkpoint_guard(checkpoint);
@@ -599,6 +621,7 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     arg->writer = writer;
     arg->state_dir_path = raft_dir_path;
     arg->db_snapshot_path = db_snapshot_path;
+    arg->vector_index_snapshot_path = vector_index_snapshot_path;
     arg->done = done;
 
     if(analytics_store) {
@@ -683,8 +706,14 @@ int ReplicationState::on_snapshot_load(braft::SnapshotReader* reader) {
         return reload_store;
     }
 
+    std::string vector_index_snapshot_path = reader->get_path();
+    vector_index_snapshot_path.append(std::string("/") + vector_index_snapshot_name);
+    CollectionManager::get_instance().set_vector_index_snapshot_path(vector_index_snapshot_path);
+
     bool init_db_status = init_db();
 
+    CollectionManager::get_instance().set_vector_index_snapshot_path("");
+
     return init_db_status;
 }
 
@@ -1024,6 +1053,10 @@ int64_t ReplicationState::get_num_queued_writes() {
     return batched_indexer->get_queued_writes();
 }
 
+void ReplicationState::get_write_queue_stats(nlohmann::json& stats) {
+    batched_indexer->get_queue_stats(stats);
+}
+
 bool ReplicationState::is_leader() {
     std::shared_lock lock(node_mutex);
 
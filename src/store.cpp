@@ -2,7 +2,7 @@
 
 Store::Store(const std::string & state_dir_path,
       const size_t wal_ttl_secs,
-      const size_t wal_size_mb, bool disable_wal, int32_t ttl):
+      const size_t wal_size_mb, bool disable_wal, int32_t ttl, const store_tuning_t& tuning):
       state_dir_path(state_dir_path){
     // Optimize RocksDB
     options.IncreaseParallelism();
@@ -28,10 +28,84 @@ Store::Store(const std::string & state_dir_path,
     // The replica uses native WAL, though.
     write_options.disableWAL = disable_wal;
 
+    apply_tuning(tuning);
+
     // open DB
     init_db(ttl);
 }
 
+void Store::apply_tuning(const store_tuning_t& tuning) {
+    if(tuning.write_buffer_mb == 0) {
+        LOG(ERROR) << "Write buffer size must be greater than zero, using the default write buffer size.";
+    } else {
+        options.write_buffer_size = tuning.write_buffer_mb * 1048576;
+    }
+
+    if(!tuning.compression.empty()) {
+        rocksdb::CompressionType compression_type;
+        if(tuning.compression == "snappy") {
+            compression_type = rocksdb::CompressionType::kSnappyCompression;
+        } else if(tuning.compression == "lz4") {
+            compression_type = rocksdb::CompressionType::kLZ4Compression;
+        } else if(tuning.compression == "zstd") {
+            compression_type = rocksdb::CompressionType::kZSTD;
+        } else if(tuning.compression == "none") {
+            compression_type = rocksdb::CompressionType::kNoCompression;
+        } else {
+            LOG(ERROR) << "Unknown compression: " << tuning.compression << ", using the default compression.";
+            compression_type = options.compression;
+        }
+
+        // compression libraries are optional dependencies of RocksDB: when the one of the configured compression
+        // is missing, opening the DB fails and is retried with these options
+        untuned_compression_options = options;
+        compression_tuned = true;
+
+        // `OptimizeLevelStyleCompaction()` sets the compression of each level, which takes precedence: the first two
+        // levels stay uncompressed, since they are rewritten soon
+        options.compression = compression_type;
+        options.bottommost_compression = compression_type;
+        for(size_t level = 2; level < options.compression_per_level.size(); level++) {
+            options.compression_per_level[level] = compression_type;
+        }
+
+        if(compression_type == rocksdb::CompressionType::kZSTD && tuning.compression_dict_kb != 0) {
+            // documents of a collection share most of their keys, which a dictionary compresses well
+            options.compression_opts.max_dict_bytes = tuning.compression_dict_kb * 1024;
+            options.compression_opts.zstd_max_train_bytes = options.compression_opts.max_dict_bytes * 100;
+            options.bottommost_compression_opts = options.compression_opts;
+            options.bottommost_compression_opts.enabled = true;
+        }
+    }
+
+    if(tuning.block_cache_mb == 0 && tuning.bloom_filter_bits == 0 && !tuning.partitioned_filters) {
+        return;
+    }
+
+    rocksdb::BlockBasedTableOptions table_options;
+
+    if(tuning.block_cache_mb != 0) {
+        table_options.block_cache = rocksdb::NewLRUCache(tuning.block_cache_mb * 1048576);
+    }
+
+    if(tuning.bloom_filter_bits != 0) {
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(tuning.bloom_filter_bits, false));
+    }
+
+    if(tuning.partitioned_filters) {
+        // the top level of the index and filters (and all of L0's, which is small and read often) is pinned in
+        // memory, while the partitions of the other levels are cached like data blocks
+        table_options.index_type = rocksdb::BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+        table_options.partition_filters = (tuning.bloom_filter_bits != 0);
+        table_options.cache_index_and_filter_blocks = true;
+        table_options.cache_index_and_filter_blocks_with_high_priority = true;
+        table_options.pin_top_level_index_and_filter = true;
+        table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+    }
+
+    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+}
+
 Store::~Store() {
     close();
 }
@@ -47,7 +121,45 @@ rocksdb::Status Store::init_db(int32_t ttl) {
                                      &dbWithTtl, ttl, false);
         db = dbWithTtl;
     } else {
-        s = rocksdb::DB::Open(options, state_dir_path, &db);
+        std::vector<std::string> family_names;
+        if(!rocksdb::DB::ListColumnFamilies(options, state_dir_path, &family_names).ok()) {
+            // DB does not exist yet
+            family_names = {rocksdb::kDefaultColumnFamilyName};
+        }
+
+        std::vector<rocksdb::ColumnFamilyDescriptor> family_descriptors;
+        for(const auto& family_name: family_names) {
+            family_descriptors.emplace_back(family_name, rocksdb::ColumnFamilyOptions(options));
+        }
+
+        s = rocksdb::DB::Open(options, state_dir_path, family_descriptors, &family_handles, &db);
+
+        for(size_t i = 0; s.ok() && i < family_names.size(); i++) {
+            if(family_names[i].rfind(COLLECTION_FAMILY_PREFIX, 0) != 0) {
+                continue;
+            }
+
+            const uint32_t collection_id = std::stoul(family_names[i].substr(std::string(COLLECTION_FAMILY_PREFIX).size()));
+            const std::string& migration_key = FAMILY_MIGRATION_PREFIX + std::to_string(collection_id);
+            std::string value;
+
+            if(db->Get(rocksdb::ReadOptions(), migration_key, &value).ok()) {
+                // the keys of the collection are still in the default family: migration is tried again on load
+                LOG(WARNING) << "Discarding the partially migrated column family of collection " << collection_id;
+                db->DropColumnFamily(family_handles[i]);
+                db->Delete(write_options, migration_key);
+                continue;
+            }
+
+            collection_families.emplace(collection_id, family_handles[i]);
+        }
+    }
+
+    if(!s.ok() && compression_tuned && (s.IsInvalidArgument() || s.IsNotSupported())) {
+        LOG(ERROR) << "Error while initializing store with the configured compression: " << s.ToString()
+                   << ", using the default compression.";
+        restore_untuned_compression();
+        return init_db(ttl);
     }
 
     if(!s.ok()) {
@@ -64,9 +176,56 @@ rocksdb::Status Store::init_db(int32_t ttl) {
     return s;
 }
 
+void Store::restore_untuned_compression() {
+    options.compression = untuned_compression_options.compression;
+    options.bottommost_compression = untuned_compression_options.bottommost_compression;
+    options.compression_per_level = untuned_compression_options.compression_per_level;
+    options.compression_opts = untuned_compression_options.compression_opts;
+    options.bottommost_compression_opts = untuned_compression_options.bottommost_compression_opts;
+    compression_tuned = false;
+}
+
+void Store::close_db() {
+    for(auto family_handle: family_handles) {
+        db->DestroyColumnFamilyHandle(family_handle);
+    }
+
+    family_handles.clear();
+    collection_families.clear();
+
+    delete db;
+    db = nullptr;
+}
+
+std::string Store::get_family_name(uint32_t collection_id) {
+    return std::string(COLLECTION_FAMILY_PREFIX) + std::to_string(collection_id);
+}
+
+rocksdb::ColumnFamilyHandle* Store::get_family(const rocksdb::Slice& key) const {
+    if(collection_families.empty()) {
+        return db->DefaultColumnFamily();
+    }
+
+    // keys of a collection begin with `<collection_id>_`
+    uint64_t collection_id = 0;
+    size_t i = 0;
+
+    while(i < key.size() && i < 10 && key[i] >= '0' && key[i] <= '9') {
+        collection_id = collection_id * 10 + (key[i] - '0');
+        i++;
+    }
+
+    if(i == 0 || i == key.size() || key[i] != '_' || collection_id > UINT32_MAX) {
+        return db->DefaultColumnFamily();
+    }
+
+    auto family_it = collection_families.find(collection_id);
+    return (family_it == collection_families.end()) ? db->DefaultColumnFamily() : family_it->second;
+}
+
 bool Store::insert(const std::string& key, const std::string& value) {
     std::shared_lock lock(mutex);
-    rocksdb::Status status = db->Put(write_options, key, value);
+    rocksdb::Status status = db->Put(write_options, get_family(key), key, value);
     return status.ok();
 }
 
@@ -76,12 +235,17 @@ bool Store::batch_write(rocksdb::WriteBatch& batch) {
     return status.ok();
 }
 
+void Store::batch_put(rocksdb::WriteBatch& batch, const std::string& key, const std::string& value) const {
+    std::shared_lock lock(mutex);
+    batch.Put(get_family(key), key, value);
+}
+
 bool Store::contains(const std::string& key) const {
     std::shared_lock lock(mutex);
 
     std::string value;
     bool value_found;
-    bool key_may_exist = db->KeyMayExist(rocksdb::ReadOptions(), key, &value, &value_found);
+    bool key_may_exist = db->KeyMayExist(rocksdb::ReadOptions(), get_family(key), key, &value, &value_found);
 
     // returns false when key definitely does not exist
     if(!key_may_exist) {
@@ -93,13 +257,13 @@ bool Store::contains(const std::string& key) const {
     }
 
     // otherwise, we have try getting the value
-    rocksdb::Status status = db->Get(rocksdb::ReadOptions(), key, &value);
+    rocksdb::Status status = db->Get(rocksdb::ReadOptions(), get_family(key), key, &value);
     return status.ok() && !status.IsNotFound();
 }
 
 StoreStatus Store::get(const std::string& key, std::string& value) const {
     std::shared_lock lock(mutex);
-    rocksdb::Status status = db->Get(rocksdb::ReadOptions(), key, &value);
+    rocksdb::Status status = db->Get(rocksdb::ReadOptions(), get_family(key), key, &value);
 
     if(status.ok()) {
         return StoreStatus::FOUND;
@@ -115,7 +279,7 @@ StoreStatus Store::get(const std::string& key, std::string& value) const {
 
 bool Store::remove(const std::string& key) {
     std::shared_lock lock(mutex);
-    rocksdb::Status status = db->Delete(write_options, key);
+    rocksdb::Status status = db->Delete(write_options, get_family(key), key);
     return status.ok();
 }
 
@@ -125,7 +289,7 @@ rocksdb::Iterator* Store::scan(const std::string & prefix, const rocksdb::Slice*
     if(iterate_upper_bound) {
         read_opts.iterate_upper_bound = iterate_upper_bound;
     }
-    rocksdb::Iterator *iter = db->NewIterator(read_opts);
+    rocksdb::Iterator *iter = db->NewIterator(read_opts, get_family(prefix));
     iter->Seek(prefix);
     return iter;
 }
@@ -142,7 +306,7 @@ void Store::scan_fill(const std::string& prefix_start, const std::string& prefix
     read_opts.iterate_upper_bound = &upper_bound;
 
     std::shared_lock lock(mutex);
-    rocksdb::Iterator *iter = db->NewIterator(read_opts);
+    rocksdb::Iterator *iter = db->NewIterator(read_opts, get_family(prefix_start));
     for (iter->Seek(prefix_start); iter->Valid() && iter->key().starts_with(prefix_start); iter->Next()) {
         values.push_back(iter->value().ToString());
     }
@@ -152,7 +316,7 @@ void Store::scan_fill(const std::string& prefix_start, const std::string& prefix
 
 void Store::increment(const std::string & key, uint32_t value) {
     std::shared_lock lock(mutex);
-    db->Merge(write_options, key, StringUtils::serialize_uint32_t(value));
+    db->Merge(write_options, get_family(key), key, StringUtils::serialize_uint32_t(value));
 }
 
 uint64_t Store::get_latest_seq_number() const {
@@ -226,16 +390,14 @@ Option<std::vector<std::string>*> Store::get_updates_since(const uint64_t seq_nu
 
 void Store::close() {
     std::unique_lock lock(mutex);
-    delete db;
-    db = nullptr;
+    close_db();
 }
 
 int Store::reload(bool clear_state_dir, const std::string& snapshot_path, int32_t ttl) {
     std::unique_lock lock(mutex);
 
     // we don't use close() to avoid nested lock and because lock is required until db is re-initialized
-    delete db;
-    db = nullptr;
+    close_db();
 
     if(clear_state_dir) {
         if (!delete_path(state_dir_path, true)) {
@@ -276,11 +438,21 @@ void Store::flush() {
     std::shared_lock lock(mutex);
     rocksdb::FlushOptions options;
     db->Flush(options);
+
+    for(const auto& kv: collection_families) {
+        db->Flush(options, kv.second);
+    }
 }
 
 rocksdb::Status Store::compact_all() {
     std::shared_lock lock(mutex);
-    return db->CompactRange(rocksdb::CompactRangeOptions(), nullptr, nullptr);
+    rocksdb::Status status = db->CompactRange(rocksdb::CompactRangeOptions(), nullptr, nullptr);
+
+    for(auto it = collection_families.begin(); status.ok() && it != collection_families.end(); it++) {
+        status = db->CompactRange(rocksdb::CompactRangeOptions(), it->second, nullptr, nullptr);
+    }
+
+    return status;
 }
 
 rocksdb::Status Store::create_check_point(rocksdb::Checkpoint** checkpoint_ptr, const std::string& db_snapshot_path) {
@@ -303,12 +475,145 @@ rocksdb::Status Store::create_check_point(rocksdb::Checkpoint** checkpoint_ptr,
 
 rocksdb::Status Store::delete_range(const std::string& begin_key, const std::string& end_key) {
     std::shared_lock lock(mutex);
-    return db->DeleteRange(rocksdb::WriteOptions(), db->DefaultColumnFamily(), begin_key, end_key);
+    return db->DeleteRange(rocksdb::WriteOptions(), get_family(begin_key), begin_key, end_key);
 }
 
 rocksdb::Status Store::compact_range(const rocksdb::Slice& begin_key, const rocksdb::Slice& end_key) {
     std::shared_lock lock(mutex);
-    return db->CompactRange(rocksdb::CompactRangeOptions(), &begin_key, &end_key);
+    return db->CompactRange(rocksdb::CompactRangeOptions(), get_family(begin_key), &begin_key, &end_key);
+}
+
+bool Store::has_collection_family(uint32_t collection_id) const {
+    std::shared_lock lock(mutex);
+    return collection_families.count(collection_id) != 0;
+}
+
+bool Store::create_collection_family(uint32_t collection_id) {
+    std::unique_lock lock(mutex);
+    if(collection_families.count(collection_id) != 0) {
+        return true;
+    }
+
+    rocksdb::ColumnFamilyHandle* family_handle = nullptr;
+    rocksdb::Status status = db->CreateColumnFamily(rocksdb::ColumnFamilyOptions(options),
+                                                    get_family_name(collection_id), &family_handle);
+    if(!status.ok()) {
+        LOG(ERROR) << "Error while creating column family of collection " << collection_id << ": "
+                   << status.ToString();
+        return false;
+    }
+
+    family_handles.push_back(family_handle);
+    collection_families.emplace(collection_id, family_handle);
+    return true;
+}
+
+bool Store::drop_collection_family(uint32_t collection_id) {
+    std::unique_lock lock(mutex);
+    auto family_it = collection_families.find(collection_id);
+    if(family_it == collection_families.end()) {
+        return false;
+    }
+
+    rocksdb::Status status = db->DropColumnFamily(family_it->second);
+    if(!status.ok()) {
+        LOG(ERROR) << "Error while dropping column family of collection " << collection_id << ": "
+                   << status.ToString();
+        return false;
+    }
+
+    collection_families.erase(family_it);
+    return true;
+}
+
+bool Store::migrate_to_collection_family(uint32_t collection_id) {
+    const std::string& begin_key = std::to_string(collection_id) + "_";
+    const std::string& end_key = std::to_string(collection_id) + "`";
+    const std::string& migration_key = FAMILY_MIGRATION_PREFIX + std::to_string(collection_id);
+
+    std::shared_lock lock(mutex);
+    if(collection_families.count(collection_id) != 0) {
+        return true;
+    }
+
+    // The migration key is removed only along with the keys of the collection in the default family, so that the
+    // family of a migration that was interrupted is discarded when the DB is opened again. Since the WAL is not used,
+    // the key is flushed before the family is created, and the family is flushed before the default family.
+    rocksdb::Status status = db->Put(write_options, migration_key, "");
+    if(status.ok()) {
+        status = db->Flush(rocksdb::FlushOptions());
+    }
+
+    rocksdb::ColumnFamilyHandle* family_handle = nullptr;
+    if(status.ok()) {
+        status = db->CreateColumnFamily(rocksdb::ColumnFamilyOptions(options), get_family_name(collection_id),
+                                        &family_handle);
+    }
+
+    if(status.ok()) {
+        rocksdb::ReadOptions read_opts;
+        rocksdb::Slice upper_bound(end_key);
+        read_opts.iterate_upper_bound = &upper_bound;
+
+        rocksdb::Iterator* iter = db->NewIterator(read_opts, db->DefaultColumnFamily());
+        rocksdb::WriteBatch batch;
+
+        for(iter->Seek(begin_key); status.ok() && iter->Valid(); iter->Next()) {
+            batch.Put(family_handle, iter->key(), iter->value());
+            if(batch.Count() == FAMILY_MIGRATION_BATCH_SIZE) {
+                status = db->Write(write_options, &batch);
+                batch.Clear();
+            }
+        }
+
+        if(status.ok()) {
+            status = iter->status();
+        }
+
+        delete iter;
+
+        if(status.ok()) {
+            status = db->Write(write_options, &batch);
+        }
+
+        if(status.ok()) {
+            status = db->Flush(rocksdb::FlushOptions(), family_handle);
+        }
+
+        if(status.ok()) {
+            batch.Clear();
+            batch.DeleteRange(db->DefaultColumnFamily(), begin_key, end_key);
+            batch.Delete(db->DefaultColumnFamily(), migration_key);
+            status = db->Write(write_options, &batch);
+        }
+
+        if(status.ok()) {
+            // the migration is complete even if this fails: it is only repeated if the DB goes down before a flush
+            db->Flush(rocksdb::FlushOptions());
+        }
+    }
+
+    lock.unlock();
+    std::unique_lock ulock(mutex);
+
+    if(family_handle != nullptr) {
+        family_handles.push_back(family_handle);
+    }
+
+    if(!status.ok()) {
+        LOG(ERROR) << "Error while moving collection " << collection_id << " into its own column family: "
+                   << status.ToString();
+
+        if(family_handle != nullptr) {
+            db->DropColumnFamily(family_handle);
+        }
+
+        db->Delete(write_options, migration_key);
+        return false;
+    }
+
+    collection_families.emplace(collection_id, family_handle);
+    return true;
 }
 
 rocksdb::DB* Store::_get_db_unsafe() const {
@@ -6,6 +6,8 @@
 #include <sstream>
 #include <filesystem>
 #include <dlfcn.h>
+#include <chrono>
+#include <iterator>
 
 TextEmbedder::TextEmbedder(const std::string& model_name) {
     // create environment for local model
@@ -120,73 +122,65 @@ std::vector<float> TextEmbedder::mean_pooling(const std::vector<std::vector<floa
 embedding_res_t TextEmbedder::Embed(const std::string& text, const size_t remote_embedder_timeout_ms, const size_t remote_embedding_num_tries) {
     if(is_remote()) {
         return remote_embedder_->Embed(text, remote_embedder_timeout_ms, remote_embedding_num_tries);
-    } else {
-        // Cannot run same model in parallel, so lock the mutex
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto encoded_input = tokenizer_->Encode(text);
-        // create input tensor object from data values
-        Ort::AllocatorWithDefaultOptions allocator;
-        Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-        std::vector<Ort::Value> input_tensors;
-        std::vector<std::vector<int64_t>> input_shapes;
-        std::vector<const char*> input_node_names = {"input_ids", "attention_mask"};
-        // If model is DistilBERT or sentencepiece, it has 2 inputs, else it has 3 inputs
-        if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-            input_node_names.push_back("token_type_ids");
-        } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-            input_node_names.push_back("pixel_values");
+    }
+
+    // Concurrent queries are run through the model together. The first waiting caller becomes the leader: it collects
+    // the requests that arrive within a short window and runs them as a single batch, while the others wait. A lone
+    // caller does not wait for the window, so that queries on an idle server don't pay for it.
+    pending_embedding_t request(text);
+
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    pending_embeddings_.push_back(&request);
+    pending_cv_.notify_all();
+
+    while(!request.done) {
+        if(batch_leader_active_) {
+            pending_cv_.wait(lock);
+            continue;
         }
-        input_shapes.push_back({1, static_cast<int64_t>(encoded_input.input_ids.size())});
-        input_shapes.push_back({1, static_cast<int64_t>(encoded_input.attention_mask.size())});
-        if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-            // edge case: xlm_roberta does not have token_type_ids, but if the model has it as input, we need to fill it with 0s
-            if(encoded_input.token_type_ids.size() == 0) {
-                encoded_input.token_type_ids.resize(encoded_input.input_ids.size(), 0);
-            }
 
-            input_shapes.push_back({1, static_cast<int64_t>(encoded_input.token_type_ids.size())});
-        } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-            // dummy input for clip
-            input_shapes.push_back({1, 3, 224, 224});
+        batch_leader_active_ = true;
+        if(pending_embeddings_.size() > 1) {
+            pending_cv_.wait_for(lock, std::chrono::microseconds(QUERY_BATCH_WINDOW_US), [&]() {
+                return pending_embeddings_.size() >= QUERY_BATCH_MAX_SIZE;
+            });
         }
-        input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, encoded_input.input_ids.data(), encoded_input.input_ids.size(), input_shapes[0].data(), input_shapes[0].size()));
-        input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, encoded_input.attention_mask.data(), encoded_input.attention_mask.size(), input_shapes[1].data(), input_shapes[1].size()));
-        if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, encoded_input.token_type_ids.data(), encoded_input.token_type_ids.size(), input_shapes[2].data(), input_shapes[2].size()));
-        } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-            // dummy input for clip
-            std::vector<float> pixel_values(3 * 224 * 224, 0.5);
-            input_tensors.push_back(Ort::Value::CreateTensor<float>(memory_info, pixel_values.data(), pixel_values.size(), input_shapes[2].data(), input_shapes[2].size()));
+
+        const size_t batch_size = std::min(pending_embeddings_.size(), QUERY_BATCH_MAX_SIZE);
+        std::vector<pending_embedding_t*> batch(pending_embeddings_.begin(), pending_embeddings_.begin() + batch_size);
+        pending_embeddings_.erase(pending_embeddings_.begin(), pending_embeddings_.begin() + batch_size);
+        lock.unlock();
+
+        std::vector<std::string> inputs;
+        inputs.reserve(batch.size());
+        for(const auto pending: batch) {
+            inputs.push_back(pending->text);
         }
 
-        //LOG(INFO) << "Running model";
-        // create output tensor object
-        std::vector<const char*> output_node_names = {output_tensor_name.c_str()};
-        auto output_tensor = session_->Run(Ort::RunOptions{nullptr}, input_node_names.data(), input_tensors.data(), input_tensors.size(), output_node_names.data(), output_node_names.size());
-        std::vector<std::vector<float>> output;
-        float* data = output_tensor[0].GetTensorMutableData<float>();
-        // print output tensor shape
-        auto shape = output_tensor[0].GetTensorTypeAndShapeInfo().GetShape();
-        // edge case for clip model
-        if(shape.size() == 2) {
-            // insert 1 to index 0
-            shape.insert(shape.begin(), 1);
+        std::vector<embedding_res_t> outputs;
+        try {
+            std::lock_guard<std::mutex> model_lock(mutex_);
+            outputs = run_batch(inputs);
+        } catch(const std::exception& e) {
+            LOG(ERROR) << "Error while embedding a batch of " << inputs.size() << " queries: " << e.what();
+            outputs.clear();
         }
 
-        for (int i = 0; i < shape[1]; i++) {
-            std::vector<float> temp;
-            for (int j = 0; j < shape[2]; j++) {
-                temp.push_back(data[i * shape[2] + j]);
-            }
-            // edge case for clip model
-            if(tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                return embedding_res_t(temp);
-            }
-            output.push_back(temp);
+        if(outputs.size() != batch.size()) {
+            outputs.assign(batch.size(), embedding_res_t(500, nlohmann::json({{"error", "Failed to embed the query."}})));
+        }
+
+        lock.lock();
+        for(size_t i = 0; i < batch.size(); i++) {
+            batch[i]->result = std::move(outputs[i]);
+            batch[i]->done = true;
         }
-        auto pooled_output = mean_pooling(output, encoded_input.attention_mask);
-        return embedding_res_t(pooled_output);
+
+        batch_leader_active_ = false;
+        pending_cv_.notify_all();
     }
+
+    return std::move(request.result);
 }
 
 std::vector<embedding_res_t> TextEmbedder::batch_embed(const std::vector<std::string>& inputs, const size_t remote_embedding_batch_size,
@@ -196,108 +190,116 @@ std::vector<embedding_res_t> TextEmbedder::batch_embed(const std::vector<std::st
         std::lock_guard<std::mutex> lock(mutex_);
         for(int i = 0; i < inputs.size(); i += 8) {
             auto input_batch = std::vector<std::string>(inputs.begin() + i, inputs.begin() + std::min(i + 8, static_cast<int>(inputs.size())));
-            auto encoded_inputs = batch_encode(input_batch);
-            
-            // create input tensor object from data values
-            Ort::AllocatorWithDefaultOptions allocator;
-            Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-            std::vector<Ort::Value> input_tensors;
-            std::vector<std::vector<int64_t>> input_shapes;
-            std::vector<const char*> input_node_names = {"input_ids", "attention_mask"};
-            // If model is DistilBERT or sentencepiece, it has 2 inputs, else it has 3 inputs
-            if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                input_node_names.push_back("token_type_ids");
-            } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                input_node_names.push_back("pixel_values");
-            }
+            auto batch_outputs = run_batch(input_batch);
+            std::move(batch_outputs.begin(), batch_outputs.end(), std::back_inserter(outputs));
+        }
+    } else {
+        outputs = std::move(remote_embedder_->batch_embed(inputs, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries));
+    }
+    
+    return outputs;
+}
 
-            input_shapes.push_back({static_cast<int64_t>(encoded_inputs.input_ids.size()), static_cast<int64_t>(encoded_inputs.input_ids[0].size())});
-            input_shapes.push_back({static_cast<int64_t>(encoded_inputs.attention_mask.size()), static_cast<int64_t>(encoded_inputs.attention_mask[0].size())});
-            if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                input_shapes.push_back({static_cast<int64_t>(encoded_inputs.token_type_ids.size()), static_cast<int64_t>(encoded_inputs.token_type_ids[0].size())});
-            } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                // dummy input for clip
-                input_shapes.push_back({1, 3, 224, 224});
-            }
+std::vector<embedding_res_t> TextEmbedder::run_batch(const std::vector<std::string>& input_batch) {
+    std::vector<embedding_res_t> outputs;
+    auto encoded_inputs = batch_encode(input_batch);
+    
+    // create input tensor object from data values
+    Ort::AllocatorWithDefaultOptions allocator;
+    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    std::vector<Ort::Value> input_tensors;
+    std::vector<std::vector<int64_t>> input_shapes;
+    std::vector<const char*> input_node_names = {"input_ids", "attention_mask"};
+    // If model is DistilBERT or sentencepiece, it has 2 inputs, else it has 3 inputs
+    if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
+        input_node_names.push_back("token_type_ids");
+    } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
+        input_node_names.push_back("pixel_values");
+    }
 
-            std::vector<int64_t> input_ids_flatten;
-            std::vector<int64_t> attention_mask_flatten;
-            std::vector<int64_t> token_type_ids_flatten;
+    input_shapes.push_back({static_cast<int64_t>(encoded_inputs.input_ids.size()), static_cast<int64_t>(encoded_inputs.input_ids[0].size())});
+    input_shapes.push_back({static_cast<int64_t>(encoded_inputs.attention_mask.size()), static_cast<int64_t>(encoded_inputs.attention_mask[0].size())});
+    if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
+        input_shapes.push_back({static_cast<int64_t>(encoded_inputs.token_type_ids.size()), static_cast<int64_t>(encoded_inputs.token_type_ids[0].size())});
+    } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
+        // dummy input for clip
+        input_shapes.push_back({1, 3, 224, 224});
+    }
 
-            for (int i = 0; i < encoded_inputs.input_ids.size(); i++) {
-                for (int j = 0; j < encoded_inputs.input_ids[i].size(); j++) {
-                    input_ids_flatten.push_back(encoded_inputs.input_ids[i][j]);
-                }
-            }
+    std::vector<int64_t> input_ids_flatten;
+    std::vector<int64_t> attention_mask_flatten;
+    std::vector<int64_t> token_type_ids_flatten;
 
-            for (int i = 0; i < encoded_inputs.attention_mask.size(); i++) {
-                for (int j = 0; j < encoded_inputs.attention_mask[i].size(); j++) {
-                    attention_mask_flatten.push_back(encoded_inputs.attention_mask[i][j]);
-                }
-            }
+    for (int i = 0; i < encoded_inputs.input_ids.size(); i++) {
+        for (int j = 0; j < encoded_inputs.input_ids[i].size(); j++) {
+            input_ids_flatten.push_back(encoded_inputs.input_ids[i][j]);
+        }
+    }
 
-            if(session_->GetInputCount() == 3) {
-                for (int i = 0; i < encoded_inputs.token_type_ids.size(); i++) {
-                    for (int j = 0; j < encoded_inputs.token_type_ids[i].size(); j++) {
-                        token_type_ids_flatten.push_back(encoded_inputs.token_type_ids[i][j]);
-                    }
-                }
-            }
+    for (int i = 0; i < encoded_inputs.attention_mask.size(); i++) {
+        for (int j = 0; j < encoded_inputs.attention_mask[i].size(); j++) {
+            attention_mask_flatten.push_back(encoded_inputs.attention_mask[i][j]);
+        }
+    }
 
-            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, input_ids_flatten.data(), input_ids_flatten.size(), input_shapes[0].data(), input_shapes[0].size()));
-            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, attention_mask_flatten.data(), attention_mask_flatten.size(), input_shapes[1].data(), input_shapes[1].size()));
-            if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, token_type_ids_flatten.data(), token_type_ids_flatten.size(), input_shapes[2].data(), input_shapes[2].size()));
-            } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                // dummy input for clip
-                std::vector<float> pixel_values(3 * 224 * 224, 0.5);
-                input_tensors.push_back(Ort::Value::CreateTensor<float>(memory_info, pixel_values.data(), pixel_values.size(), input_shapes[2].data(), input_shapes[2].size()));
+    if(session_->GetInputCount() == 3) {
+        for (int i = 0; i < encoded_inputs.token_type_ids.size(); i++) {
+            for (int j = 0; j < encoded_inputs.token_type_ids[i].size(); j++) {
+                token_type_ids_flatten.push_back(encoded_inputs.token_type_ids[i][j]);
             }
+        }
+    }
 
-            //LOG(INFO) << "Running model";
-            // create output tensor object
-            std::vector<const char*> output_node_names = {output_tensor_name.c_str()};
+    input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, input_ids_flatten.data(), input_ids_flatten.size(), input_shapes[0].data(), input_shapes[0].size()));
+    input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, attention_mask_flatten.data(), attention_mask_flatten.size(), input_shapes[1].data(), input_shapes[1].size()));
+    if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
+        input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, token_type_ids_flatten.data(), token_type_ids_flatten.size(), input_shapes[2].data(), input_shapes[2].size()));
+    } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
+        // dummy input for clip
+        std::vector<float> pixel_values(3 * 224 * 224, 0.5);
+        input_tensors.push_back(Ort::Value::CreateTensor<float>(memory_info, pixel_values.data(), pixel_values.size(), input_shapes[2].data(), input_shapes[2].size()));
+    }
 
-            // if seq length is 0, return empty vector
-            if(input_shapes[0][1] == 0) {
-                for(int i = 0; i < input_batch.size(); i++) {
-                    outputs.push_back(embedding_res_t(400, nlohmann::json({{"error", "Invalid input: empty sequence"}})));
-                }
-                continue;
-            }
+    //LOG(INFO) << "Running model";
+    // create output tensor object
+    std::vector<const char*> output_node_names = {output_tensor_name.c_str()};
 
-            auto output_tensor = session_->Run(Ort::RunOptions{nullptr}, input_node_names.data(), input_tensors.data(), input_tensors.size(), output_node_names.data(), output_node_names.size());
-            float* data = output_tensor[0].GetTensorMutableData<float>();
-            // print output tensor shape
-            auto shape = output_tensor[0].GetTensorTypeAndShapeInfo().GetShape();
-            // edge case for clip model
-            if(shape.size() == 2) {
-                // insert 1 to index 0
-                shape.insert(shape.begin(), 1);
+    // if seq length is 0, return empty vector
+    if(input_shapes[0][1] == 0) {
+        for(int i = 0; i < input_batch.size(); i++) {
+            outputs.push_back(embedding_res_t(400, nlohmann::json({{"error", "Invalid input: empty sequence"}})));
+        }
+        return outputs;
+    }
+
+    auto output_tensor = session_->Run(Ort::RunOptions{nullptr}, input_node_names.data(), input_tensors.data(), input_tensors.size(), output_node_names.data(), output_node_names.size());
+    float* data = output_tensor[0].GetTensorMutableData<float>();
+    // print output tensor shape
+    auto shape = output_tensor[0].GetTensorTypeAndShapeInfo().GetShape();
+    // edge case for clip model
+    if(shape.size() == 2) {
+        // insert 1 to index 0
+        shape.insert(shape.begin(), 1);
+    }
+    for (int i = 0; i < shape[0]; i++) {
+        std::vector<std::vector<float>> output;
+        for (int j = 0; j < shape[1]; j++) {
+            std::vector<float> output_row;
+            for (int k = 0; k < shape[2]; k++) {
+                output_row.push_back(data[i * shape[1] * shape[2] + j * shape[2] + k]);
             }
-            for (int i = 0; i < shape[0]; i++) {
-                std::vector<std::vector<float>> output;
-                for (int j = 0; j < shape[1]; j++) {
-                    std::vector<float> output_row;
-                    for (int k = 0; k < shape[2]; k++) {
-                        output_row.push_back(data[i * shape[1] * shape[2] + j * shape[2] + k]);
-                    }
-                    if(tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                        // no mean pooling for clip
-                        outputs.push_back(embedding_res_t(output_row));
-                        continue;
-                    }
-                    output.push_back(output_row);
-                }
-                if(tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                    outputs.push_back(embedding_res_t(mean_pooling(output, encoded_inputs.attention_mask[i])));
-                }
+            if(tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
+                // no mean pooling for clip
+                outputs.push_back(embedding_res_t(output_row));
+                continue;
             }
+            output.push_back(output_row);
+        }
+        if(tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
+            outputs.push_back(embedding_res_t(mean_pooling(output, encoded_inputs.attention_mask[i])));
         }
-    } else {
-        outputs = std::move(remote_embedder_->batch_embed(inputs, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries));
     }
-    
+
     return outputs;
 }
 
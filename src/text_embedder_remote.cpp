@@ -1,3 +1,5 @@
+#include <atomic>
+#include <thread>
 #include <http_proxy.h>
 #include "text_embedder_remote.h"
 #include "embedder_manager.h"
@@ -169,11 +171,32 @@ std::vector<embedding_res_t> OpenAIEmbedder::batch_embed(const std::vector<std::
                                                          const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries) {
     // call recursively if inputs larger than remote_embedding_batch_size
     if(inputs.size() > remote_embedding_batch_size) {
+        const size_t num_batches = (inputs.size() + remote_embedding_batch_size - 1) / remote_embedding_batch_size;
+        std::vector<std::vector<embedding_res_t>> batch_outputs(num_batches);
+        std::atomic<size_t> next_batch = 0;
+
+        auto embed_batches = [&]() {
+            for(size_t batch_index = next_batch++; batch_index < num_batches; batch_index = next_batch++) {
+                const size_t i = batch_index * remote_embedding_batch_size;
+                auto batch = std::vector<std::string>(inputs.begin() + i, inputs.begin() + std::min(i + remote_embedding_batch_size, inputs.size()));
+                batch_outputs[batch_index] = batch_embed(batch, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries);
+            }
+        };
+
+        std::vector<std::thread> batch_threads;
+        for(size_t t = 1; t < std::min(num_batches, MAX_CONCURRENT_BATCHES); t++) {
+            batch_threads.emplace_back(embed_batches);
+        }
+
+        embed_batches();
+
+        for(auto& batch_thread: batch_threads) {
+            batch_thread.join();
+        }
+
         std::vector<embedding_res_t> outputs;
-        for(size_t i = 0; i < inputs.size(); i += remote_embedding_batch_size) {
-            auto batch = std::vector<std::string>(inputs.begin() + i, inputs.begin() + std::min(i + remote_embedding_batch_size, inputs.size()));
-            auto batch_outputs = batch_embed(batch, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries);
-            outputs.insert(outputs.end(), batch_outputs.begin(), batch_outputs.end());
+        for(auto& outputs_of_batch: batch_outputs) {
+            outputs.insert(outputs.end(), outputs_of_batch.begin(), outputs_of_batch.end());
         }
         return outputs;
     }
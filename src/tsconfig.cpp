@@ -213,6 +213,44 @@ void Config::load_config_env() {
         this->cache_num_entries = std::stoi(get_env("TYPESENSE_CACHE_NUM_ENTRIES"));
     }
 
+    if(!get_env("TYPESENSE_EMBEDDING_CACHE_NUM_ENTRIES").empty()) {
+        this->embedding_cache_num_entries = std::stoi(get_env("TYPESENSE_EMBEDDING_CACHE_NUM_ENTRIES"));
+    }
+
+    this->async_embedding = ("TRUE" == get_env("TYPESENSE_ASYNC_EMBEDDING"));
+
+    if(!get_env("TYPESENSE_ASYNC_EMBEDDING_CONCURRENCY").empty()) {
+        this->async_embedding_concurrency = std::stoi(get_env("TYPESENSE_ASYNC_EMBEDDING_CONCURRENCY"));
+    }
+
+    if(!get_env("TYPESENSE_ASYNC_EMBEDDING_NUM_TRIES").empty()) {
+        this->async_embedding_num_tries = std::stoi(get_env("TYPESENSE_ASYNC_EMBEDDING_NUM_TRIES"));
+    }
+
+    if(!get_env("TYPESENSE_ASYNC_EMBEDDING_BATCH_SIZE").empty()) {
+        this->async_embedding_batch_size = std::stoi(get_env("TYPESENSE_ASYNC_EMBEDDING_BATCH_SIZE"));
+    }
+
+    if(!get_env("TYPESENSE_ASYNC_EMBEDDING_TIMEOUT_MS").empty()) {
+        this->async_embedding_timeout_ms = std::stoi(get_env("TYPESENSE_ASYNC_EMBEDDING_TIMEOUT_MS"));
+    }
+
+    if(!get_env("TYPESENSE_MAX_COALESCED_WRITES").empty()) {
+        this->max_coalesced_writes = std::stoi(get_env("TYPESENSE_MAX_COALESCED_WRITES"));
+    }
+
+    if(!get_env("TYPESENSE_WRITE_COALESCING_WINDOW_MS").empty()) {
+        this->write_coalescing_window_ms = std::stoi(get_env("TYPESENSE_WRITE_COALESCING_WINDOW_MS"));
+    }
+
+    if(!get_env("TYPESENSE_WRITE_CHUNKS_PER_TURN").empty()) {
+        this->write_chunks_per_turn = std::stoi(get_env("TYPESENSE_WRITE_CHUNKS_PER_TURN"));
+    }
+
+    if(!get_env("TYPESENSE_INDEX_CONCURRENCY").empty()) {
+        this->index_concurrency = std::stoi(get_env("TYPESENSE_INDEX_CONCURRENCY"));
+    }
+
     if(!get_env("TYPESENSE_ANALYTICS_FLUSH_INTERVAL").empty()) {
         this->analytics_flush_interval = std::stoi(get_env("TYPESENSE_ANALYTICS_FLUSH_INTERVAL"));
     }
@@ -225,10 +263,40 @@ void Config::load_config_env() {
         this->db_compaction_interval = std::stoi(get_env("TYPESENSE_DB_COMPACTION_INTERVAL"));
     }
 
+    if(!get_env("TYPESENSE_DB_BLOCK_CACHE_MB").empty()) {
+        this->db_block_cache_mb = std::stoi(get_env("TYPESENSE_DB_BLOCK_CACHE_MB"));
+    }
+
+    if(!get_env("TYPESENSE_DB_BLOOM_FILTER_BITS").empty()) {
+        this->db_bloom_filter_bits = std::stoi(get_env("TYPESENSE_DB_BLOOM_FILTER_BITS"));
+    }
+
+    this->db_partitioned_filters = ("TRUE" == get_env("TYPESENSE_DB_PARTITIONED_FILTERS"));
+
+    if(!get_env("TYPESENSE_DB_COMPRESSION").empty()) {
+        this->db_compression = get_env("TYPESENSE_DB_COMPRESSION");
+    }
+
+    if(!get_env("TYPESENSE_DB_COMPRESSION_DICT_KB").empty()) {
+        this->db_compression_dict_kb = std::stoi(get_env("TYPESENSE_DB_COMPRESSION_DICT_KB"));
+    }
+
+    if(!get_env("TYPESENSE_DB_WRITE_BUFFER_MB").empty()) {
+        this->db_write_buffer_mb = std::stoi(get_env("TYPESENSE_DB_WRITE_BUFFER_MB"));
+    }
+
     if(!get_env("TYPESENSE_THREAD_POOL_SIZE").empty()) {
         this->thread_pool_size = std::stoi(get_env("TYPESENSE_THREAD_POOL_SIZE"));
     }
 
+    if(!get_env("TYPESENSE_INDEX_THREAD_POOL_SIZE").empty()) {
+        this->index_thread_pool_size = std::stoi(get_env("TYPESENSE_INDEX_THREAD_POOL_SIZE"));
+    }
+
+    if(!get_env("TYPESENSE_BACKGROUND_THREAD_POOL_SIZE").empty()) {
+        this->background_thread_pool_size = std::stoi(get_env("TYPESENSE_BACKGROUND_THREAD_POOL_SIZE"));
+    }
+
     if(!get_env("TYPESENSE_SSL_REFRESH_INTERVAL_SECONDS").empty()) {
         this->ssl_refresh_interval_seconds = std::stoi(get_env("TYPESENSE_SSL_REFRESH_INTERVAL_SECONDS"));
     }
@@ -255,6 +323,8 @@ void Config::load_config_env() {
 
     this->skip_writes = ("TRUE" == get_env("TYPESENSE_SKIP_WRITES"));
     this->enable_lazy_filter = ("TRUE" == get_env("TYPESENSE_ENABLE_LAZY_FILTER"));
+    this->enable_lazy_deletes = ("TRUE" == get_env("TYPESENSE_ENABLE_LAZY_DELETES"));
+    this->enable_collection_column_families = ("TRUE" == get_env("TYPESENSE_ENABLE_COLLECTION_COLUMN_FAMILIES"));
     this->reset_peers_on_error = ("TRUE" == get_env("TYPESENSE_RESET_PEERS_ON_ERROR"));
 
     if(!get_env("TYPESENSE_MAX_PER_PAGE").empty()) {
@@ -422,6 +492,47 @@ void Config::load_config_file(cmdline::parser& options) {
         this->cache_num_entries = (int) reader.GetInteger("server", "cache-num-entries", 1000);
     }
 
+    if(reader.Exists("server", "embedding-cache-num-entries")) {
+        this->embedding_cache_num_entries = (int) reader.GetInteger("server", "embedding-cache-num-entries", 1000);
+    }
+
+    if(reader.Exists("server", "async-embedding")) {
+        auto async_embedding_str = reader.Get("server", "async-embedding", "false");
+        this->async_embedding = (async_embedding_str == "true");
+    }
+
+    if(reader.Exists("server", "async-embedding-concurrency")) {
+        this->async_embedding_concurrency = (int) reader.GetInteger("server", "async-embedding-concurrency", 4);
+    }
+
+    if(reader.Exists("server", "async-embedding-num-tries")) {
+        this->async_embedding_num_tries = (int) reader.GetInteger("server", "async-embedding-num-tries", 3);
+    }
+
+    if(reader.Exists("server", "async-embedding-batch-size")) {
+        this->async_embedding_batch_size = (int) reader.GetInteger("server", "async-embedding-batch-size", 200);
+    }
+
+    if(reader.Exists("server", "async-embedding-timeout-ms")) {
+        this->async_embedding_timeout_ms = (int) reader.GetInteger("server", "async-embedding-timeout-ms", 60000);
+    }
+
+    if(reader.Exists("server", "max-coalesced-writes")) {
+        this->max_coalesced_writes = (int) reader.GetInteger("server", "max-coalesced-writes", 100);
+    }
+
+    if(reader.Exists("server", "write-coalescing-window-ms")) {
+        this->write_coalescing_window_ms = (int) reader.GetInteger("server", "write-coalescing-window-ms", 0);
+    }
+
+    if(reader.Exists("server", "write-chunks-per-turn")) {
+        this->write_chunks_per_turn = (int) reader.GetInteger("server", "write-chunks-per-turn", 10);
+    }
+
+    if(reader.Exists("server", "index-concurrency")) {
+        this->index_concurrency = (int) reader.GetInteger("server", "index-concurrency", 0);
+    }
+
     if(reader.Exists("server", "analytics-flush-interval")) {
         this->analytics_flush_interval = (int) reader.GetInteger("server", "analytics-flush-interval", 3600);
     }
@@ -434,10 +545,43 @@ void Config::load_config_file(cmdline::parser& options) {
         this->db_compaction_interval = (int) reader.GetInteger("server", "db-compaction-interval", 0);
     }
 
+    if(reader.Exists("server", "db-block-cache-mb")) {
+        this->db_block_cache_mb = (int) reader.GetInteger("server", "db-block-cache-mb", 0);
+    }
+
+    if(reader.Exists("server", "db-bloom-filter-bits")) {
+        this->db_bloom_filter_bits = (int) reader.GetInteger("server", "db-bloom-filter-bits", 0);
+    }
+
+    if(reader.Exists("server", "db-partitioned-filters")) {
+        auto db_partitioned_filters_str = reader.Get("server", "db-partitioned-filters", "false");
+        this->db_partitioned_filters = (db_partitioned_filters_str == "true");
+    }
+
+    if(reader.Exists("server", "db-compression")) {
+        this->db_compression = reader.Get("server", "db-compression", "");
+    }
+
+    if(reader.Exists("server", "db-compression-dict-kb")) {
+        this->db_compression_dict_kb = (int) reader.GetInteger("server", "db-compression-dict-kb", 0);
+    }
+
+    if(reader.Exists("server", "db-write-buffer-mb")) {
+        this->db_write_buffer_mb = (int) reader.GetInteger("server", "db-write-buffer-mb", 4);
+    }
+
     if(reader.Exists("server", "thread-pool-size")) {
         this->thread_pool_size = (int) reader.GetInteger("server", "thread-pool-size", 0);
     }
 
+    if(reader.Exists("server", "index-thread-pool-size")) {
+        this->index_thread_pool_size = (int) reader.GetInteger("server", "index-thread-pool-size", 0);
+    }
+
+    if(reader.Exists("server", "background-thread-pool-size")) {
+        this->background_thread_pool_size = (int) reader.GetInteger("server", "background-thread-pool-size", 4);
+    }
+
     if(reader.Exists("server", "ssl-refresh-interval-seconds")) {
         this->ssl_refresh_interval_seconds = (int) reader.GetInteger("server", "ssl-refresh-interval-seconds", 8 * 60 * 60);
     }
@@ -470,6 +614,16 @@ void Config::load_config_file(cmdline::parser& options) {
         this->enable_lazy_filter = (enable_lazy_filter_str == "true");
     }
 
+    if(reader.Exists("server", "enable-lazy-deletes")) {
+        auto enable_lazy_deletes_str = reader.Get("server", "enable-lazy-deletes", "false");
+        this->enable_lazy_deletes = (enable_lazy_deletes_str == "true");
+    }
+
+    if(reader.Exists("server", "enable-collection-column-families")) {
+        auto enable_collection_column_families_str = reader.Get("server", "enable-collection-column-families", "false");
+        this->enable_collection_column_families = (enable_collection_column_families_str == "true");
+    }
+
     if(reader.Exists("server", "skip-writes")) {
         auto skip_writes_str = reader.Get("server", "skip-writes", "false");
         this->skip_writes = (skip_writes_str == "true");
@@ -616,6 +770,46 @@ void Config::load_config_cmd_args(cmdline::parser& options)  {
         this->cache_num_entries = options.get<uint32_t>("cache-num-entries");
     }
 
+    if(options.exist("embedding-cache-num-entries")) {
+        this->embedding_cache_num_entries = options.get<uint32_t>("embedding-cache-num-entries");
+    }
+
+    if(options.exist("async-embedding")) {
+        this->async_embedding = options.get<bool>("async-embedding");
+    }
+
+    if(options.exist("async-embedding-concurrency")) {
+        this->async_embedding_concurrency = options.get<uint32_t>("async-embedding-concurrency");
+    }
+
+    if(options.exist("async-embedding-num-tries")) {
+        this->async_embedding_num_tries = options.get<uint32_t>("async-embedding-num-tries");
+    }
+
+    if(options.exist("async-embedding-batch-size")) {
+        this->async_embedding_batch_size = options.get<uint32_t>("async-embedding-batch-size");
+    }
+
+    if(options.exist("async-embedding-timeout-ms")) {
+        this->async_embedding_timeout_ms = options.get<uint32_t>("async-embedding-timeout-ms");
+    }
+
+    if(options.exist("max-coalesced-writes")) {
+        this->max_coalesced_writes = options.get<uint32_t>("max-coalesced-writes");
+    }
+
+    if(options.exist("write-coalescing-window-ms")) {
+        this->write_coalescing_window_ms = options.get<uint32_t>("write-coalescing-window-ms");
+    }
+
+    if(options.exist("write-chunks-per-turn")) {
+        this->write_chunks_per_turn = options.get<uint32_t>("write-chunks-per-turn");
+    }
+
+    if(options.exist("index-concurrency")) {
+        this->index_concurrency = options.get<uint32_t>("index-concurrency");
+    }
+
     if(options.exist("analytics-flush-interval")) {
         this->analytics_flush_interval = options.get<uint32_t>("analytics-flush-interval");
     }
@@ -628,10 +822,42 @@ void Config::load_config_cmd_args(cmdline::parser& options)  {
         this->db_compaction_interval = options.get<uint32_t>("db-compaction-interval");
     }
 
+    if(options.exist("db-block-cache-mb")) {
+        this->db_block_cache_mb = options.get<uint32_t>("db-block-cache-mb");
+    }
+
+    if(options.exist("db-bloom-filter-bits")) {
+        this->db_bloom_filter_bits = options.get<uint32_t>("db-bloom-filter-bits");
+    }
+
+    if(options.exist("db-partitioned-filters")) {
+        this->db_partitioned_filters = options.get<bool>("db-partitioned-filters");
+    }
+
+    if(options.exist("db-compression")) {
+        this->db_compression = options.get<std::string>("db-compression");
+    }
+
+    if(options.exist("db-compression-dict-kb")) {
+        this->db_compression_dict_kb = options.get<uint32_t>("db-compression-dict-kb");
+    }
+
+    if(options.exist("db-write-buffer-mb")) {
+        this->db_write_buffer_mb = options.get<uint32_t>("db-write-buffer-mb");
+    }
+
     if(options.exist("thread-pool-size")) {
         this->thread_pool_size = options.get<uint32_t>("thread-pool-size");
     }
 
+    if(options.exist("index-thread-pool-size")) {
+        this->index_thread_pool_size = options.get<uint32_t>("index-thread-pool-size");
+    }
+
+    if(options.exist("background-thread-pool-size")) {
+        this->background_thread_pool_size = options.get<uint32_t>("background-thread-pool-size");
+    }
+
     if(options.exist("ssl-refresh-interval-seconds")) {
         this->ssl_refresh_interval_seconds = options.get<uint32_t>("ssl-refresh-interval-seconds");
     }
@@ -664,6 +890,14 @@ void Config::load_config_cmd_args(cmdline::parser& options)  {
         this->enable_lazy_filter = options.get<bool>("enable-lazy-filter");
     }
 
+    if(options.exist("enable-lazy-deletes")) {
+        this->enable_lazy_deletes = options.get<bool>("enable-lazy-deletes");
+    }
+
+    if(options.exist("enable-collection-column-families")) {
+        this->enable_collection_column_families = options.get<bool>("enable-collection-column-families");
+    }
+
     if(options.exist("enable-search-logging")) {
         this->enable_search_logging = options.get<bool>("enable-search-logging");
     }
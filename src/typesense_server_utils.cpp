@@ -15,6 +15,7 @@
 #include <ifaddrs.h>
 #include "analytics_manager.h"
 #include "housekeeper.h"
+#include "embedding_pipeline.h"
 
 #include "core_api.h"
 #include "ratelimit_manager.h"
@@ -24,6 +25,7 @@
 #include "stopwords_manager.h"
 #include "conversation_manager.h"
 #include "vq_model_manager.h"
+#include "vector_distance.h"
 
 #ifndef ASAN_BUILD
 #include "jemalloc.h"
@@ -34,6 +36,10 @@
 HttpServer* server;
 std::atomic<bool> quit_raft_service;
 
+// nice values for the workers of the write and background thread pools (higher is lower priority)
+static constexpr int INDEX_THREAD_NICE_VALUE = 5;
+static constexpr int BACKGROUND_THREAD_NICE_VALUE = 10;
+
 extern "C" {
 // weak symbol: resolved at runtime by the linker if we are using jemalloc, nullptr otherwise
 #ifdef __APPLE__
@@ -96,6 +102,8 @@ void init_cmdline_options(cmdline::parser & options, int argc, char **argv) {
     options.add<uint32_t>("num-documents-parallel-load", '\0', "Number of documents per collection that are indexed in parallel during start up.", false, 1000);
 
     options.add<uint32_t>("thread-pool-size", '\0', "Number of threads used for handling concurrent requests.", false, 4);
+    options.add<uint32_t>("index-thread-pool-size", '\0', "Number of threads used for in-memory indexing of writes.", false, 4);
+    options.add<uint32_t>("background-thread-pool-size", '\0', "Number of threads used for background work like compaction.", false, 4);
 
     options.add<std::string>("log-dir", '\0', "Path to the log directory.", false, "");
 
@@ -111,10 +119,28 @@ void init_cmdline_options(cmdline::parser & options, int argc, char **argv) {
 
     options.add<int>("log-slow-searches-time-ms", '\0', "When >= 0, searches that take longer than this duration are logged.", false, 30*1000);
     options.add<int>("cache-num-entries", '\0', "Number of entries to cache.", false, 1000);
+    options.add<uint32_t>("embedding-cache-num-entries", '\0', "Number of query embeddings to cache. Set to 0 to disable.", false, 1000);
+    options.add<bool>("async-embedding", '\0', "Index documents for keyword search right away and generate their embeddings in the background.", false, false);
+    options.add<uint32_t>("async-embedding-concurrency", '\0', "Number of batches of documents that are embedded in the background at a time.", false, 4);
+    options.add<uint32_t>("async-embedding-num-tries", '\0', "Number of times that embedding a document in the background is tried before giving up.", false, 3);
+    options.add<uint32_t>("async-embedding-batch-size", '\0', "Batch size of the requests to remote embedding models for documents that are embedded in the background on startup.", false, 200);
+    options.add<uint32_t>("async-embedding-timeout-ms", '\0', "Timeout of the requests to remote embedding models for documents that are embedded in the background on startup.", false, 60000);
+    options.add<uint32_t>("max-coalesced-writes", '\0', "Maximum number of queued single document writes to a collection that are indexed as one batch.", false, 100);
+    options.add<uint32_t>("write-coalescing-window-ms", '\0', "Time that a single document write waits for more writes to the same collection to index them as one batch.", false, 0);
+    options.add<uint32_t>("write-chunks-per-turn", '\0', "Number of chunks of a large write that an indexing thread indexes before turning to the queued writes of other collections.", false, 10);
+    options.add<uint32_t>("index-concurrency", '\0', "Number of index threads that a write batch of a collection is indexed with (default: size of the index thread pool).", false, 0);
     options.add<uint32_t>("analytics-flush-interval", '\0', "Frequency of persisting analytics data to disk (in seconds).", false, 3600);
     options.add<uint32_t>("housekeeping-interval", '\0', "Frequency of housekeeping background job (in seconds).", false, 1800);
     options.add<bool>("enable-lazy-filter", '\0', "Filter clause will be evaluated lazily.", false, false);
+    options.add<bool>("enable-lazy-deletes", '\0', "Deleted documents are hidden from searches right away, and removed from the in-memory indices in the background.", false, false);
+    options.add<bool>("enable-collection-column-families", '\0', "Documents of each collection are stored in a RocksDB column family of their own, so that a dropped collection is removed at once. Existing collections are moved on startup.", false, false);
     options.add<uint32_t>("db-compaction-interval", '\0', "Frequency of RocksDB compaction (in seconds).", false, 604800);
+    options.add<uint32_t>("db-block-cache-mb", '\0', "Size of the RocksDB block cache of the documents (in MB). 0 uses the default cache of RocksDB.", false, 0);
+    options.add<uint32_t>("db-bloom-filter-bits", '\0', "Bits per key of the RocksDB bloom filters of the documents. 0 disables the filters.", false, 0);
+    options.add<bool>("db-partitioned-filters", '\0', "Partition the RocksDB index and filter blocks of the documents, and keep them in the block cache.", false, false);
+    options.add<std::string>("db-compression", '\0', "Compression of the documents on disk: snappy, lz4, zstd or none. lz4 and zstd need a RocksDB that is built with them. By default, RocksDB picks the compression of each level.", false, "");
+    options.add<uint32_t>("db-compression-dict-kb", '\0', "Size of the dictionary of zstd compression of the documents (in KB). 0 disables the dictionary.", false, 0);
+    options.add<uint32_t>("db-write-buffer-mb", '\0', "Size of each RocksDB write buffer of the documents (in MB).", false, 4);
     options.add<uint16_t>("filter-by-max-ops", '\0', "Maximum number of operations permitted in filtery_by.", false, Config::FILTER_BY_DEFAULT_OPERATIONS);
 
     options.add<int>("max-per-page", '\0', "Max number of hits per page", false, 250);
@@ -344,6 +370,7 @@ int start_raft_server(ReplicationState& replication_state, Store& store,
 
 int run_server(const Config & config, const std::string & version, void (*master_server_routes)()) {
     LOG(INFO) << "Starting Typesense " << version << std::flush;
+    LOG(INFO) << "Using " << vector_distance::isa_name(vector_distance::kernels().isa) << " vector distance kernels.";
 #ifndef ASAN_BUILD
     if(using_jemalloc()) {
         LOG(INFO) << "Typesense is using jemalloc.";
@@ -408,13 +435,31 @@ int run_server(const Config & config, const std::string & version, void (*master
     num_collections_parallel_load = (num_collections_parallel_load == 0) ?
                                     (proc_count * 4) : num_collections_parallel_load;
 
-    LOG(INFO) << "Thread pool size: " << num_threads;
-    ThreadPool app_thread_pool(num_threads);
-    ThreadPool server_thread_pool(num_threads);
-    ThreadPool replication_thread_pool(num_threads);
+    const size_t num_index_threads = config.get_index_thread_pool_size() == 0 ? num_threads :
+                                     config.get_index_thread_pool_size();
+    const size_t num_background_threads = std::max<size_t>(1, config.get_background_thread_pool_size());
+
+    LOG(INFO) << "Thread pool size: " << num_threads << ", index thread pool size: " << num_index_threads
+              << ", background thread pool size: " << num_background_threads;
+
+    // searches run on `app_thread_pool`, while writes and background jobs are given their own pools whose workers
+    // run at a lower OS priority so that they yield CPU to searches when the machine is saturated
+    ThreadPool app_thread_pool(num_threads, "search");
+    ThreadPool index_thread_pool(num_index_threads, "index", INDEX_THREAD_NICE_VALUE);
+    ThreadPool background_thread_pool(num_background_threads, "background", BACKGROUND_THREAD_NICE_VALUE);
+    ThreadPool server_thread_pool(num_threads, "server");
+    ThreadPool replication_thread_pool(num_threads, "replication");
 
     // primary DB used for storing the documents: we will not use WAL since Raft provides that
-    Store store(db_dir, 24*60*60, 1024, true);
+    store_tuning_t store_tuning;
+    store_tuning.block_cache_mb = config.get_db_block_cache_mb();
+    store_tuning.bloom_filter_bits = config.get_db_bloom_filter_bits();
+    store_tuning.partitioned_filters = config.get_db_partitioned_filters();
+    store_tuning.compression = config.get_db_compression();
+    store_tuning.compression_dict_kb = config.get_db_compression_dict_kb();
+    store_tuning.write_buffer_mb = config.get_db_write_buffer_mb();
+
+    Store store(db_dir, 24*60*60, 1024, true, 0, store_tuning);
 
     // meta DB for storing house keeping things
     Store meta_store(meta_dir, 24*60*60, 1024, false);
@@ -454,7 +499,8 @@ int run_server(const Config & config, const std::string & version, void (*master
                                                        config, config.get_skip_writes());
 
     CollectionManager & collectionManager = CollectionManager::get_instance();
-    collectionManager.init(&store, &app_thread_pool, config.get_max_memory_ratio(),
+    collectionManager.init(&store, &app_thread_pool, &index_thread_pool, &background_thread_pool,
+                           config.get_max_memory_ratio(),
                            config.get_api_key(), quit_raft_service, config.get_filter_by_max_ops());
 
     StopwordsManager& stopwordsManager = StopwordsManager::get_instance();
@@ -485,7 +531,8 @@ int run_server(const Config & config, const std::string & version, void (*master
     }
 
     std::thread raft_thread([&replication_state, &store, &config, &state_dir,
-                             &app_thread_pool, &server_thread_pool, &replication_thread_pool, batch_indexer]() {
+                             &app_thread_pool, &index_thread_pool, &background_thread_pool,
+                             &server_thread_pool, &replication_thread_pool, batch_indexer]() {
 
         std::thread batch_indexing_thread([batch_indexer]() {
             batch_indexer->run();
@@ -505,6 +552,16 @@ int run_server(const Config & config, const std::string & version, void (*master
             HouseKeeper::get_instance().run();
         });
 
+        // initialized before the collections are loaded, so that documents still waiting for embeddings are queued
+        std::thread embedding_pipeline_thread;
+        if(config.get_async_embedding()) {
+            EmbeddingPipeline::get_instance().init(config.get_async_embedding_concurrency(),
+                                                   config.get_async_embedding_num_tries());
+            embedding_pipeline_thread = std::thread([&replication_state]() {
+                EmbeddingPipeline::get_instance().run(&replication_state);
+            });
+        }
+
         RemoteEmbedder::init(&replication_state);
 
         std::string path_to_nodes = config.get_nodes();
@@ -539,6 +596,12 @@ int run_server(const Config & config, const std::string & version, void (*master
         HouseKeeper::get_instance().stop();
         housekeeping_thread.join();
 
+        if(embedding_pipeline_thread.joinable()) {
+            LOG(INFO) << "Waiting for embedding pipeline to be done...";
+            EmbeddingPipeline::get_instance().stop();
+            embedding_pipeline_thread.join();
+        }
+
         LOG(INFO) << "Shutting down server_thread_pool";
 
         server_thread_pool.shutdown();
@@ -547,6 +610,12 @@ int run_server(const Config & config, const std::string & version, void (*master
 
         app_thread_pool.shutdown();
 
+        LOG(INFO) << "Shutting down index_thread_pool.";
+        index_thread_pool.shutdown();
+
+        LOG(INFO) << "Shutting down background_thread_pool.";
+        background_thread_pool.shutdown();
+
         LOG(INFO) << "Shutting down replication_thread_pool.";
         replication_thread_pool.shutdown();
 
@@ -0,0 +1,361 @@
+#include <cmath>
+#include "vector_distance.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VECTOR_DISTANCE_X86
+#include <immintrin.h>
+#endif
+
+namespace vector_distance {
+
+namespace {
+    float inner_product_scalar(const float* a, const float* b, size_t dim) {
+        float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        size_t i = 0;
+
+        for(; i + 4 <= dim; i += 4) {
+            sums[0] += a[i] * b[i];
+            sums[1] += a[i + 1] * b[i + 1];
+            sums[2] += a[i + 2] * b[i + 2];
+            sums[3] += a[i + 3] * b[i + 3];
+        }
+
+        for(; i < dim; i++) {
+            sums[0] += a[i] * b[i];
+        }
+
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+
+    float l2_squared_scalar(const float* a, const float* b, size_t dim) {
+        float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        size_t i = 0;
+
+        for(; i + 4 <= dim; i += 4) {
+            for(size_t j = 0; j < 4; j++) {
+                const float diff = a[i + j] - b[i + j];
+                sums[j] += diff * diff;
+            }
+        }
+
+        for(; i < dim; i++) {
+            const float diff = a[i] - b[i];
+            sums[0] += diff * diff;
+        }
+
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+
+    void normalize_scalar(const float* src, float* dest, size_t dim) {
+        const float norm = 1.0f / (std::sqrt(inner_product_scalar(src, src, dim)) + 1e-30f);
+        for(size_t i = 0; i < dim; i++) {
+            dest[i] = src[i] * norm;
+        }
+    }
+
+#ifdef VECTOR_DISTANCE_X86
+    __attribute__((target("sse3")))
+    inline float horizontal_sum(__m128 v) {
+        v = _mm_hadd_ps(v, v);
+        v = _mm_hadd_ps(v, v);
+        return _mm_cvtss_f32(v);
+    }
+
+    __attribute__((target("sse3")))
+    float inner_product_sse(const float* a, const float* b, size_t dim) {
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        size_t i = 0;
+
+        for(; i + 8 <= dim; i += 8) {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+
+        for(; i + 4 <= dim; i += 4) {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+
+        float sum = horizontal_sum(_mm_add_ps(sum0, sum1));
+
+        for(; i < dim; i++) {
+            sum += a[i] * b[i];
+        }
+
+        return sum;
+    }
+
+    __attribute__((target("sse3")))
+    float l2_squared_sse(const float* a, const float* b, size_t dim) {
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        size_t i = 0;
+
+        for(; i + 8 <= dim; i += 8) {
+            const __m128 diff0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+            const __m128 diff1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(diff0, diff0));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(diff1, diff1));
+        }
+
+        for(; i + 4 <= dim; i += 4) {
+            const __m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(diff, diff));
+        }
+
+        float sum = horizontal_sum(_mm_add_ps(sum0, sum1));
+
+        for(; i < dim; i++) {
+            const float diff = a[i] - b[i];
+            sum += diff * diff;
+        }
+
+        return sum;
+    }
+
+    __attribute__((target("sse3")))
+    void normalize_sse(const float* src, float* dest, size_t dim) {
+        const float norm = 1.0f / (std::sqrt(inner_product_sse(src, src, dim)) + 1e-30f);
+        const __m128 norm_v = _mm_set1_ps(norm);
+        size_t i = 0;
+
+        for(; i + 4 <= dim; i += 4) {
+            _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(src + i), norm_v));
+        }
+
+        for(; i < dim; i++) {
+            dest[i] = src[i] * norm;
+        }
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline float horizontal_sum(__m256 v) {
+        const __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        const __m128 sum2 = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        return _mm_cvtss_f32(_mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 0x55)));
+    }
+
+    __attribute__((target("avx2,fma")))
+    float inner_product_avx2(const float* a, const float* b, size_t dim) {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        size_t i = 0;
+
+        for(; i + 16 <= dim; i += 16) {
+            sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+            sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+        }
+
+        for(; i + 8 <= dim; i += 8) {
+            sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+        }
+
+        float sum = horizontal_sum(_mm256_add_ps(sum0, sum1));
+
+        for(; i < dim; i++) {
+            sum += a[i] * b[i];
+        }
+
+        return sum;
+    }
+
+    __attribute__((target("avx2,fma")))
+    float l2_squared_avx2(const float* a, const float* b, size_t dim) {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        size_t i = 0;
+
+        for(; i + 16 <= dim; i += 16) {
+            const __m256 diff0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+            const __m256 diff1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+            sum0 = _mm256_fmadd_ps(diff0, diff0, sum0);
+            sum1 = _mm256_fmadd_ps(diff1, diff1, sum1);
+        }
+
+        for(; i + 8 <= dim; i += 8) {
+            const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+            sum0 = _mm256_fmadd_ps(diff, diff, sum0);
+        }
+
+        float sum = horizontal_sum(_mm256_add_ps(sum0, sum1));
+
+        for(; i < dim; i++) {
+            const float diff = a[i] - b[i];
+            sum += diff * diff;
+        }
+
+        return sum;
+    }
+
+    __attribute__((target("avx2,fma")))
+    void normalize_avx2(const float* src, float* dest, size_t dim) {
+        const float norm = 1.0f / (std::sqrt(inner_product_avx2(src, src, dim)) + 1e-30f);
+        const __m256 norm_v = _mm256_set1_ps(norm);
+        size_t i = 0;
+
+        for(; i + 8 <= dim; i += 8) {
+            _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), norm_v));
+        }
+
+        for(; i < dim; i++) {
+            dest[i] = src[i] * norm;
+        }
+    }
+
+    // the tail is handled with masked loads, so there are no scalar loops
+    __attribute__((target("avx512f")))
+    float inner_product_avx512(const float* a, const float* b, size_t dim) {
+        __m512 sum0 = _mm512_setzero_ps();
+        __m512 sum1 = _mm512_setzero_ps();
+        size_t i = 0;
+
+        for(; i + 32 <= dim; i += 32) {
+            sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+            sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+        }
+
+        for(; i + 16 <= dim; i += 16) {
+            sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+        }
+
+        if(i < dim) {
+            const __mmask16 mask = (__mmask16) ((1u << (dim - i)) - 1);
+            sum1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), sum1);
+        }
+
+        return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+    }
+
+    __attribute__((target("avx512f")))
+    float l2_squared_avx512(const float* a, const float* b, size_t dim) {
+        __m512 sum0 = _mm512_setzero_ps();
+        __m512 sum1 = _mm512_setzero_ps();
+        size_t i = 0;
+
+        for(; i + 32 <= dim; i += 32) {
+            const __m512 diff0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+            const __m512 diff1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+            sum0 = _mm512_fmadd_ps(diff0, diff0, sum0);
+            sum1 = _mm512_fmadd_ps(diff1, diff1, sum1);
+        }
+
+        for(; i + 16 <= dim; i += 16) {
+            const __m512 diff = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+            sum0 = _mm512_fmadd_ps(diff, diff, sum0);
+        }
+
+        if(i < dim) {
+            const __mmask16 mask = (__mmask16) ((1u << (dim - i)) - 1);
+            const __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+            sum1 = _mm512_fmadd_ps(diff, diff, sum1);
+        }
+
+        return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+    }
+
+    __attribute__((target("avx512f")))
+    void normalize_avx512(const float* src, float* dest, size_t dim) {
+        const float norm = 1.0f / (std::sqrt(inner_product_avx512(src, src, dim)) + 1e-30f);
+        const __m512 norm_v = _mm512_set1_ps(norm);
+        size_t i = 0;
+
+        for(; i + 16 <= dim; i += 16) {
+            _mm512_storeu_ps(dest + i, _mm512_mul_ps(_mm512_loadu_ps(src + i), norm_v));
+        }
+
+        if(i < dim) {
+            const __mmask16 mask = (__mmask16) ((1u << (dim - i)) - 1);
+            _mm512_mask_storeu_ps(dest + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, src + i), norm_v));
+        }
+    }
+#endif
+
+    template<float (*IP)(const float*, const float*, size_t)>
+    float inner_product_distance(const void* a, const void* b, const void* param) {
+        return 1.0f - IP((const float*) a, (const float*) b, *((const size_t*) param));
+    }
+
+    template<float (*L2)(const float*, const float*, size_t)>
+    float l2_distance(const void* a, const void* b, const void* param) {
+        return L2((const float*) a, (const float*) b, *((const size_t*) param));
+    }
+
+    template<float (*IP)(const float*, const float*, size_t), float (*L2)(const float*, const float*, size_t),
+             void (*NORMALIZE)(const float*, float*, size_t)>
+    constexpr kernels_t make_kernels(isa_t isa) {
+        return kernels_t{isa, IP, L2, NORMALIZE, inner_product_distance<IP>, l2_distance<L2>};
+    }
+
+    const kernels_t scalar_kernels =
+            make_kernels<inner_product_scalar, l2_squared_scalar, normalize_scalar>(isa_t::scalar);
+
+#ifdef VECTOR_DISTANCE_X86
+    const kernels_t sse_kernels = make_kernels<inner_product_sse, l2_squared_sse, normalize_sse>(isa_t::sse);
+    const kernels_t avx2_kernels = make_kernels<inner_product_avx2, l2_squared_avx2, normalize_avx2>(isa_t::avx2);
+    const kernels_t avx512_kernels =
+            make_kernels<inner_product_avx512, l2_squared_avx512, normalize_avx512>(isa_t::avx512);
+#endif
+}
+
+isa_t detect_isa() {
+#ifdef VECTOR_DISTANCE_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f")) {
+        return isa_t::avx512;
+    }
+
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return isa_t::avx2;
+    }
+
+    if(__builtin_cpu_supports("sse3")) {
+        return isa_t::sse;
+    }
+#endif
+
+    return isa_t::scalar;
+}
+
+const kernels_t& get_kernels(isa_t isa) {
+    static const isa_t supported_isa = detect_isa();
+
+    if(isa > supported_isa) {
+        isa = supported_isa;
+    }
+
+#ifdef VECTOR_DISTANCE_X86
+    switch(isa) {
+        case isa_t::avx512:
+            return avx512_kernels;
+        case isa_t::avx2:
+            return avx2_kernels;
+        case isa_t::sse:
+            return sse_kernels;
+        default:
+            break;
+    }
+#endif
+
+    return scalar_kernels;
+}
+
+const kernels_t& kernels() {
+    static const kernels_t& best_kernels = get_kernels(isa_t::avx512);
+    return best_kernels;
+}
+
+const char* isa_name(isa_t isa) {
+    switch(isa) {
+        case isa_t::avx512:
+            return "avx512";
+        case isa_t::avx2:
+            return "avx2";
+        case isa_t::sse:
+            return "sse";
+        default:
+            return "scalar";
+    }
+}
+
+}
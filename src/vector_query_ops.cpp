@@ -199,6 +199,14 @@ Option<bool> VectorQueryOps::parse_vector_query_str(const std::string& vector_qu
                     vector_query.ef = std::stoul(param_kv[1]);
                 }
 
+                if(param_kv[0] == "nprobe") {
+                    if(!StringUtils::is_uint32_t(param_kv[1]) || std::stoul(param_kv[1]) == 0) {
+                        return Option<bool>(400, "Malformed vector query string: `nprobe` parameter must be a positive integer.");
+                    }
+
+                    vector_query.nprobe = std::stoul(param_kv[1]);
+                }
+
                 if(param_kv[0] == "queries") {
                     if(param_kv[1].front() != '[' || param_kv[1].back() != ']') {
                         return Option<bool>(400, "Malformed vector query string: "
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <thread>
 #include "app_metrics.h"
 
 class AppMetricsTest : public ::testing::Test {
@@ -43,3 +44,48 @@ TEST_F(AppMetricsTest, StatefulRemoveDocs) {
     ASSERT_EQ(result["rps"]["GET /collections"].get<double>(), 0.2);
     ASSERT_EQ(result["rps"]["GET /operations/vote"].get<double>(), 0.1);
 }
+
+TEST_F(AppMetricsTest, LatencyPercentiles) {
+    for(size_t i = 1; i <= 100; i++) {
+        metrics.increment_count(AppMetrics::SEARCH_LABEL, 1);
+        metrics.increment_duration(AppMetrics::SEARCH_LABEL, i);
+        metrics.increment_collection_duration("products", i * 2);
+    }
+
+    // metrics recorded from other threads must be merged into the same window
+    std::thread t([&]() {
+        metrics.increment_duration("GET /collections", 7);
+    });
+    t.join();
+
+    metrics.window_reset();
+
+    nlohmann::json result;
+    metrics.get("rps", "latency", result);
+
+    ASSERT_EQ(10.0, result["search_rps"].get<double>());
+    ASSERT_EQ(50.5, result["search_latency"].get<double>());
+
+    // values in the range [32, 64) are bucketed in pairs, [64, 128) in fours, etc.
+    ASSERT_EQ(51, result["latency_percentiles"]["search"]["p50"].get<uint64_t>());
+    ASSERT_EQ(95, result["latency_percentiles"]["search"]["p95"].get<uint64_t>());
+    ASSERT_EQ(99, result["latency_percentiles"]["search"]["p99"].get<uint64_t>());
+
+    ASSERT_EQ(7, result["latency_percentiles"]["GET /collections"]["p99"].get<uint64_t>());
+
+    ASSERT_EQ(103, result["collection_search_latency_percentiles"]["products"]["p50"].get<uint64_t>());
+    ASSERT_EQ(199, result["collection_search_latency_percentiles"]["products"]["p99"].get<uint64_t>());
+
+    std::string prometheus_body;
+    metrics.get_prometheus(prometheus_body);
+
+    ASSERT_NE(std::string::npos, prometheus_body.find("typesense_request_latency_ms{route=\"search\",quantile=\"0.99\"} 99\n"));
+    ASSERT_NE(std::string::npos, prometheus_body.find("typesense_collection_search_latency_ms_count{collection=\"products\"} 100\n"));
+
+    // next window must not carry over older values
+    metrics.window_reset();
+    result.clear();
+    metrics.get("rps", "latency", result);
+    ASSERT_TRUE(result["latency_percentiles"].empty());
+    ASSERT_TRUE(result["collection_search_latency_percentiles"].empty());
+}
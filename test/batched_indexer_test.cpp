@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "batched_indexer.h"
+#include "thread_local_vars.h"
+
+class BatchedIndexerTest : public ::testing::Test {
+protected:
+    // serves the next turn of the queue like an indexing thread does: the request at the front of the collection
+    // indexes up to `chunks_per_turn` of its chunks left and yields if it still has more
+    static uint64_t serve_turn(BatchedIndexer::indexer_queue_t& queue, std::map<uint64_t, size_t>& chunks_left,
+                               size_t chunks_per_turn) {
+        const std::string coll_name = BatchedIndexer::next_turn(queue);
+        auto& coll_queue = queue.coll_queues[coll_name];
+        BatchedIndexer::queued_req_t queued_req = coll_queue.reqs.front();
+        coll_queue.reqs.pop_front();
+
+        size_t& num_chunks_left = chunks_left[queued_req.req_id];
+        num_chunks_left -= std::min(num_chunks_left, chunks_per_turn);
+
+        BatchedIndexer::end_turn(queue, coll_name, queued_req, num_chunks_left != 0);
+        return queued_req.req_id;
+    }
+
+    static void push_write(BatchedIndexer::indexer_queue_t& queue, std::map<uint64_t, size_t>& chunks_left,
+                           const std::string& coll_name, uint64_t req_id, size_t num_chunks) {
+        chunks_left[req_id] = num_chunks;
+        BatchedIndexer::push_write(queue, coll_name, BatchedIndexer::queued_req_t(req_id, 0, num_chunks == 1));
+    }
+};
+
+TEST_F(BatchedIndexerTest, LargeImportInterleavesWithSmallWrites) {
+    BatchedIndexer::indexer_queue_t queue;
+    std::map<uint64_t, size_t> chunks_left;
+
+    // import of 25 chunks, indexed 10 chunks per turn
+    push_write(queue, chunks_left, "products", 1, 25);
+    ASSERT_EQ(1, serve_turn(queue, chunks_left, 10));
+    ASSERT_EQ(15, chunks_left[1]);
+
+    // single chunk writes to another collection arrive while the import is being indexed
+    push_write(queue, chunks_left, "users", 2, 1);
+    push_write(queue, chunks_left, "users", 3, 1);
+
+    std::vector<uint64_t> served_req_ids;
+    while(!queue.turns.empty()) {
+        served_req_ids.push_back(serve_turn(queue, chunks_left, 10));
+    }
+
+    // small writes wait for a single turn of the import at the most
+    std::vector<uint64_t> expected_req_ids = {2, 1, 3, 1};
+    ASSERT_EQ(expected_req_ids, served_req_ids);
+
+    ASSERT_EQ(0, chunks_left[1]);
+    ASSERT_TRUE(queue.coll_queues.empty());
+}
+
+TEST_F(BatchedIndexerTest, WritesOfACollectionStayInOrder) {
+    BatchedIndexer::indexer_queue_t queue;
+    std::map<uint64_t, size_t> chunks_left;
+
+    push_write(queue, chunks_left, "products", 1, 25);
+    push_write(queue, chunks_left, "products", 2, 1);
+    push_write(queue, chunks_left, "products", 3, 3);
+    push_write(queue, chunks_left, "users", 4, 1);
+    push_write(queue, chunks_left, "users", 5, 12);
+    push_write(queue, chunks_left, "users", 6, 1);
+
+    std::vector<uint64_t> served_products_req_ids;
+    std::vector<uint64_t> served_users_req_ids;
+
+    while(!queue.turns.empty()) {
+        uint64_t req_id = serve_turn(queue, chunks_left, 10);
+        if(req_id <= 3) {
+            served_products_req_ids.push_back(req_id);
+        } else {
+            served_users_req_ids.push_back(req_id);
+        }
+    }
+
+    // a small write is never served ahead of the writes of its own collection that were queued before it
+    std::vector<uint64_t> expected_products_req_ids = {1, 1, 1, 2, 3};
+    std::vector<uint64_t> expected_users_req_ids = {4, 5, 5, 6};
+    ASSERT_EQ(expected_products_req_ids, served_products_req_ids);
+    ASSERT_EQ(expected_users_req_ids, served_users_req_ids);
+
+    for(const auto& kv: chunks_left) {
+        ASSERT_EQ(0, kv.second);
+    }
+
+    ASSERT_TRUE(queue.coll_queues.empty());
+}
+
+TEST_F(BatchedIndexerTest, YieldedRequestResumesAfterLoadState) {
+    std::string state_dir_path = "/tmp/typesense_test/batched_indexer_test";
+    LOG(INFO) << "Truncating and creating: " << state_dir_path;
+    system(("rm -rf "+state_dir_path+" && mkdir -p "+state_dir_path).c_str());
+
+    Store store(state_dir_path + "/db");
+    Store meta_store(state_dir_path + "/meta");
+    std::atomic<bool> skip_writes = false;
+
+    auto get_req_res = [](const std::string& coll_name, uint64_t start_ts, uint32_t num_chunks,
+                          uint32_t next_chunk_index, bool is_complete) {
+        http_req req;
+        req.start_ts = start_ts;
+        req.params["collection"] = coll_name;
+
+        nlohmann::json req_res;
+        req_res["start_ts"] = start_ts;
+        req_res["last_updated"] = 0;
+        req_res["num_chunks"] = num_chunks;
+        req_res["next_chunk_index"] = next_chunk_index;
+        req_res["is_complete"] = is_complete;
+        req_res["req"] = req.to_json();
+        req_res["prev_req_body"] = "";
+        return req_res;
+    };
+
+    // import that yielded after 10 of its 25 chunks, another one that has a single chunk left after yielding and
+    // a request whose chunks are still being received
+    nlohmann::json state;
+    state["queued_writes"] = 17;
+    state["req_res_map"]["100"] = get_req_res("products", 100, 25, 10, true);
+    state["req_res_map"]["200"] = get_req_res("users", 200, 11, 10, true);
+    state["req_res_map"]["300"] = get_req_res("users", 300, 2, 0, false);
+
+    BatchedIndexer batch_indexer(nullptr, &store, &meta_store, 1, Config::get_instance(), skip_writes);
+    batch_indexer.load_state(state);
+
+    ASSERT_EQ(17, batch_indexer.get_queued_writes());
+
+    nlohmann::json queue_stats;
+    batch_indexer.get_queue_stats(queue_stats);
+    ASSERT_EQ(2, queue_stats.size());
+    ASSERT_EQ(1, queue_stats["products"]["queued_requests"].get<size_t>());
+    ASSERT_EQ(1, queue_stats["users"]["queued_requests"].get<size_t>());
+
+    // the write with a single chunk left is served first, and the import resumes from where it yielded
+    auto& queue = batch_indexer._get_queue(0);
+    ASSERT_EQ(200, queue.coll_queues["users"].reqs.front().req_id);
+    ASSERT_TRUE(queue.coll_queues["users"].reqs.front().is_small);
+    ASSERT_EQ(100, queue.coll_queues["products"].reqs.front().req_id);
+    ASSERT_FALSE(queue.coll_queues["products"].reqs.front().is_small);
+
+    ASSERT_EQ("users", BatchedIndexer::next_turn(queue));
+    ASSERT_EQ("products", BatchedIndexer::next_turn(queue));
+
+    nlohmann::json saved_state;
+    batch_indexer.serialize_state(saved_state);
+    ASSERT_EQ(3, saved_state["req_res_map"].size());
+    ASSERT_EQ(10, saved_state["req_res_map"]["100"]["next_chunk_index"].get<uint32_t>());
+    ASSERT_EQ(25, saved_state["req_res_map"]["100"]["num_chunks"].get<uint32_t>());
+    ASSERT_FALSE(saved_state["req_res_map"]["300"]["is_complete"].get<bool>());
+}
+
+TEST_F(BatchedIndexerTest, CrashWithinCoalescedWritesIsNotSkipped) {
+    std::string state_dir_path = "/tmp/typesense_test/batched_indexer_test";
+    LOG(INFO) << "Truncating and creating: " << state_dir_path;
+    system(("rm -rf "+state_dir_path+" && mkdir -p "+state_dir_path).c_str());
+
+    Store store(state_dir_path + "/db");
+    Store meta_store(state_dir_path + "/meta");
+    std::atomic<bool> skip_writes = false;
+
+    BatchedIndexer batch_indexer(nullptr, &store, &meta_store, 1, Config::get_instance(), skip_writes);
+
+    // a crash while indexing a group of coalesced writes does not mark any of them to be skipped
+    write_log_index = 10;
+    write_log_last_index = 14;
+    batch_indexer.persist_applying_index();
+
+    std::string value;
+    ASSERT_EQ(StoreStatus::FOUND, meta_store.get("$XU", value));
+    ASSERT_EQ("14", value);
+    ASSERT_EQ(StoreStatus::NOT_FOUND, meta_store.get("$XP10", value));
+
+    // once indexed one by one, the write that crashes again is marked
+    write_log_index = 12;
+    write_log_last_index = 0;
+    batch_indexer.persist_applying_index();
+
+    ASSERT_EQ(StoreStatus::FOUND, meta_store.get("$XP12", value));
+    ASSERT_EQ("12", value);
+
+    batch_indexer.clear_skip_indices();
+    ASSERT_EQ(StoreStatus::NOT_FOUND, meta_store.get("$XU", value));
+    ASSERT_EQ(StoreStatus::NOT_FOUND, meta_store.get("$XP12", value));
+
+    write_log_index = 0;
+}
@@ -1752,6 +1752,76 @@ TEST_F(CollectionManagerTest, CollectionCreationWithMetadata) {
     ASSERT_EQ(0, coll2->get_summary_json().count("metadata"));
 }
 
+TEST_F(CollectionManagerTest, CollectionCreationWithIndexConcurrency) {
+    nlohmann::json schema = R"({
+        "name": "coll2",
+        "fields": [
+          {"name": "title", "type": "string"},
+          {"name": "tags", "type": "string[]", "facet": true},
+          {"name": "points", "type": "int32"}
+        ],
+        "index_concurrency": 0
+    })"_json;
+
+    auto op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(op.ok());
+    ASSERT_EQ("`index_concurrency` should be a positive integer.", op.error());
+
+    schema["index_concurrency"] = "2";
+    op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(op.ok());
+    ASSERT_EQ("`index_concurrency` should be a positive integer.", op.error());
+
+    schema["index_concurrency"] = 2;
+    op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(op.ok());
+    Collection* coll2 = op.get();
+
+    ASSERT_EQ(2, coll2->get_index_concurrency());
+    ASSERT_EQ(2, coll2->get_summary_json()["index_concurrency"].get<size_t>());
+    ASSERT_EQ(0, collection1->get_summary_json().count("index_concurrency"));
+
+    // more records and fields than tasks, so that both are handed out to the tasks as they free up
+    std::vector<std::string> json_lines;
+    for(size_t i = 0; i < 500; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "title " + std::to_string(i) + " of some longer text with more tokens";
+        doc["tags"] = {"tag" + std::to_string(i % 10), "common"};
+        doc["points"] = i;
+        json_lines.push_back(doc.dump());
+    }
+
+    nlohmann::json document;
+    auto import_res = coll2->add_many(json_lines, document);
+    ASSERT_TRUE(import_res["success"].get<bool>());
+    ASSERT_EQ(500, coll2->get_num_documents());
+
+    auto res = coll2->search("common", {"tags"}, "", {"tags"}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(500, res["found"].get<size_t>());
+    ASSERT_EQ(500, res["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+
+    res = coll2->search("title 123", {"title"}, "points:=123", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, res["found"].get<size_t>());
+    ASSERT_EQ("123", res["hits"][0]["document"]["id"].get<std::string>());
+
+    // setting is restored when the collection is loaded
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/coll_manager_test_db");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    auto load_op = collectionManager.load(8, 1000);
+    ASSERT_TRUE(load_op.ok());
+
+    coll2 = collectionManager.get_collection("coll2").get();
+    ASSERT_NE(nullptr, coll2);
+    ASSERT_EQ(2, coll2->get_index_concurrency());
+    ASSERT_EQ(500, coll2->get_num_documents());
+
+    collectionManager.drop_collection("coll2");
+}
+
 TEST_F(CollectionManagerTest, PopulateReferencedIns) {
     std::vector<std::string> collection_meta_jsons = {
             R"({
@@ -3540,3 +3540,58 @@ TEST_F(CollectionNestedFieldsTest, NestedObjecEnableSortOnString) {
 
     ASSERT_TRUE(coll1->get_schema()["status.1"].sort);
 }
+
+TEST_F(CollectionNestedFieldsTest, UpdateOfNumericFieldWithUnchangedObject) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "enable_nested_fields": true,
+        "fields": [
+          {"name": "title", "type": "string"},
+          {"name": "details", "type": "object"},
+          {"name": "details.brand", "type": "string", "facet": true},
+          {"name": "price", "type": "float"},
+          {"name": "stock", "type": "int32"}
+        ]
+    })"_json;
+
+    auto op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(op.ok());
+    Collection* coll1 = op.get();
+
+    auto doc1 = R"({
+        "id": "0",
+        "title": "Running shoes",
+        "details": {"brand": "Nike", "color": "red"},
+        "price": 120.5,
+        "stock": 10
+    })"_json;
+
+    ASSERT_TRUE(coll1->add(doc1.dump(), CREATE).ok());
+
+    // only the numeric fields change, with the rest of the document sent as it is
+    doc1["price"] = 99.5;
+    doc1["stock"] = 9;
+    ASSERT_TRUE(coll1->add(doc1.dump(), EMPLACE).ok());
+
+    auto update_doc = R"({"id": "0", "stock": 8, "details": {"brand": "Nike", "color": "red"}})"_json;
+    ASSERT_TRUE(coll1->add(update_doc.dump(), UPDATE).ok());
+
+    auto results = coll1->search("shoes", {"title"}, "price:99.5 && stock:8", {"details.brand"}, {}, {0}, 10, 1,
+                                 FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+    ASSERT_EQ("Nike", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+    ASSERT_EQ(1, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ("red", results["hits"][0]["document"]["details"]["color"].get<std::string>());
+
+    results = coll1->search("*", {}, "price:120.5 || stock:[9, 10]", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(0, results["found"].get<size_t>());
+
+    // a change inside the object is still indexed
+    update_doc = R"({"id": "0", "details": {"brand": "Adidas", "color": "red"}})"_json;
+    ASSERT_TRUE(coll1->add(update_doc.dump(), UPDATE).ok());
+
+    results = coll1->search("*", {}, "details.brand:Adidas", {"details.brand"}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+    ASSERT_EQ(1, results["facet_counts"][0]["counts"].size());
+    ASSERT_EQ("Adidas", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+}
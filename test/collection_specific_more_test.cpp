@@ -30,6 +30,8 @@ protected:
     }
 
     virtual void TearDown() {
+        // tests that flip the flag could fail before restoring it
+        Config::get_instance().set_enable_lazy_deletes(false);
         collectionManager.dispose();
         delete store;
     }
@@ -3304,4 +3306,254 @@ TEST_F(CollectionSpecificMoreTest, PopulateIncludeExcludeFields) {
     for (const auto& item: expected) {
         ASSERT_EQ(1, output_include_fields.count(item));
     }
-}
\ No newline at end of file
+}
+
+TEST_F(CollectionSpecificMoreTest, SearchCancellation) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    nlohmann::json doc;
+    doc["title"] = "The quick brown fox";
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    std::atomic<bool> client_alive = true;
+    search_client_alive = &client_alive;
+
+    auto res_op = coll1->search("quick", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true});
+    ASSERT_TRUE(res_op.ok());
+    ASSERT_EQ(1, res_op.get()["hits"].size());
+
+    // client goes away
+    client_alive = false;
+    res_op = coll1->search("quick", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ(408, res_op.code());
+
+    search_client_alive = nullptr;
+    res_op = coll1->search("quick", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true});
+    ASSERT_TRUE(res_op.ok());
+
+    // deadline is measured from when the request was received: request received 10 seconds ago
+    std::map<std::string, std::string> req_params = {
+            {"collection", "coll1"},
+            {"q", "quick"},
+            {"query_by", "title"},
+            {http_req::DEADLINE_HEADER, "5000"},
+    };
+    nlohmann::json embedded_params;
+    std::string json_res;
+    auto start_ts = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() - (10 * 1000 * 1000);
+
+    auto search_op = collectionManager.do_search(req_params, embedded_params, json_res, start_ts);
+    ASSERT_FALSE(search_op.ok());
+    ASSERT_EQ(408, search_op.code());
+    ASSERT_EQ("Request Timeout", search_op.error());
+
+    // deadline that has not elapsed yet leaves the rest of the budget to the search
+    req_params[http_req::DEADLINE_HEADER] = "60000";
+    json_res.clear();
+    search_op = collectionManager.do_search(req_params, embedded_params, json_res, start_ts);
+    ASSERT_TRUE(search_op.ok());
+
+    auto res = nlohmann::json::parse(json_res);
+    ASSERT_EQ(1, res["hits"].size());
+    ASSERT_FALSE(res["search_cutoff"].get<bool>());
+}
+
+TEST_F(CollectionSpecificMoreTest, AdaptiveSearchConcurrency) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32", "facet": true}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    nlohmann::json doc;
+    doc["title"] = "The quick brown fox";
+    doc["points"] = 100;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    // tiny queries should not pay for forking
+    auto results = coll1->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(1, results["search_concurrency"].get<size_t>());
+
+    results = coll1->search("quick", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(1, results["search_concurrency"].get<size_t>());
+
+    std::vector<std::string> docs;
+    for(size_t i = 0; i < 25000; i++) {
+        nlohmann::json import_doc;
+        import_doc["title"] = "Title " + std::to_string(i);
+        import_doc["points"] = i % 100;
+        docs.push_back(import_doc.dump());
+    }
+
+    nlohmann::json import_response = coll1->add_many(docs, doc);
+    ASSERT_TRUE(import_response["success"].get<bool>());
+
+    results = coll1->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(25001, results["found"].get<size_t>());
+
+    // ceil(25001 / SEARCH_DOCS_PER_THREAD)
+    ASSERT_EQ(3, results["search_concurrency"].get<size_t>());
+
+    // faceting adds to the work done per matched document: ceil(25001 * (1 + 1) / SEARCH_DOCS_PER_THREAD)
+    results = coll1->search("*", {}, "", {"points"}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(6, results["search_concurrency"].get<size_t>());
+}
+
+TEST_F(CollectionSpecificMoreTest, LazyDeletesArePurgedLater) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "brand", "type": "string", "facet": true},
+            {"name": "points", "type": "int32"}
+        ]
+    })"_json;
+
+    auto op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(op.ok());
+    Collection* coll1 = op.get();
+
+    for(size_t i = 0; i < 10; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = (i < 3) ? "vanishing shoe " + std::to_string(i) : "shoe " + std::to_string(i);
+        doc["brand"] = (i < 3) ? "acme" : "nike";
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    Config::get_instance().set_enable_lazy_deletes(true);
+
+    for(size_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(coll1->remove(std::to_string(i)).ok());
+    }
+
+    Config::get_instance().set_enable_lazy_deletes(false);
+
+    // values of the deleted documents are still in the indices, but are hidden from searches
+    ASSERT_EQ(3, coll1->_get_index()->num_tombstones());
+    ASSERT_EQ(7, coll1->get_num_documents());
+
+    const std::string token = "vanishing";
+    auto title_tree = coll1->_get_index()->_get_search_index().at("title");
+    ASSERT_NE(nullptr, art_search(title_tree, (const unsigned char*) token.c_str(), token.size() + 1));
+
+    auto check_results = [&]() {
+        auto results = coll1->search("vanishing", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+        ASSERT_EQ(0, results["found"].get<size_t>());
+
+        results = coll1->search("shoe", {"title"}, "", {"brand"}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+        ASSERT_EQ(7, results["found"].get<size_t>());
+        ASSERT_EQ(1, results["facet_counts"][0]["counts"].size());
+        ASSERT_EQ("nike", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+
+        results = coll1->search("*", {}, "", {"brand"}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+        ASSERT_EQ(7, results["found"].get<size_t>());
+        ASSERT_EQ(1, results["facet_counts"][0]["counts"].size());
+        ASSERT_EQ(7, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+
+        results = coll1->search("*", {}, "points:<5", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+        ASSERT_EQ(2, results["found"].get<size_t>());
+    };
+
+    check_results();
+
+    ASSERT_EQ(3, coll1->purge_tombstones());
+    ASSERT_EQ(0, coll1->_get_index()->num_tombstones());
+    ASSERT_EQ(nullptr, art_search(title_tree, (const unsigned char*) token.c_str(), token.size() + 1));
+
+    check_results();
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionSpecificMoreTest, BatchIsIndexedInWriteLockSlices) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32"}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    // many times the number of records that are indexed under a single hold of the write lock
+    const size_t num_docs = (Index::WRITE_LOCK_BATCH_SIZE * 50) + 37;
+    std::vector<std::string> docs;
+    for(size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        doc["title"] = "Title " + std::to_string(i);
+        doc["points"] = i;
+        docs.push_back(doc.dump());
+    }
+
+    std::atomic<bool> import_done = false;
+    std::vector<size_t> found_during_import;
+    size_t num_failed_searches = 0;
+
+    // assertions cannot fail the test from this thread, so the results are checked after it is joined
+    std::thread search_thread([&]() {
+        while(!import_done) {
+            auto res_op = coll1->search("title", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false});
+            if(!res_op.ok()) {
+                num_failed_searches++;
+                continue;
+            }
+
+            found_during_import.push_back(res_op.get()["found"].get<size_t>());
+        }
+    });
+
+    nlohmann::json document;
+    nlohmann::json import_response = coll1->add_many(docs, document);
+    import_done = true;
+    search_thread.join();
+
+    ASSERT_TRUE(import_response["success"].get<bool>());
+    ASSERT_EQ(num_docs, import_response["num_imported"].get<size_t>());
+    ASSERT_EQ(0, num_failed_searches);
+
+    // searches that ran between the slices of the batch only saw whole slices
+    for(size_t found: found_during_import) {
+        if(found != num_docs) {
+            ASSERT_EQ(0, found % Index::WRITE_LOCK_BATCH_SIZE);
+        }
+    }
+
+    auto results = coll1->search("title", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(num_docs, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "points:>=" + std::to_string(num_docs - 37), {}, {}, {0}, 10, 1,
+                            FREQUENCY, {false}).get();
+    ASSERT_EQ(37, results["found"].get<size_t>());
+
+    // dropped field is detached under the write lock and destroyed after it is released
+    auto schema_changes = R"({
+        "fields": [
+            {"name": "points", "drop": true}
+        ]
+    })"_json;
+
+    auto alter_op = coll1->alter(schema_changes);
+    ASSERT_TRUE(alter_op.ok());
+
+    auto res_op = coll1->search("*", {}, "points:>=0", {}, {}, {0}, 10, 1, FREQUENCY, {false});
+    ASSERT_FALSE(res_op.ok());
+
+    results = coll1->search("title", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(num_docs, results["found"].get<size_t>());
+}
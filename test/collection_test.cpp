@@ -1272,6 +1272,51 @@ TEST_F(CollectionTest, ImportDocumentsUpsert) {
     ASSERT_EQ(409, import_results[1]["code"].get<size_t>());
 }
 
+TEST_F(CollectionTest, ImportDocumentsAcrossParseBatches) {
+    Collection* coll1;
+    std::vector<field> fields = {
+            field("title", field_types::STRING, false, false),
+            field("points", field_types::INT32, false, false)
+    };
+
+    coll1 = collectionManager.get_collection("coll1").get();
+    if (coll1 == nullptr) {
+        coll1 = collectionManager.create_collection("coll1", 4, fields).get();
+    }
+
+    // lines are parsed ahead a batch at a time: the bad line and the repeated ID fall in different batches
+    std::vector<std::string> records;
+    for(size_t i = 0; i < 2500; i++) {
+        if(i == 1500) {
+            records.push_back(R"({"id": "1500", "title": "Bad)");
+        } else if(i == 2200) {
+            records.push_back(R"({"id": "2100", "title": "Repeated", "points": 2200})");
+        } else {
+            records.push_back(R"({"id": ")" + std::to_string(i) + R"(", "title": "Title", "points": )" +
+                              std::to_string(i) + "}");
+        }
+    }
+
+    nlohmann::json document;
+    nlohmann::json import_response = coll1->add_many(records, document, UPSERT);
+    ASSERT_FALSE(import_response["success"].get<bool>());
+    ASSERT_EQ(2499, import_response["num_imported"].get<int>());
+
+    std::vector<nlohmann::json> import_results = import_res_to_json(records);
+    for(size_t i = 0; i < import_results.size(); i++) {
+        ASSERT_EQ(i != 1500, import_results[i]["success"].get<bool>());
+    }
+
+    ASSERT_EQ(0, import_results[1500]["error"].get<std::string>().rfind("Bad JSON", 0));
+    ASSERT_EQ(R"({"id": "1500", "title": "Bad)", import_results[1500]["document"].get<std::string>());
+
+    ASSERT_EQ(2498, coll1->get_num_documents());
+    ASSERT_EQ("Repeated", coll1->get("2100").get()["title"].get<std::string>());
+    ASSERT_EQ("Title", coll1->get("2499").get()["title"].get<std::string>());
+
+    collectionManager.drop_collection("coll1");
+}
+
 TEST_F(CollectionTest, ImportDocumentsEmplace) {
     Collection* coll1;
     std::vector<field> fields = {
@@ -5,12 +5,14 @@
 #include "collection.h"
 #include <cstdlib>
 #include <ctime>
+#include <thread>
 #include "conversation_manager.h"
 #include "conversation_model_manager.h"
 #include "index.h"
 #include "core_api.h"
 #include "vq_model_manager.h"
 #include "conversation_model.h"
+#include "embedding_pipeline.h"
 
 class CollectionVectorTest : public ::testing::Test {
 protected:
@@ -1311,6 +1313,191 @@ TEST_F(CollectionVectorTest, SortKeywordSearchWithAutoEmbedVector) {
     ASSERT_GE(0.175, actual_dist);
 }
 
+TEST_F(CollectionVectorTest, QueryEmbeddingCacheSharedAcrossCollections) {
+    ASSERT_EQ("the lord of the rings", EmbedderManager::normalize_query("  the lord\tof the\n\nrings "));
+    ASSERT_EQ("", EmbedderManager::normalize_query(" \t "));
+
+    EmbedderManager::set_model_dir("/tmp/typesense_test/models");
+
+    std::vector<Collection*> colls;
+    for(const std::string& name: {"coll1", "coll2"}) {
+        nlohmann::json schema = R"({
+                "fields": [
+                    {"name": "title", "type": "string"},
+                    {"name": "embedding", "type":"float[]", "embed":{"from": ["title"],
+                        "model_config": {"model_name": "ts/e5-small"}}}
+                ]
+            })"_json;
+        schema["name"] = name;
+
+        auto op = collectionManager.create_collection(schema);
+        ASSERT_TRUE(op.ok());
+        colls.push_back(op.get());
+
+        nlohmann::json doc;
+        doc["title"] = "The Lord of the Rings";
+        ASSERT_TRUE(colls.back()->add(doc.dump()).ok());
+    }
+
+    nlohmann::json stats_before;
+    EmbedderManager::get_instance().get_query_embedding_cache_stats(stats_before);
+
+    auto results = colls[0]->search("lord of the rings", {"embedding"}, "", {}, {}, {0}, 10, 1, FREQUENCY,
+                                    {false}).get();
+    ASSERT_EQ(1, results["hits"].size());
+    auto first_dist = results["hits"][0]["vector_distance"].get<float>();
+
+    nlohmann::json stats;
+    EmbedderManager::get_instance().get_query_embedding_cache_stats(stats);
+    ASSERT_EQ(stats_before["misses"].get<size_t>() + 1, stats["misses"].get<size_t>());
+    ASSERT_EQ(stats_before["hits"].get<size_t>(), stats["hits"].get<size_t>());
+
+    // same query with different whitespace, on another collection with the same model
+    results = colls[1]->search(" lord of  the rings ", {"embedding"}, "", {}, {}, {0}, 10, 1, FREQUENCY,
+                               {false}).get();
+    ASSERT_EQ(1, results["hits"].size());
+    ASSERT_FLOAT_EQ(first_dist, results["hits"][0]["vector_distance"].get<float>());
+
+    EmbedderManager::get_instance().get_query_embedding_cache_stats(stats);
+    ASSERT_EQ(stats_before["misses"].get<size_t>() + 1, stats["misses"].get<size_t>());
+    ASSERT_EQ(stats_before["hits"].get<size_t>() + 1, stats["hits"].get<size_t>());
+
+    // a cached embedding is not reused once the model is deleted
+    EmbedderManager::get_instance().delete_all_text_embedders();
+    EmbedderManager::get_instance().get_query_embedding_cache_stats(stats);
+    ASSERT_EQ(0, stats["num_entries"].get<size_t>());
+}
+
+TEST_F(CollectionVectorTest, ConcurrentQueryEmbeddingsOnLocalModel) {
+    EmbedderManager::set_model_dir("/tmp/typesense_test/models");
+
+    nlohmann::json model_config = R"({
+        "model_name": "ts/e5-small"
+    })"_json;
+
+    size_t num_dims = 0;
+    ASSERT_TRUE(EmbedderManager::get_instance().validate_and_init_model(model_config, num_dims).ok());
+    auto embedder = EmbedderManager::get_instance().get_text_embedder(model_config).get();
+
+    std::vector<std::string> queries;
+    for(size_t i = 0; i < TextEmbedder::QUERY_BATCH_MAX_SIZE + 4; i++) {
+        queries.push_back("query number " + std::to_string(i) + (i % 2 == 0 ? " with a few more words" : ""));
+    }
+
+    auto expected = embedder->batch_embed(queries);
+    ASSERT_EQ(queries.size(), expected.size());
+
+    std::vector<embedding_res_t> results(queries.size());
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < queries.size(); i++) {
+        threads.emplace_back([&, i]() {
+            results[i] = embedder->Embed(queries[i]);
+        });
+    }
+
+    for(auto& thread: threads) {
+        thread.join();
+    }
+
+    for(size_t i = 0; i < queries.size(); i++) {
+        ASSERT_TRUE(results[i].success);
+        ASSERT_EQ(num_dims, results[i].embedding.size());
+        for(size_t j = 0; j < num_dims; j++) {
+            ASSERT_NEAR(expected[i].embedding[j], results[i].embedding[j], 0.0001);
+        }
+    }
+}
+
+TEST_F(CollectionVectorTest, AsyncEmbeddingPipeline) {
+    nlohmann::json schema = R"({
+                            "name": "objects",
+                            "fields": [
+                            {"name": "name", "type": "string"},
+                            {"name": "embedding", "type":"float[]", "embed":{"from": ["name"], "model_config": {"model_name": "ts/e5-small"}}}
+                            ]
+                        })"_json;
+
+    EmbedderManager::set_model_dir("/tmp/typesense_test/models");
+
+    auto op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(op.ok());
+    Collection* coll = op.get();
+
+    auto& pipeline = EmbeddingPipeline::get_instance();
+    pipeline.init(2, 3);
+    std::thread pipeline_thread([&pipeline]() {
+        pipeline.run(nullptr);
+    });
+
+    auto wait_for_embeddings = [&]() {
+        for(size_t i = 0; i < 600 && pipeline.get_num_pending_docs() != 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        ASSERT_EQ(0, pipeline.get_num_pending_docs());
+    };
+
+    std::vector<std::string> json_lines;
+    for(const std::string& name: {"butter", "butterball", "butterfly"}) {
+        nlohmann::json object;
+        object["id"] = std::to_string(json_lines.size());
+        object["name"] = name;
+        json_lines.push_back(object.dump());
+    }
+
+    nlohmann::json document;
+    auto import_res = coll->add_many(json_lines, document);
+    ASSERT_TRUE(import_res["success"].get<bool>());
+
+    // searchable by keyword right away
+    auto results = coll->search("butterfly", {"name"}, "", {}, {}, {0}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+
+    wait_for_embeddings();
+
+    for(size_t i = 0; i < 3; i++) {
+        auto doc = coll->get(std::to_string(i)).get();
+        ASSERT_EQ(384, doc["embedding"].size());
+    }
+
+    results = coll->search("butter", {"embedding"}, "", {}, {}, {0}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    // changing the embedded field queues the document again
+    auto old_embedding = coll->get("2").get()["embedding"];
+    ASSERT_TRUE(coll->add(R"({"id": "2", "name": "dragonfly"})", UPDATE).ok());
+    wait_for_embeddings();
+
+    auto new_embedding = coll->get("2").get()["embedding"];
+    ASSERT_EQ(384, new_embedding.size());
+    ASSERT_NE(old_embedding, new_embedding);
+
+    nlohmann::json stats;
+    pipeline.get_stats(stats);
+    ASSERT_EQ(4, stats["embedded_documents"].get<size_t>());
+    ASSERT_EQ(0, stats["failed_documents"].get<size_t>());
+
+    // fields that are not stored cannot be embedded later, so the embeddings are generated right away
+    schema = R"({
+                "name": "unstored_objects",
+                "fields": [
+                {"name": "name", "type": "string", "store": false},
+                {"name": "embedding", "type":"float[]", "embed":{"from": ["name"], "model_config": {"model_name": "ts/e5-small"}}}
+                ]
+            })"_json;
+
+    Collection* unstored_coll = collectionManager.create_collection(schema).get();
+    ASSERT_TRUE(unstored_coll->add(R"({"id": "0", "name": "butterfly"})").ok());
+    ASSERT_EQ(0, pipeline.get_num_pending_docs());
+    ASSERT_EQ(384, unstored_coll->get("0").get()["embedding"].size());
+
+    results = unstored_coll->search("butterfly", {"embedding"}, "", {}, {}, {0}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+
+    pipeline.stop();
+    pipeline_thread.join();
+    ASSERT_FALSE(pipeline.is_enabled());
+}
+
 TEST_F(CollectionVectorTest, HybridSearchWithExplicitVector) {
     nlohmann::json schema = R"({
                             "name": "objects",
@@ -5026,4 +5213,480 @@ TEST_F(CollectionVectorTest, TestDistanceThresholdWithIP) {
     ASSERT_EQ(9.637892723083496, res["hits"][3]["vector_distance"].get<float>());
     ASSERT_EQ("document_0", res["hits"][4]["document"]["name"]);
     ASSERT_EQ(288.0364685058594, res["hits"][4]["vector_distance"].get<float>());
-}
\ No newline at end of file
+}
+
+TEST_F(CollectionVectorTest, QuantizedVectorIndex) {
+    nlohmann::json schema_json = R"({
+        "name": "test",
+        "fields": [
+            {"name": "vector", "type": "float[]", "num_dim": 8, "hnsw_params": {"quantization": "int4"}}
+        ]
+    })"_json;
+
+    auto collection_create_op = collectionManager.create_collection(schema_json);
+    ASSERT_FALSE(collection_create_op.ok());
+    ASSERT_EQ("Property `hnsw_params.quantization` must be one of `none`, `float16` or `int8`.",
+              collection_create_op.error());
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::vector<std::vector<float>> vectors;
+
+    for(size_t i = 0; i < 1200; i++) {
+        std::vector<float> vector(8);
+        std::generate(vector.begin(), vector.end(), [&](){ return dist(rng); });
+        vectors.push_back(vector);
+    }
+
+    for(const std::string quantization: {"float16", "int8"}) {
+        schema_json["name"] = "test_" + quantization;
+        schema_json["fields"][0]["hnsw_params"]["quantization"] = quantization;
+
+        collection_create_op = collectionManager.create_collection(schema_json);
+        ASSERT_TRUE(collection_create_op.ok());
+        auto collection = collection_create_op.get();
+
+        ASSERT_EQ(quantization, collection->get_summary_json()["fields"][0]["hnsw_params"]["quantization"]);
+
+        // int8 vectors are searched exhaustively until enough of them are available for training
+        for(size_t num_docs: {500, 1200}) {
+            for(size_t i = collection->get_num_documents(); i < num_docs; i++) {
+                nlohmann::json doc;
+                doc["id"] = std::to_string(i);
+                doc["vector"] = vectors[i];
+                ASSERT_TRUE(collection->add(doc.dump()).ok());
+            }
+
+            std::string query_vector_str = "vector:([";
+            for(size_t i = 0; i < 8; i++) {
+                query_vector_str += std::to_string(vectors[42][i]) + (i != 7 ? ", " : "");
+            }
+            query_vector_str += "], k:5)";
+
+            auto results = collection->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false},
+                                              Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                              spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {},
+                                              {}, 0, "<mark>", "</mark>", {}, 1000, true, false, true, "", false,
+                                              10000, 4, 7, fallback, 4, {off}, 100, 100, 2, 2, false,
+                                              query_vector_str).get();
+
+            ASSERT_EQ(5, results["hits"].size());
+            ASSERT_EQ("42", results["hits"][0]["document"]["id"]);
+            ASSERT_NEAR(0, results["hits"][0]["vector_distance"].get<float>(), 0.02);
+        }
+
+        ASSERT_EQ(1200, collection->_get_index()->_get_vector_index().at("vector")->vecdex->getCurrentElementCount());
+
+        // removal works both for the exact copies and for the quantized vectors
+        ASSERT_TRUE(collection->remove("42").ok());
+        ASSERT_EQ(1, collection->_get_index()->_get_vector_index().at("vector")->vecdex->getDeletedCount());
+    }
+
+    // quantization is persisted with the schema
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/collection_vector_search");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    ASSERT_TRUE(collectionManager.load(8, 1000).ok());
+
+    for(const auto& [quantization, expected_quantization]:
+            std::vector<std::pair<std::string, vector_quantization_t>>{{"float16", vector_quantization_t::float16},
+                                                                       {"int8", vector_quantization_t::int8}}) {
+        auto collection = collectionManager.get_collection("test_" + quantization).get();
+        ASSERT_EQ(1199, collection->get_num_documents());
+        ASSERT_EQ(quantization, collection->get_summary_json()["fields"][0]["hnsw_params"]["quantization"]);
+        ASSERT_EQ(expected_quantization, collection->_get_index()->_get_vector_index().at("vector")->quantization);
+    }
+}
+
+TEST_F(CollectionVectorTest, IVFVectorIndex) {
+    nlohmann::json schema_json = R"({
+        "name": "test",
+        "fields": [
+            {"name": "vector", "type": "float[]", "num_dim": 8, "ivf_params": {"nlist": 4, "pq_m": 3}}
+        ]
+    })"_json;
+
+    auto collection_create_op = collectionManager.create_collection(schema_json);
+    ASSERT_FALSE(collection_create_op.ok());
+    ASSERT_EQ("Property `ivf_params.pq_m` must be a non-negative integer that divides `num_dim`.",
+              collection_create_op.error());
+
+    schema_json["fields"][0]["ivf_params"]["pq_m"] = 0;
+    schema_json["fields"][0]["hnsw_params"]["quantization"] = "int8";
+    collection_create_op = collectionManager.create_collection(schema_json);
+    ASSERT_FALSE(collection_create_op.ok());
+    ASSERT_EQ("Property `ivf_params` cannot be combined with `hnsw_params.quantization`.",
+              collection_create_op.error());
+
+    schema_json["fields"][0].erase("hnsw_params");
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::vector<std::vector<float>> vectors;
+
+    for(size_t i = 0; i < 1200; i++) {
+        std::vector<float> vector(8);
+        std::generate(vector.begin(), vector.end(), [&](){ return dist(rng); });
+        vectors.push_back(vector);
+    }
+
+    // cosine distances of the documents to the query, the nearest first
+    std::vector<std::pair<float, size_t>> exact_dist_ids;
+    for(size_t i = 0; i < vectors.size(); i++) {
+        float dot = 0, query_norm = 0, norm = 0;
+        for(size_t j = 0; j < 8; j++) {
+            dot += vectors[42][j] * vectors[i][j];
+            query_norm += vectors[42][j] * vectors[42][j];
+            norm += vectors[i][j] * vectors[i][j];
+        }
+        exact_dist_ids.emplace_back(1 - dot / std::sqrt(query_norm * norm), i);
+    }
+    std::sort(exact_dist_ids.begin(), exact_dist_ids.end());
+
+    std::string query_vector_str = "vector:([";
+    for(size_t i = 0; i < 8; i++) {
+        query_vector_str += std::to_string(vectors[42][i]) + (i != 7 ? ", " : "");
+    }
+    query_vector_str += "], k:10, nprobe:4)";
+
+    for(size_t pq_m: {0, 4}) {
+        schema_json["name"] = "test_" + std::to_string(pq_m);
+        schema_json["fields"][0]["ivf_params"]["pq_m"] = pq_m;
+
+        collection_create_op = collectionManager.create_collection(schema_json);
+        ASSERT_TRUE(collection_create_op.ok());
+        auto collection = collection_create_op.get();
+
+        auto ivf_params = collection->get_summary_json()["fields"][0]["ivf_params"];
+        ASSERT_EQ(4, ivf_params["nlist"]);
+        ASSERT_EQ(8, ivf_params["nprobe"]);
+        ASSERT_EQ(pq_m, ivf_params["pq_m"]);
+
+        for(size_t i = 0; i < vectors.size(); i++) {
+            nlohmann::json doc;
+            doc["id"] = std::to_string(i);
+            doc["vector"] = vectors[i];
+            ASSERT_TRUE(collection->add(doc.dump()).ok());
+        }
+
+        auto results = collection->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false},
+                                          Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                          spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {},
+                                          {}, 0, "<mark>", "</mark>", {}, 1000, true, false, true, "", false,
+                                          10000, 4, 7, fallback, 4, {off}, 100, 100, 2, 2, false,
+                                          query_vector_str).get();
+
+        ASSERT_EQ(10, results["hits"].size());
+        ASSERT_EQ("ivf", results["vector_search_strategy"].get<std::string>());
+
+        std::set<std::string> exact_ids;
+        for(size_t i = 0; i < 10; i++) {
+            exact_ids.insert(std::to_string(exact_dist_ids[i].second));
+        }
+
+        size_t num_found = 0;
+        for(const auto& hit: results["hits"]) {
+            num_found += exact_ids.count(hit["document"]["id"].get<std::string>());
+        }
+
+        if(pq_m == 0) {
+            // with all partitions probed, the flat index is exact
+            ASSERT_EQ(10, num_found);
+            ASSERT_EQ("42", results["hits"][0]["document"]["id"]);
+            ASSERT_NEAR(0, results["hits"][0]["vector_distance"].get<float>(), 0.001);
+        } else {
+            ASSERT_GE(num_found, 3);
+        }
+
+        ASSERT_TRUE(collection->remove("42").ok());
+        ASSERT_FALSE(collection->_get_index()->_get_vector_index().at("vector")->ivf->contains(42));
+        ASSERT_EQ(1199, collection->_get_index()->_get_vector_index().at("vector")->ivf->size());
+    }
+}
+
+TEST_F(CollectionVectorTest, FilteredVectorSearchStrategy) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "points", "type": "int32"},
+            {"name": "vec", "type": "float[]", "num_dim": 4}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist;
+
+    for(size_t i = 0; i < 3000; i++) {
+        std::vector<float> vec(4);
+        std::generate(vec.begin(), vec.end(), [&](){ return dist(rng); });
+
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["points"] = i;
+        doc["vec"] = vec;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::vector<std::pair<std::string, std::string>> filter_strategies = {
+        {"", "hnsw"},
+        {"points:<100", "brute_force"},
+        {"points:<1200", "filtered_hnsw"},
+        {"points:<2900", "post_filter"},
+    };
+
+    for(const auto& filter_strategy: filter_strategies) {
+        auto results = coll1->search("*", {}, filter_strategy.first, {}, {}, {0}, 10, 1, FREQUENCY, {true},
+                                     Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                     spp::sparse_hash_set<std::string>(), 10, "", 30, 5, "", 10, {}, {}, {}, 0,
+                                     "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                                     fallback, 4, {off}, 32767, 32767, 2, false, true,
+                                     "vec:([0.5, 0.5, 0.5, 0.5], k: 10)").get();
+
+        ASSERT_EQ(filter_strategy.second, results["vector_search_strategy"].get<std::string>());
+        ASSERT_EQ(10, results["hits"].size());
+
+        if(!filter_strategy.first.empty()) {
+            const int64_t max_points = std::stoll(filter_strategy.first.substr(8));
+            for(const auto& hit: results["hits"]) {
+                ASSERT_LT(hit["document"]["points"].get<int64_t>(), max_points);
+            }
+        }
+    }
+
+    // an explicit `flat_search_cutoff` still takes precedence
+    auto results = coll1->search("*", {}, "points:<1200", {}, {}, {0}, 10, 1, FREQUENCY, {true},
+                                 Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 10, "", 30, 5, "", 10, {}, {}, {}, 0,
+                                 "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                                 fallback, 4, {off}, 32767, 32767, 2, false, true,
+                                 "vec:([0.5, 0.5, 0.5, 0.5], flat_search_cutoff: 5000)").get();
+
+    ASSERT_EQ("brute_force", results["vector_search_strategy"].get<std::string>());
+}
+
+TEST_F(CollectionVectorTest, HybridSearchWithFilteredVectorLeg) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32"},
+            {"name": "vec", "type": "float[]", "num_dim": 4}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist;
+
+    for(size_t i = 0; i < 300; i++) {
+        std::vector<float> vec(4);
+        std::generate(vec.begin(), vec.end(), [&](){ return dist(rng); });
+
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = (i % 2 == 0) ? "even" : "odd";
+        doc["points"] = i;
+        doc["vec"] = vec;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    for(const std::string& filter: {"", "points:<100"}) {
+        auto results = coll1->search("even", {"title"}, filter, {}, {}, {0}, 200, 1, FREQUENCY, {true},
+                                     Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                     spp::sparse_hash_set<std::string>(), 10, "", 30, 5, "", 10, {}, {}, {}, 0,
+                                     "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                                     fallback, 4, {off}, 32767, 32767, 2, false, true,
+                                     "vec:([0.5, 0.5, 0.5, 0.5], k: 20)").get();
+
+        ASSERT_EQ(filter.empty() ? "hnsw" : "brute_force", results["vector_search_strategy"].get<std::string>());
+
+        // keyword matches, plus the nearest neighbours that only the vector leg found
+        size_t num_odd = 0;
+        for(const auto& hit: results["hits"]) {
+            const auto& document = hit["document"];
+            if(!filter.empty()) {
+                ASSERT_LT(document["points"].get<int64_t>(), 100);
+            }
+
+            if(document["title"] == "odd") {
+                num_odd++;
+                ASSERT_TRUE(hit.contains("vector_distance"));
+            }
+        }
+
+        ASSERT_EQ(filter.empty() ? 150 : 50, results["found"].get<size_t>() - num_odd);
+        ASSERT_GT(num_odd, 0);
+    }
+}
+
+TEST_F(CollectionVectorTest, RestoreSavedVectorIndex) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "vec", "type": "float[]", "num_dim": 4}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist;
+
+    auto add_doc = [&](size_t id) {
+        std::vector<float> vec(4);
+        std::generate(vec.begin(), vec.end(), [&](){ return dist(rng); });
+
+        nlohmann::json doc;
+        doc["id"] = std::to_string(id);
+        doc["vec"] = vec;
+        return coll1->add(doc.dump()).ok();
+    };
+
+    for(size_t i = 0; i < 100; i++) {
+        ASSERT_TRUE(add_doc(i));
+    }
+
+    const std::string vector_index_dir = "/tmp/typesense_test/collection_vector_search_vi";
+    system(("rm -rf " + vector_index_dir).c_str());
+
+    store->insert(CollectionManager::VECTOR_INDEX_SNAPSHOT_KEY, "42");
+    collectionManager.save_vector_indices(vector_index_dir, 42);
+
+    // changes made after the save must be reconciled during load
+    ASSERT_TRUE(coll1->remove("7").ok());
+    ASSERT_TRUE(add_doc(100));
+
+    nlohmann::json updated_doc;
+    updated_doc["id"] = "3";
+    updated_doc["vec"] = std::vector<float>{0.9, 0.1, 0.9, 0.1};
+    ASSERT_TRUE(coll1->add(updated_doc.dump(), UPSERT).ok());
+
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/collection_vector_search");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    collectionManager.set_vector_index_snapshot_path(vector_index_dir);
+    ASSERT_TRUE(collectionManager.load(8, 1000).ok());
+    collectionManager.set_vector_index_snapshot_path("");
+
+    coll1 = collectionManager.get_collection("coll1").get();
+    auto vecdex = coll1->_get_index()->_get_vector_index().at("vec")->vecdex;
+
+    ASSERT_EQ(101, vecdex->getCurrentElementCount());
+    ASSERT_EQ(1, vecdex->getDeletedCount());
+
+    auto results = coll1->search("*", {}, "", {}, {}, {0}, 200, 1, FREQUENCY, {true},
+                                 Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 10, "", 30, 5, "", 10, {}, {}, {}, 0,
+                                 "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                                 fallback, 4, {off}, 32767, 32767, 2, false, true,
+                                 "vec:([0.5, 0.5, 0.5, 0.5], k: 200)").get();
+
+    ASSERT_EQ(100, results["hits"].size());
+
+    // the graph has the vector of the updated document
+    results = coll1->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true},
+                            Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                            spp::sparse_hash_set<std::string>(), 10, "", 30, 5, "", 10, {}, {}, {}, 0,
+                            "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                            fallback, 4, {off}, 32767, 32767, 2, false, true,
+                            "vec:([0.9, 0.1, 0.9, 0.1], k: 1)").get();
+
+    ASSERT_EQ(1, results["hits"].size());
+    ASSERT_EQ("3", results["hits"][0]["document"]["id"].get<std::string>());
+    ASSERT_NEAR(0, results["hits"][0]["vector_distance"].get<float>(), 0.0001);
+
+    // a save that began before the raft index of the snapshot is ignored
+    store->insert(CollectionManager::VECTOR_INDEX_SNAPSHOT_KEY, "43");
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/collection_vector_search");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    collectionManager.set_vector_index_snapshot_path(vector_index_dir);
+    ASSERT_TRUE(collectionManager.load(8, 1000).ok());
+    collectionManager.set_vector_index_snapshot_path("");
+
+    coll1 = collectionManager.get_collection("coll1").get();
+    vecdex = coll1->_get_index()->_get_vector_index().at("vec")->vecdex;
+
+    ASSERT_EQ(100, vecdex->getCurrentElementCount());
+    ASSERT_EQ(0, vecdex->getDeletedCount());
+}
+
+TEST_F(CollectionVectorTest, WritesContinueDuringVectorIndexSave) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "vec", "type": "float[]", "num_dim": 16}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist;
+
+    auto get_doc = [&](size_t id) {
+        std::vector<float> vec(16);
+        std::generate(vec.begin(), vec.end(), [&](){ return dist(rng); });
+
+        nlohmann::json doc;
+        doc["id"] = std::to_string(id);
+        doc["vec"] = vec;
+        return doc.dump();
+    };
+
+    std::vector<std::string> docs;
+    for(size_t i = 0; i < 5000; i++) {
+        docs.push_back(get_doc(i));
+    }
+
+    nlohmann::json document;
+    ASSERT_TRUE(coll1->add_many(docs, document)["success"].get<bool>());
+
+    const std::string vector_index_dir = "/tmp/typesense_test/collection_vector_search_vi";
+    system(("rm -rf " + vector_index_dir).c_str());
+
+    // snapshot of the store is taken at raft index 42, and the indices are saved while writes continue
+    store->insert(CollectionManager::VECTOR_INDEX_SNAPSHOT_KEY, "42");
+
+    std::atomic<bool> save_done = false;
+    std::thread save_thread([&]() {
+        collectionManager.save_vector_indices(vector_index_dir, 42);
+        save_done = true;
+    });
+
+    size_t num_writes = 0;
+    bool writes_ok = true;
+    do {
+        std::vector<std::string> write_docs = {get_doc(5000 + num_writes)};
+        writes_ok = writes_ok && coll1->add_many(write_docs, document)["success"].get<bool>();
+        writes_ok = writes_ok && coll1->remove(std::to_string(num_writes)).ok();
+        num_writes++;
+    } while(!save_done);
+
+    save_thread.join();
+    ASSERT_TRUE(writes_ok);
+
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/collection_vector_search");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    collectionManager.set_vector_index_snapshot_path(vector_index_dir);
+    ASSERT_TRUE(collectionManager.load(8, 1000).ok());
+    collectionManager.set_vector_index_snapshot_path("");
+
+    // the graph that was saved while documents were written and removed is reconciled with the documents
+    coll1 = collectionManager.get_collection("coll1").get();
+    auto vecdex = coll1->_get_index()->_get_vector_index().at("vec")->vecdex;
+    ASSERT_EQ(5000, vecdex->getCurrentElementCount() - vecdex->getDeletedCount());
+    ASSERT_EQ(5000, coll1->get_num_documents());
+}
@@ -1291,6 +1291,28 @@ TEST_F(CoreAPIUtilsTest, TestProxy) {
     ASSERT_EQ(res, resp->body);
 }
 
+TEST_F(CoreAPIUtilsTest, HttpClientReusesHandlesOfHost) {
+    std::string res;
+    std::unordered_map<std::string, std::string> headers;
+    std::map<std::string, std::string> res_headers;
+
+    std::string url = "https://typesense.org";
+
+    long status_code = HttpClient::get_instance().get_response(url, res, res_headers, headers);
+    ASSERT_NE(500, status_code);
+    size_t num_idle_handles = HttpClient::get_num_idle_handles();
+    ASSERT_LE(1, num_idle_handles);
+
+    // the next requests to the host pick up the idle handle, and return it when they are done
+    for(size_t i = 0; i < 3; i++) {
+        res.clear();
+        res_headers.clear();
+        status_code = HttpClient::get_instance().get_response(url, res, res_headers, headers);
+        ASSERT_NE(500, status_code);
+        ASSERT_EQ(num_idle_handles, HttpClient::get_num_idle_handles());
+    }
+}
+
 
 TEST_F(CoreAPIUtilsTest, TestProxyInvalid) {
     nlohmann::json body;
@@ -1749,6 +1771,63 @@ TEST_F(CoreAPIUtilsTest, DeleteNonExistingDoc) {
     ASSERT_EQ(200, res->status_code);
 }
 
+TEST_F(CoreAPIUtilsTest, CoalescedDocumentWrites) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    ASSERT_TRUE(collectionManager.create_collection("coll1", 2, fields, "points").ok());
+    ASSERT_TRUE(collectionManager.create_collection("coll2", 2, fields, "points").ok());
+
+    std::vector<std::string> bodies = {
+        R"({"id": "0", "title": "Title 0", "points": 0})",
+        R"({"id": "1", "title": "Title 1", "points": )",
+        R"({"id": "0", "title": "Title 0 again", "points": 0})",
+        R"({"id": "2", "title": "Title 2", "points": "two"})",
+        R"({"id": "3", "title": "Title 3", "points": 3})",
+    };
+
+    // responses of the writes indexed as one batch must be the same as when they are indexed one by one
+    std::vector<std::shared_ptr<http_req>> reqs;
+    std::vector<std::shared_ptr<http_res>> ress;
+
+    for(const auto& body: bodies) {
+        std::shared_ptr<http_req> req = std::make_shared<http_req>();
+        std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+        req->params["collection"] = "coll1";
+        req->body = body;
+        reqs.push_back(req);
+        ress.push_back(res);
+    }
+
+    post_add_coalesced_documents(reqs, ress);
+
+    for(size_t i = 0; i < bodies.size(); i++) {
+        std::shared_ptr<http_req> req = std::make_shared<http_req>();
+        std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+        req->params["collection"] = "coll2";
+        req->body = bodies[i];
+        post_add_document(req, res);
+
+        ASSERT_EQ(res->status_code, ress[i]->status_code);
+        ASSERT_EQ(res->body, ress[i]->body);
+    }
+
+    ASSERT_EQ(201, ress[0]->status_code);
+    ASSERT_EQ(400, ress[1]->status_code);
+    ASSERT_EQ(409, ress[2]->status_code);
+    ASSERT_EQ(400, ress[3]->status_code);
+    ASSERT_EQ(201, ress[4]->status_code);
+
+    ASSERT_EQ(2, collectionManager.get_collection("coll1")->get_num_documents());
+
+    std::shared_ptr<http_req> req = std::make_shared<http_req>();
+    std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+    req->params["collection"] = "unknown";
+    req->body = bodies[0];
+    post_add_coalesced_documents({req}, {res});
+    ASSERT_EQ(404, res->status_code);
+}
+
 TEST_F(CoreAPIUtilsTest, CollectionsPagination) {
     //remove all collections first
     auto collections = collectionManager.get_collections().get();
@@ -2375,4 +2454,70 @@ TEST_F(CoreAPIUtilsTest, CollectionSchemaResponseWithStoreValue) {
 
     expected_json["created_at"] = res_json["created_at"];
     ASSERT_EQ(expected_json, res_json);
-}
\ No newline at end of file
+}
+TEST_F(CoreAPIUtilsTest, SearchCutoffIsNotCached) {
+    init_api(100);
+
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32", "facet": true}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    for(size_t i = 0; i < 10; i++) {
+        nlohmann::json doc;
+        doc["title"] = "Title " + std::to_string(i);
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::shared_ptr<http_req> req = std::make_shared<http_req>();
+    std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+
+    req->embedded_params_vec.push_back(nlohmann::json::object());
+    req->params["collection"] = "coll1";
+    req->params["q"] = "*";
+    req->params["facet_by"] = "points";
+    req->params["search_cutoff_ms"] = "5000";
+    req->params["use_cache"] = "true";
+
+    // the time budget is measured from when the request was received: 10 seconds ago
+    auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    req->conn_ts = now_us - (10 * 1000 * 1000);
+
+    ASSERT_TRUE(get_search(req, res));
+    ASSERT_EQ(200, res->status_code);
+    ASSERT_TRUE(nlohmann::json::parse(res->body)["search_cutoff"].get<bool>());
+
+    // the same request must not be served the partial results
+    req->conn_ts = now_us;
+    ASSERT_TRUE(get_search(req, res));
+    ASSERT_EQ(200, res->status_code);
+
+    auto res_json = nlohmann::json::parse(res->body);
+    ASSERT_FALSE(res_json["search_cutoff"].get<bool>());
+    ASSERT_EQ(10, res_json["facet_counts"][0]["counts"].size());
+
+    // complete results are cached
+    req->conn_ts = now_us - (10 * 1000 * 1000);
+    ASSERT_TRUE(get_search(req, res));
+    ASSERT_FALSE(nlohmann::json::parse(res->body)["search_cutoff"].get<bool>());
+
+    // with multi search
+    req->params.clear();
+    req->params["use_cache"] = "true";
+    req->body = R"({"searches": [{"collection": "coll1", "q": "*", "facet_by": "points", "search_cutoff_ms": 5000}]})";
+    req->conn_ts = now_us - (10 * 1000 * 1000);
+
+    ASSERT_TRUE(post_multi_search(req, res));
+    ASSERT_TRUE(nlohmann::json::parse(res->body)["results"][0]["search_cutoff"].get<bool>());
+
+    req->conn_ts = now_us;
+    ASSERT_TRUE(post_multi_search(req, res));
+    ASSERT_FALSE(nlohmann::json::parse(res->body)["results"][0]["search_cutoff"].get<bool>());
+}
@@ -1395,6 +1395,127 @@ TEST_F(PostingListTest, PostingListMustHaveAtleast1Element) {
     }
 }
 
+TEST_F(PostingListTest, UpsertMany) {
+    auto assert_same_blocks = [](posting_list_t& expected, posting_list_t& actual) {
+        ASSERT_EQ(expected.num_ids(), actual.num_ids());
+        ASSERT_EQ(expected.num_blocks(), actual.num_blocks());
+
+        posting_list_t::block_t* expected_block = expected.get_root();
+        posting_list_t::block_t* actual_block = actual.get_root();
+
+        while(expected_block != nullptr) {
+            ASSERT_NE(nullptr, actual_block);
+            ASSERT_EQ(expected_block->size(), actual_block->size());
+            ASSERT_EQ(expected_block->offsets.getLength(), actual_block->offsets.getLength());
+            ASSERT_EQ(expected_block, expected.block_of(expected_block->ids.last()));
+            ASSERT_EQ(actual_block, actual.block_of(actual_block->ids.last()));
+
+            for(size_t i = 0; i < expected_block->size(); i++) {
+                ASSERT_EQ(expected_block->ids.at(i), actual_block->ids.at(i));
+                ASSERT_EQ(expected_block->offset_index.at(i), actual_block->offset_index.at(i));
+            }
+
+            for(size_t i = 0; i < expected_block->offsets.getLength(); i++) {
+                ASSERT_EQ(expected_block->offsets.at(i), actual_block->offsets.at(i));
+            }
+
+            expected_block = expected_block->next;
+            actual_block = actual_block->next;
+        }
+
+        ASSERT_EQ(nullptr, actual_block);
+    };
+
+    posting_list_t expected(5);
+    posting_list_t actual(5);
+
+    for(uint32_t id = 0; id <= 20; id += 2) {
+        expected.upsert(id, {id, id + 1});
+        actual.upsert(id, {id, id + 1});
+    }
+
+    // an update and inserts in the middle of the list, followed by appends that span several blocks
+    std::vector<uint32_t> ids = {3, 9, 20};
+    for(uint32_t id = 21; id < 40; id++) {
+        ids.push_back(id);
+    }
+
+    std::vector<uint32_t> offset_index;
+    std::vector<uint32_t> offsets;
+
+    for(auto id: ids) {
+        std::vector<uint32_t> id_offsets(1 + id % 3, id * 2);
+        offset_index.push_back(offsets.size());
+        offsets.insert(offsets.end(), id_offsets.begin(), id_offsets.end());
+        expected.upsert(id, id_offsets);
+    }
+
+    actual.upsert_many(ids.size(), ids.data(), offset_index.data(), offsets.size(), offsets.data());
+    assert_same_blocks(expected, actual);
+
+    // appending to an empty list
+    posting_list_t expected_fresh(5);
+    posting_list_t actual_fresh(5);
+
+    for(size_t i = 0; i < ids.size(); i++) {
+        const uint32_t offsets_end = (i + 1 == ids.size()) ? offsets.size() : offset_index[i + 1];
+        expected_fresh.upsert(ids[i], std::vector<uint32_t>(offsets.begin() + offset_index[i],
+                                                            offsets.begin() + offsets_end));
+    }
+
+    actual_fresh.upsert_many(ids.size(), ids.data(), offset_index.data(), offsets.size(), offsets.data());
+    assert_same_blocks(expected_fresh, actual_fresh);
+
+    // a compact list is converted to a full list midway
+    uint32_t first_id = 0, first_offset_index = 0;
+    std::vector<uint32_t> first_offsets = {0};
+    void* obj = SET_COMPACT_POSTING(compact_posting_list_t::create(1, &first_id, &first_offset_index, 1,
+                                                                   first_offsets.data()));
+
+    posting_t::upsert_many(obj, ids.size(), ids.data(), offset_index.data(), offsets.size(), offsets.data());
+    ASSERT_FALSE(IS_COMPACT_POSTING(obj));
+    ASSERT_EQ(ids.size() + 1, posting_t::num_ids(obj));
+
+    for(auto id: ids) {
+        ASSERT_TRUE(posting_t::contains(obj, id));
+    }
+
+    posting_t::destroy_list(obj);
+}
+
+TEST_F(PostingListTest, DISABLED_BenchmarkUpsertMany) {
+    const size_t num_ids = 100000;
+    std::vector<uint32_t> ids, offset_index, offsets;
+
+    for(uint32_t id = 0; id < num_ids; id++) {
+        ids.push_back(id);
+        offset_index.push_back(offsets.size());
+        offsets.insert(offsets.end(), {0, 1, 3});
+    }
+
+    posting_list_t pl(posting_t::MAX_BLOCK_ELEMENTS);
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for(auto id: ids) {
+        pl.upsert(id, {0, 1, 3});
+    }
+
+    long long int timeMicros =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - begin).count();
+
+    LOG(INFO) << "Time taken for " << num_ids << " upserts: " << timeMicros;
+
+    posting_list_t bulk_pl(posting_t::MAX_BLOCK_ELEMENTS);
+    begin = std::chrono::high_resolution_clock::now();
+
+    bulk_pl.upsert_many(ids.size(), ids.data(), offset_index.data(), offsets.size(), offsets.data());
+
+    timeMicros =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - begin).count();
+
+    LOG(INFO) << "Time taken for " << num_ids << " bulk upserts: " << timeMicros;
+}
+
 TEST_F(PostingListTest, DISABLED_RandInsertAndErase) {
     std::vector<uint32_t> offsets = {0, 1, 3};
     posting_list_t pl(5);
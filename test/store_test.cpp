@@ -165,4 +165,108 @@ TEST(StoreTest, Contains) {
     ASSERT_EQ(true, primary_store.contains("foo4"));
     ASSERT_EQ(false, primary_store.contains("foo"));
     ASSERT_EQ(false, primary_store.contains("foo5"));
-}
\ No newline at end of file
+}
+
+TEST(StoreTest, CollectionColumnFamilies) {
+    std::string primary_store_path = "/tmp/typesense_test/primary_store_test";
+    LOG(INFO) << "Truncating and creating: " << primary_store_path;
+    system(("rm -rf "+primary_store_path+" && mkdir -p "+primary_store_path).c_str());
+
+    Store primary_store(primary_store_path, 0, 0, true);  // disable WAL
+    primary_store.insert("1_$SI_1", "doc1");
+    primary_store.insert("1_$SI_2", "doc2");
+    primary_store.insert("10_$SI_1", "other_doc1");
+    primary_store.insert("$CM_coll1", "meta");
+
+    ASSERT_FALSE(primary_store.has_collection_family(1));
+    ASSERT_TRUE(primary_store.migrate_to_collection_family(1));
+    ASSERT_TRUE(primary_store.has_collection_family(1));
+
+    // keys of the collection are moved out of the default family
+    std::string value;
+    rocksdb::DB* db = primary_store._get_db_unsafe();
+    ASSERT_TRUE(db->Get(rocksdb::ReadOptions(), "1_$SI_1", &value).IsNotFound());
+    ASSERT_TRUE(db->Get(rocksdb::ReadOptions(), "10_$SI_1", &value).ok());
+
+    ASSERT_EQ(StoreStatus::FOUND, primary_store.get("1_$SI_1", value));
+    ASSERT_EQ("doc1", value);
+
+    primary_store.insert("1_$SI_3", "doc3");
+
+    std::vector<std::string> values;
+    primary_store.scan_fill("1_$SI_", "1_$SI`", values);
+    ASSERT_EQ(3, values.size());
+    ASSERT_EQ("doc3", values[2]);
+
+    // families are opened again along with the DB
+    primary_store.flush();
+    primary_store.reload(false, "");
+    db = primary_store._get_db_unsafe();
+    ASSERT_TRUE(primary_store.has_collection_family(1));
+    ASSERT_EQ(StoreStatus::FOUND, primary_store.get("1_$SI_3", value));
+
+    ASSERT_TRUE(primary_store.drop_collection_family(1));
+    ASSERT_FALSE(primary_store.drop_collection_family(1));
+    ASSERT_EQ(StoreStatus::NOT_FOUND, primary_store.get("1_$SI_1", value));
+
+    ASSERT_EQ(StoreStatus::FOUND, primary_store.get("10_$SI_1", value));
+    ASSERT_EQ(StoreStatus::FOUND, primary_store.get("$CM_coll1", value));
+
+    ASSERT_TRUE(primary_store.create_collection_family(2));
+    primary_store.insert("2_$SI_1", "doc1");
+    ASSERT_TRUE(primary_store.contains("2_$SI_1"));
+    ASSERT_TRUE(db->Get(rocksdb::ReadOptions(), "2_$SI_1", &value).IsNotFound());
+}
+
+TEST(StoreTest, Tuning) {
+    std::string primary_store_path = "/tmp/typesense_test/primary_store_test";
+    LOG(INFO) << "Truncating and creating: " << primary_store_path;
+    system(("rm -rf "+primary_store_path+" && mkdir -p "+primary_store_path).c_str());
+
+    store_tuning_t tuning;
+    tuning.block_cache_mb = 16;
+    tuning.bloom_filter_bits = 10;
+    tuning.partitioned_filters = true;
+    tuning.compression = "none";
+    tuning.write_buffer_mb = 8;
+
+    Store primary_store(primary_store_path, 0, 0, true, 0, tuning);  // disable WAL
+
+    const rocksdb::Options& options = primary_store.get_db_options();
+    ASSERT_EQ(8 * 1048576, options.write_buffer_size);
+    ASSERT_EQ(rocksdb::CompressionType::kNoCompression, options.compression);
+    ASSERT_EQ(rocksdb::CompressionType::kNoCompression, options.compression_per_level.back());
+
+    ASSERT_STREQ("BlockBasedTable", options.table_factory->Name());
+
+    primary_store.insert("foo1", "bar1");
+    primary_store.insert("foo2", "bar2");
+    primary_store.flush();
+
+    std::string value;
+    ASSERT_EQ(StoreStatus::FOUND, primary_store.get("foo2", value));
+    ASSERT_EQ("bar2", value);
+    ASSERT_FALSE(primary_store.contains("foo3"));
+}
+
+TEST(StoreTest, InvalidTuningFallsBackToDefaults) {
+    std::string primary_store_path = "/tmp/typesense_test/primary_store_test";
+    LOG(INFO) << "Truncating and creating: " << primary_store_path;
+    system(("rm -rf "+primary_store_path+" && mkdir -p "+primary_store_path).c_str());
+
+    store_tuning_t tuning;
+    tuning.compression = "brotli";
+    tuning.write_buffer_mb = 0;
+
+    Store primary_store(primary_store_path, 0, 0, true, 0, tuning);  // disable WAL
+
+    const rocksdb::Options& options = primary_store.get_db_options();
+    ASSERT_EQ(4 * 1048576, options.write_buffer_size);
+    ASSERT_EQ(rocksdb::CompressionType::kSnappyCompression, options.compression);
+
+    primary_store.insert("foo1", "bar1");
+
+    std::string value;
+    ASSERT_EQ(StoreStatus::FOUND, primary_store.get("foo1", value));
+    ASSERT_EQ("bar1", value);
+}
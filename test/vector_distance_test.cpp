@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <algorithm>
+#include "vector_distance.h"
+
+TEST(VectorDistanceTest, KernelsMatchScalar) {
+    using namespace vector_distance;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    const kernels_t& scalar_kernels = get_kernels(isa_t::scalar);
+
+    ASSERT_EQ(isa_t::scalar, scalar_kernels.isa);
+
+    // sizes around the vector widths exercise the tail handling of every kernel
+    for(size_t dim: {1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 384, 385, 768, 1536}) {
+        std::vector<float> a(dim), b(dim);
+        std::generate(a.begin(), a.end(), [&](){ return dist(rng); });
+        std::generate(b.begin(), b.end(), [&](){ return dist(rng); });
+
+        const float expected_ip = scalar_kernels.inner_product(a.data(), b.data(), dim);
+        const float expected_l2 = scalar_kernels.l2_squared(a.data(), b.data(), dim);
+
+        for(isa_t isa: {isa_t::sse, isa_t::avx2, isa_t::avx512}) {
+            const kernels_t& isa_kernels = get_kernels(isa);
+
+            ASSERT_NEAR(expected_ip, isa_kernels.inner_product(a.data(), b.data(), dim), 1e-3);
+            ASSERT_NEAR(expected_l2, isa_kernels.l2_squared(a.data(), b.data(), dim), 1e-3);
+            ASSERT_NEAR(1 - expected_ip, isa_kernels.inner_product_distance(a.data(), b.data(), &dim), 1e-3);
+            ASSERT_NEAR(expected_l2, isa_kernels.l2_distance(a.data(), b.data(), &dim), 1e-3);
+
+            std::vector<float> normalized(dim);
+            isa_kernels.normalize(a.data(), normalized.data(), dim);
+            ASSERT_NEAR(1, scalar_kernels.inner_product(normalized.data(), normalized.data(), dim), 1e-4);
+        }
+    }
+
+    ASSERT_EQ(kernels().isa, get_kernels(detect_isa()).isa);
+}